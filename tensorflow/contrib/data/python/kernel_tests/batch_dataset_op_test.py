@@ -17,6 +17,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import functools
 import math
 
 import numpy as np
@@ -24,6 +25,8 @@ import numpy as np
 from tensorflow.contrib.data.python.kernel_tests import dataset_serialization_test_base
 from tensorflow.contrib.data.python.ops import batching
 from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.core.example import example_pb2
+from tensorflow.core.example import feature_pb2
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
@@ -31,6 +34,7 @@ from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import parsing_ops
 from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 from tensorflow.python.util import compat
@@ -707,6 +711,69 @@ class BatchDatasetTest(test.TestCase):
                                    "number of elements does not match"):
         sess.run(get_next)
 
+  def _serializedExample(self, i):
+    feature = {
+        "a": feature_pb2.Feature(
+            int64_list=feature_pb2.Int64List(value=[i, 2 * i]))
+    }
+    if i % 2 == 0:
+      feature["b"] = feature_pb2.Feature(
+          float_list=feature_pb2.FloatList(value=[i / 2.0]))
+    return example_pb2.Example(
+        features=feature_pb2.Features(feature=feature)).SerializeToString()
+
+  def testMapAndBatchParseExample(self):
+    features = {
+        "a": parsing_ops.FixedLenFeature([2], dtypes.int64),
+        "b": parsing_ops.FixedLenFeature([], dtypes.float32,
+                                         default_value=-1.0),
+    }
+    serialized = [self._serializedExample(i) for i in range(10)]
+    for parse_fn, num_parallel_batches in [
+        (parsing_ops.parse_single_example, 1),
+        (parsing_ops.parse_single_example_v2, 1),
+        (parsing_ops.parse_single_example_v2, 3)]:
+      iterator = (
+          dataset_ops.Dataset.from_tensor_slices(serialized).apply(
+              batching.map_and_batch(
+                  functools.partial(parse_fn, features=features),
+                  batch_size=4,
+                  num_parallel_batches=num_parallel_batches))
+          .make_initializable_iterator())
+      get_next = iterator.get_next()
+
+      with self.test_session() as sess:
+        sess.run(iterator.initializer)
+        for start, end in [(0, 4), (4, 8), (8, 10)]:
+          result = sess.run(get_next)
+          indices = np.arange(start, end)
+          self.assertAllEqual(np.stack([indices, 2 * indices], axis=1),
+                              result["a"])
+          self.assertAllEqual(
+              np.where(indices % 2 == 0, indices / 2.0, -1.0), result["b"])
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testMapAndBatchParseExampleErrors(self):
+    features = {"a": parsing_ops.FixedLenFeature([2], dtypes.int64)}
+    serialized = [self._serializedExample(i) for i in range(4)]
+    serialized[1] = b"not an example"
+    iterator = (
+        dataset_ops.Dataset.from_tensor_slices(serialized).apply(
+            batching.map_and_batch(
+                lambda x: parsing_ops.parse_single_example_v2(x, features),
+                batch_size=2))
+        .make_initializable_iterator())
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(iterator.initializer)
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+      self.assertAllEqual([[2, 4], [3, 6]], sess.run(get_next)["a"])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
 
 class BatchDatasetSerializationTest(
     dataset_serialization_test_base.DatasetSerializationTestBase):
@@ -376,5 +376,134 @@ class BucketTest(test.TestCase):
       self.assertEqual(batches, 15)
 
 
+class BucketBySequenceLengthTest(test.TestCase):
+
+  def _build_dataset(self, lengths, **kwargs):
+    # Element `i` is a sequence of `lengths[i]` copies of `i`, paired with `i`.
+    def _generator():
+      for i, length in enumerate(lengths):
+        yield [i] * length, i
+
+    return dataset_ops.Dataset.from_generator(
+        _generator, (dtypes.int64, dtypes.int64),
+        (tensor_shape.TensorShape([None]), tensor_shape.TensorShape([]))).apply(
+            grouping.bucket_by_sequence_length(**kwargs))
+
+  def _get_batches(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    batches = []
+    with self.test_session() as sess:
+      with self.assertRaises(errors.OutOfRangeError):
+        while True:
+          batches.append(sess.run(get_next))
+    return batches
+
+  def testBucketing(self):
+    lengths = [1, 5, 2, 12, 6, 3, 20, 7, 4, 8, 25]
+    dataset = self._build_dataset(
+        lengths, bucket_boundaries=[5, 10], bucket_batch_sizes=[2, 3, 4])
+    self.assertEqual([[None, None], [None]],
+                     [s.as_list() for s in dataset.output_shapes])
+    batches = self._get_batches(dataset)
+
+    # Full batches are produced as soon as they fill up, and the partial
+    # batches are produced in bucket order at the end.
+    self.assertEqual([[0, 2], [1, 4, 7], [5, 8], [9], [3, 6, 10]],
+                     [list(indices) for _, indices in batches])
+    for sequences, indices in batches:
+      max_length = max(lengths[i] for i in indices)
+      self.assertEqual((len(indices), max_length), sequences.shape)
+      for sequence, i in zip(sequences, indices):
+        self.assertAllEqual([i] * lengths[i] + [0] * (max_length - lengths[i]),
+                            sequence)
+
+  def testPadToBucketBoundary(self):
+    lengths = [1, 5, 2, 12, 6, 3]
+    batches = self._get_batches(
+        self._build_dataset(
+            lengths,
+            bucket_boundaries=[5, 10],
+            bucket_batch_sizes=[2, 2, 2],
+            padding_values=(constant_op.constant(-1, dtype=dtypes.int64),
+                            constant_op.constant(0, dtype=dtypes.int64)),
+            pad_to_bucket_boundary=True))
+    self.assertEqual([(2, 4), (2, 9), (1, 4), (1, 12)],
+                     [sequences.shape for sequences, _ in batches])
+    self.assertAllEqual([[0, -1, -1, -1], [2, 2, -1, -1]], batches[0][0])
+
+  def testMatchesGroupByWindow(self):
+    lengths = np.random.randint(1, 30, size=200)
+    boundaries = [8, 16, 24]
+    batch_sizes = [7, 5, 3, 2]
+
+    def _key_func(sequence, _):
+      length = array_ops.shape(sequence, out_type=dtypes.int64)[0]
+      return math_ops.reduce_sum(
+          math_ops.cast(
+              math_ops.greater_equal(length, boundaries), dtypes.int64))
+
+    def _reduce_func(key, window):
+      return window.padded_batch(
+          constant_op.constant(batch_sizes, dtypes.int64)[key],
+          ([None], []))
+
+    # Both transformations produce the same batches, though not necessarily
+    # in the same order.
+    expected = sorted(
+        self._get_batches(
+            self._build_dataset(
+                lengths,
+                bucket_boundaries=boundaries,
+                bucket_batch_sizes=batch_sizes)),
+        key=lambda batch: list(batch[1]))
+    reference = dataset_ops.Dataset.from_generator(
+        lambda: (([i] * length, i) for i, length in enumerate(lengths)),
+        (dtypes.int64, dtypes.int64),
+        (tensor_shape.TensorShape([None]), tensor_shape.TensorShape([])))
+    reference = reference.apply(
+        grouping.group_by_window(
+            _key_func,
+            _reduce_func,
+            window_size_func=lambda key: constant_op.constant(
+                batch_sizes, dtypes.int64)[key]))
+    actual = sorted(
+        self._get_batches(reference), key=lambda batch: list(batch[1]))
+    self.assertEqual(len(expected), len(actual))
+    for (expected_sequences, expected_indices), (sequences, indices) in zip(
+        expected, actual):
+      self.assertAllEqual(expected_indices, indices)
+      self.assertAllEqual(expected_sequences, sequences)
+
+  def testErrors(self):
+    with self.assertRaises(ValueError):
+      grouping.bucket_by_sequence_length([5, 10], [2, 3])
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._get_batches(
+          self._build_dataset(
+              [1, 2], bucket_boundaries=[10, 5], bucket_batch_sizes=[1, 1, 1]))
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._get_batches(
+          self._build_dataset(
+              [1, 2],
+              bucket_boundaries=[5],
+              bucket_batch_sizes=[1, 1],
+              length_component=1))
+
+
+class BucketBySequenceLengthSerializationTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_dataset(self, lengths):
+    return dataset_ops.Dataset.from_tensor_slices(lengths).map(
+        lambda length: array_ops.fill([length], length)).apply(
+            grouping.bucket_by_sequence_length(
+                bucket_boundaries=[4, 8], bucket_batch_sizes=[3, 2, 2]))
+
+  def testCore(self):
+    lengths = np.array([1, 5, 2, 9, 6, 3, 10, 4, 7, 1, 2, 11], dtype=np.int64)
+    self.run_core_tests(lambda: self._build_dataset(lengths),
+                        lambda: self._build_dataset(lengths[:6]), 6)
+
+
 if __name__ == "__main__":
   test.main()
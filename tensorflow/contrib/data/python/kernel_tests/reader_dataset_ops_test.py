@@ -169,9 +169,15 @@ class TextLineDatasetSerializationTest(
     TextLineDatasetTestBase,
     dataset_serialization_test_base.DatasetSerializationTestBase):
 
-  def _build_iterator_graph(self, test_filenames, compression_type=None):
+  def _build_iterator_graph(self,
+                            test_filenames,
+                            compression_type=None,
+                            use_mmap=False):
     return readers.TextLineDataset(
-        test_filenames, compression_type=compression_type, buffer_size=10)
+        test_filenames,
+        compression_type=compression_type,
+        buffer_size=10,
+        use_mmap=use_mmap)
 
   def testTextLineCore(self):
     compression_types = [None, "GZIP", "ZLIB"]
@@ -190,6 +196,14 @@ class TextLineDatasetSerializationTest(
           lambda: self._build_iterator_graph(test_filenames), num_outputs)
       # pylint: enable=cell-var-from-loop
 
+  def testTextLineMmap(self):
+    num_files = 5
+    lines_per_file = 5
+    test_filenames = self._createFiles(num_files, lines_per_file, crlf=True)
+    self.run_core_tests(
+        lambda: self._build_iterator_graph(test_filenames, use_mmap=True),
+        None, num_files * lines_per_file)
+
 
 class FixedLengthRecordReaderTestBase(test.TestCase):
 
@@ -554,6 +568,96 @@ class TFRecordDatasetSerializationTest(
         lambda: self._build_iterator_graph(num_epochs * 2), num_outputs)
 
 
+class CsvDatasetTestBase(test.TestCase):
+
+  def _createFiles(self, contents):
+    filenames = []
+    for i, content in enumerate(contents):
+      fn = os.path.join(self.get_temp_dir(), "csv.%d.csv" % i)
+      filenames.append(fn)
+      with open(fn, "wb") as f:
+        f.write(compat.as_bytes(content))
+    return filenames
+
+
+class CsvDatasetTest(CsvDatasetTestBase):
+
+  def _verifyOutput(self, dataset, expected):
+    iterator = dataset.make_one_shot_iterator()
+    next_element = iterator.get_next()
+    with self.test_session() as sess:
+      for row in expected:
+        actual = sess.run(next_element)
+        self.assertEqual(len(row), len(actual))
+        for expected_value, actual_value in zip(row, actual):
+          self.assertAllClose(expected_value, actual_value)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
+  def testReadFiles(self):
+    filenames = self._createFiles(
+        ["1,2.5,a\n3,,\"b,c\"\n", "\n5,7.25,\"d\"\"e\"\r\n6,0,f"])
+    defaults = [dtypes.int64, constant_op.constant([-1.0]), dtypes.string]
+    expected = [(1, 2.5, b"a"), (3, -1.0, b"b,c"), (5, 7.25, b'd"e'),
+                (6, 0.0, b"f")]
+    for buffer_size in [None, 1, 5, 1024]:
+      self._verifyOutput(
+          readers.CsvDataset(filenames, defaults, buffer_size=buffer_size),
+          expected)
+
+  def testMatchesDecodeCSV(self):
+    lines = ["%d,%d.%d,x%d" % (i, i, 7 * i, i) for i in range(20)]
+    filenames = self._createFiles(["\n".join(lines)])
+    defaults = [[0], [0.0], [""]]
+    csv_dataset = readers.CsvDataset(filenames, defaults)
+    text_dataset = readers.TextLineDataset(filenames).map(
+        lambda line: parsing_ops.decode_csv(line, defaults))
+    csv_next = csv_dataset.make_one_shot_iterator().get_next()
+    text_next = text_dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      for _ in range(len(lines)):
+        csv_row, text_row = sess.run([csv_next, text_next])
+        for csv_value, text_value in zip(csv_row, text_row):
+          self.assertEqual(csv_value, text_value)
+
+  def testHeaderAndOptions(self):
+    filenames = self._createFiles(["x;y\n1;NA\n\"2\";3\n"])
+    dataset = readers.CsvDataset(
+        filenames, [dtypes.string, constant_op.constant([0], dtypes.int32)],
+        header=True,
+        field_delim=";",
+        use_quote_delim=False,
+        na_value="NA")
+    self._verifyOutput(dataset, [(b"1", 0), (b'"2"', 3)])
+
+  def testErrors(self):
+    for content in ["1,2,3\n", "1\n", "a,1\n", ",1\n"]:
+      filenames = self._createFiles([content])
+      dataset = readers.CsvDataset(filenames, [dtypes.int32, dtypes.int32])
+      next_element = dataset.make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        with self.assertRaises(errors.InvalidArgumentError):
+          sess.run(next_element)
+
+
+class CsvDatasetSerializationTest(
+    CsvDatasetTestBase,
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_iterator_graph(self, filenames):
+    return readers.CsvDataset(
+        filenames, [dtypes.int64, dtypes.string], buffer_size=7, header=True)
+
+  def testCsvCore(self):
+    contents = []
+    for i in range(3):
+      contents.append("a,b\n" + "".join(
+          "%d,\"x\ny%d\"\n" % (j, j) for j in range(5 * i, 5 * i + 5)))
+    filenames = self._createFiles(contents)
+    self.run_core_tests(lambda: self._build_iterator_graph(filenames),
+                        lambda: self._build_iterator_graph(filenames[:1]), 15)
+
+
 class ReadBatchFeaturesTest(test.TestCase):
 
   def setUp(self):
@@ -277,5 +277,84 @@ class ShuffleAndRepeatSerializationTest(
                         100)
 
 
+class SpillingShuffleTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_ds(self, seed, memory_limit=16, count=5, num_elements=20):
+    # Each element is 8 bytes, so all but the first two buffered elements are
+    # spilled by default.
+    return dataset_ops.Dataset.range(num_elements).apply(
+        shuffle_ops.spilling_shuffle(
+            buffer_size=5, memory_limit=memory_limit,
+            spill_directory=self.get_temp_dir(), count=count, seed=seed))
+
+  def testCorrectOutput(self):
+    output = self.gen_outputs(lambda: self._build_ds(10), [], 100)
+    for i in range(5):
+      self.assertSequenceEqual(sorted(output[i * 20:(i + 1) * 20]), range(20))
+
+  def testMatchesInMemoryShuffle(self):
+    # Spilling does not change the order in which elements are drawn.
+    for memory_limit in [1, 16, 1 << 20]:
+      output = self.gen_outputs(
+          lambda: self._build_ds(10, memory_limit=memory_limit), [], 100)
+      expected = self.gen_outputs(
+          lambda: dataset_ops.Dataset.range(20).apply(
+              shuffle_ops.shuffle_and_repeat(buffer_size=5, count=5, seed=10)),
+          [], 100)
+      self.assertEqual(expected, output)
+
+  def testStringElements(self):
+    elements = [str(i) * (i % 7) for i in range(100)]
+
+    def ds_fn():
+      return dataset_ops.Dataset.from_tensor_slices(elements).apply(
+          shuffle_ops.spilling_shuffle(
+              buffer_size=50, memory_limit=1,
+              spill_directory=self.get_temp_dir(), seed=10))
+
+    output = self.gen_outputs(ds_fn, [], 100)
+    self.assertEqual(sorted(output),
+                     sorted([e.encode("utf-8") for e in elements]))
+
+  def testInvalidMemoryLimit(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError, "memory_limit"):
+      self.gen_outputs(lambda: self._build_ds(10, memory_limit=0), [], 100)
+
+  def testCore(self):
+    self.run_core_tests(lambda: self._build_ds(10), lambda: self._build_ds(20),
+                        100)
+
+
+class ShuffledIndicesTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_ds(self, seed, count=5, num_elements=20):
+    return shuffle_ops.shuffled_indices(num_elements, count=count, seed=seed)
+
+  def testCorrectOutput(self):
+    output = self.gen_outputs(lambda: self._build_ds(10), [], 100)
+    for i in range(5):
+      self.assertSequenceEqual(sorted(output[i * 20:(i + 1) * 20]), range(20))
+
+  def testReshuffling(self):
+    output = self.gen_outputs(lambda: self._build_ds(10), [], 100)
+    for i in range(4):
+      self.assertNotEqual(output[i * 20:(i + 1) * 20],
+                          output[(i + 1) * 20:(i + 2) * 20])
+
+  def testSameOrderForSameSeeds(self):
+    output1 = self.gen_outputs(lambda: self._build_ds(10), [], 100)
+    output2 = self.gen_outputs(lambda: self._build_ds(10), [], 100)
+    self.assertEqual(output1, output2)
+
+  def testEmpty(self):
+    self.gen_outputs(lambda: self._build_ds(10, num_elements=0), [], 0)
+
+  def testCore(self):
+    self.run_core_tests(lambda: self._build_ds(10), lambda: self._build_ds(20),
+                        100)
+
+
 if __name__ == "__main__":
   test.main()
@@ -94,6 +94,31 @@ class StatsDatasetTest(test.TestCase):
         sess.run(next_element)
       self._assertSummaryHasCount(sess.run(summary_t), "record_latency", 100.0)
 
+  def testIteratorStats(self):
+    dataset = dataset_ops.Dataset.range(100).map(lambda x: x * 2)
+    iterator = dataset.make_initializable_iterator()
+    stats_aggregator = stats_ops.StatsAggregator()
+    stats_aggregator_subscriber = stats_aggregator.subscribe(iterator)
+    next_element = iterator.get_next()
+    summary_t = stats_aggregator.get_summary()
+    report_t = stats_aggregator.get_bottleneck_report()
+
+    with self.test_session() as sess:
+      self.assertIn(b"No iterator statistics", sess.run(report_t))
+      sess.run([iterator.initializer, stats_aggregator_subscriber])
+      for i in range(100):
+        self.assertEqual(i * 2, sess.run(next_element))
+      summary_str = sess.run(summary_t)
+      for prefix in ["Iterator::Map", "Iterator::Map::Range"]:
+        self._assertSummaryHasCount(summary_str, prefix + "::latency", 100.0)
+        self._assertSummaryHasCount(summary_str, prefix + "::self_time",
+                                    100.0)
+
+      report = sess.run(report_t)
+      self.assertTrue(report.startswith(b"Bottleneck: Iterator::Map"))
+      self.assertIn(b"Iterator::Map: 100 calls", report)
+      self.assertIn(b"Iterator::Map::Range: 100 calls", report)
+
   def testReinitialize(self):
     dataset = dataset_ops.Dataset.range(100).apply(
         stats_ops.latency_stats("record_latency"))
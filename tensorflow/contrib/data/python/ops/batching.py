@@ -395,6 +395,10 @@ def map_and_batch(map_func, batch_size, num_parallel_batches=1):
   the fusing of `map` and `batch` will happen automatically and this API will be
   deprecated.
 
+  If `map_func` only parses a serialized `tf.train.Example` with
+  `tf.parse_single_example` and returns fixed-shape dense features, each batch
+  of examples is parsed at once, directly into the batched output tensors.
+
   Args:
     map_func: A function mapping a nested structure of tensors to another
       nested structure of tensors.
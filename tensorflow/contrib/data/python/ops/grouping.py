@@ -17,12 +17,16 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import numpy as np
+
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import nest
 from tensorflow.python.data.util import sparse
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import function
 from tensorflow.python.framework import ops
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.framework import tensor_util
 from tensorflow.python.ops import gen_dataset_ops
 
 
@@ -85,6 +89,79 @@ def group_by_window(key_func,
   return _apply_fn
 
 
+def bucket_by_sequence_length(bucket_boundaries,
+                              bucket_batch_sizes,
+                              length_component=0,
+                              padded_shapes=None,
+                              padding_values=None,
+                              pad_to_bucket_boundary=False):
+  """A transformation that batches elements of similar length together.
+
+  Each element is assigned to a bucket according to its length, which is the
+  size of the 0th dimension of one of its components. Once a bucket contains
+  `bucket_batch_sizes[i]` elements, they are emitted as one padded batch, as
+  if by @{tf.data.Dataset.padded_batch}. When the input is exhausted, the
+  remaining partial batches are emitted.
+
+  This is equivalent to combining @{tf.contrib.data.group_by_window} with
+  `padded_batch()`, but the bucketing and padding are performed in a single
+  native transformation, without invoking a function for every element.
+
+  For example, to batch sentences of up to 10, 20 and 40 tokens in batches of
+  64, 32 and 16 sentences:
+
+  ```python
+  dataset = dataset.apply(tf.contrib.data.bucket_by_sequence_length(
+      bucket_boundaries=[11, 21], bucket_batch_sizes=[64, 32, 16]))
+  ```
+
+  Args:
+    bucket_boundaries: A list of strictly increasing, positive integers. An
+      element of length `l` is placed in bucket `i` such that
+      `bucket_boundaries[i-1] <= l < bucket_boundaries[i]`.
+    bucket_batch_sizes: A list of positive integers, the batch size of each
+      bucket. Must contain `len(bucket_boundaries) + 1` elements.
+    length_component: (Optional.) The index, among the flattened components of
+      each element (as returned by `tf.contrib.framework.nest.flatten`), of
+      the component whose 0th dimension is the element's length. Defaults to
+      0.
+    padded_shapes: (Optional.) A nested structure of `tf.TensorShape` or
+      `tf.int64` vector tensor-like objects, as for
+      @{tf.data.Dataset.padded_batch}. Defaults to the shapes of the input
+      elements, padding every dimension of unknown size.
+    padding_values: (Optional.) A nested structure of scalar-shaped
+      `tf.Tensor`, representing the padding values to use for the respective
+      components. Defaults are `0` for numeric types and the empty string for
+      string types.
+    pad_to_bucket_boundary: (Optional.) A boolean. If `True`, dimensions of
+      unknown size are padded to `bucket_boundaries[i] - 1` in bucket `i`,
+      rather than to the maximum size in the batch. The last bucket is always
+      padded to the maximum size in the batch.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    @{tf.data.Dataset.apply}.
+
+  Raises:
+    ValueError: if `bucket_batch_sizes` does not contain one more element than
+      `bucket_boundaries`.
+  """
+  bucket_boundaries = list(bucket_boundaries)
+  bucket_batch_sizes = list(bucket_batch_sizes)
+  if len(bucket_batch_sizes) != len(bucket_boundaries) + 1:
+    raise ValueError(
+        "`bucket_batch_sizes` must have one more element than "
+        "`bucket_boundaries`.")
+
+  def _apply_fn(dataset):
+    """Function from `Dataset` to `Dataset` that applies the transformation."""
+    return _BucketBySequenceLengthDataset(
+        dataset, bucket_boundaries, bucket_batch_sizes, length_component,
+        padded_shapes, padding_values, pad_to_bucket_boundary)
+
+  return _apply_fn
+
+
 class _VariantDataset(dataset_ops.Dataset):
   """A Dataset wrapper for a tf.variant-typed function argument."""
 
@@ -221,3 +298,70 @@ class GroupByWindowDataset(dataset_ops.Dataset):
             sparse.as_dense_types(self.output_types, self.output_classes)),
         output_shapes=nest.flatten(
             sparse.as_dense_shapes(self.output_shapes, self.output_classes)))
+
+
+class _BucketBySequenceLengthDataset(dataset_ops.Dataset):
+  """A `Dataset` that batches and pads elements of similar length together."""
+
+  def __init__(self, input_dataset, bucket_boundaries, bucket_batch_sizes,
+               length_component, padded_shapes, padding_values,
+               pad_to_bucket_boundary):
+    """See `bucket_by_sequence_length()` for details."""
+    super(_BucketBySequenceLengthDataset, self).__init__()
+    if sparse.any_sparse(input_dataset.output_classes):
+      raise TypeError(
+          "Batching of padded sparse tensors is not currently supported")
+    self._input_dataset = input_dataset
+    self._bucket_boundaries = bucket_boundaries
+    self._bucket_batch_sizes = bucket_batch_sizes
+    self._length_component = length_component
+    self._pad_to_bucket_boundary = pad_to_bucket_boundary
+    if padded_shapes is None:
+      padded_shapes = input_dataset.output_shapes
+    if padding_values is None:
+
+      def make_zero(t):
+        if t.base_dtype == dtypes.string:
+          return ""
+        else:
+          return np.zeros_like(t.as_numpy_dtype())
+
+      padding_values = nest.map_structure(make_zero,
+                                          input_dataset.output_types)
+    # pylint: disable=protected-access
+    self._padded_shapes = nest.map_structure_up_to(
+        input_dataset.output_shapes, dataset_ops._partial_shape_to_tensor,
+        padded_shapes)
+    self._padding_values = nest.map_structure_up_to(
+        input_dataset.output_shapes, dataset_ops._padding_value_to_tensor,
+        padding_values, input_dataset.output_types)
+    # pylint: enable=protected-access
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.bucket_by_sequence_length_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        padded_shapes=nest.flatten(self._padded_shapes),
+        padding_values=nest.flatten(self._padding_values),
+        bucket_boundaries=self._bucket_boundaries,
+        bucket_batch_sizes=self._bucket_batch_sizes,
+        length_component=self._length_component,
+        pad_to_bucket_boundary=self._pad_to_bucket_boundary,
+        output_shapes=nest.flatten(
+            sparse.as_dense_shapes(self.output_shapes, self.output_classes)))
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+  @property
+  def output_shapes(self):
+
+    def _padded_shape_to_batch_shape(s):
+      return tensor_shape.vector(None).concatenate(
+          tensor_util.constant_value_as_shape(s))
+
+    return nest.map_structure(_padded_shape_to_batch_shape, self._padded_shapes)
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
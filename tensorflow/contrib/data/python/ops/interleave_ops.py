@@ -153,7 +153,8 @@ def parallel_interleave(map_func,
       elements in a non-deterministic order.
     buffer_output_elements: The number of elements each iterator being
       interleaved should buffer (similar to the `.prefetch()` transformation for
-      each interleaved iterator).
+      each interleaved iterator). If -1, the buffer size will be tuned
+      automatically at runtime.
     prefetch_input_elements: The number of input elements to transform to
       iterators before they are needed for interleaving.
 
@@ -20,7 +20,9 @@ from __future__ import print_function
 from tensorflow.contrib.data.python.ops import dataset_ops as contrib_dataset_ops
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers
+from tensorflow.python.data.util import convert
 from tensorflow.python.data.util import nest
+from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import tensor_shape
@@ -216,17 +218,124 @@ def _get_file_names(file_pattern, randomize_input):
   return file_names
 
 
+class CsvDataset(contrib_dataset_ops.Dataset):
+
+  def __init__(self,
+               filenames,
+               record_defaults,
+               buffer_size=None,
+               header=False,
+               field_delim=",",
+               use_quote_delim=True,
+               na_value=""):
+    dataset = _CsvDataset(filenames, record_defaults, buffer_size, header,
+                          field_delim, use_quote_delim, na_value)
+    super(CsvDataset, self).__init__(dataset)
+
+
+class _CsvDataset(dataset_ops.Dataset):
+  """A `Dataset` comprising the columns of records from CSV files."""
+
+  def __init__(self,
+               filenames,
+               record_defaults,
+               buffer_size=None,
+               header=False,
+               field_delim=",",
+               use_quote_delim=True,
+               na_value=""):
+    """Creates a `CsvDataset`.
+
+    `CsvDataset` parses CSV files directly into one scalar tensor per column,
+    which is faster than parsing the elements of a `TextLineDataset` with
+    `tf.decode_csv`. For example:
+
+    ```python
+    dataset = tf.contrib.data.CsvDataset(
+        ["/foo/bar.csv"], [tf.float32, tf.constant([0], dtype=tf.int64)],
+        header=True)
+    # Each element is a tuple `(x, y)` of a `tf.float32` and a `tf.int64`
+    # scalar, where `y` is 0 in records whose second column is empty.
+    ```
+
+    Fields are parsed as by `tf.decode_csv`. Records are separated by
+    newlines, except inside quoted fields, and blank records are skipped.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      record_defaults: A list with one element per column. Each element is
+        either a `tf.DType`, for a required column, or a tensor with a single
+        default value, whose type is the type of the column.
+      buffer_size: (Optional.) A `tf.int64` scalar denoting the number of
+        bytes to read from a file at a time.
+      header: (Optional.) A `tf.bool` scalar indicating whether the first
+        record of each file is a header to be skipped.
+      field_delim: (Optional.) A `tf.string` scalar containing the single
+        character that separates fields.
+      use_quote_delim: (Optional.) A `tf.bool` scalar indicating whether
+        double quotation marks are treated as quotes around fields.
+      na_value: (Optional.) A `tf.string` scalar that marks missing values.
+    """
+    super(_CsvDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    self._record_defaults = []
+    for i, default in enumerate(record_defaults):
+      if isinstance(default, dtypes.DType):
+        default = constant_op.constant([], dtype=default)
+      self._record_defaults.append(
+          ops.convert_to_tensor(default, name="record_default_%d" % i))
+    self._buffer_size = convert.optional_param_to_tensor(
+        "buffer_size", buffer_size, argument_default=0)
+    self._header = ops.convert_to_tensor(
+        header, dtype=dtypes.bool, name="header")
+    self._field_delim = ops.convert_to_tensor(
+        field_delim, dtype=dtypes.string, name="field_delim")
+    self._use_quote_delim = ops.convert_to_tensor(
+        use_quote_delim, dtype=dtypes.bool, name="use_quote_delim")
+    self._na_value = ops.convert_to_tensor(
+        na_value, dtype=dtypes.string, name="na_value")
+    self._output_types = tuple(t.dtype for t in self._record_defaults)
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.csv_dataset(
+        self._filenames,
+        self._buffer_size,
+        self._header,
+        self._field_delim,
+        self._use_quote_delim,
+        self._na_value,
+        self._record_defaults,
+        output_shapes=nest.flatten(self.output_shapes))
+
+  @property
+  def output_classes(self):
+    return nest.map_structure(lambda _: ops.Tensor, self._output_types)
+
+  @property
+  def output_shapes(self):
+    return nest.map_structure(lambda _: tensor_shape.TensorShape([]),
+                              self._output_types)
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+
 class SqlDataset(contrib_dataset_ops.Dataset):
 
-  def __init__(self, driver_name, data_source_name, query, output_types):
-    dataset = _SqlDataset(driver_name, data_source_name, query, output_types)
+  def __init__(self, driver_name, data_source_name, query, output_types,
+               batch_size=None):
+    dataset = _SqlDataset(driver_name, data_source_name, query, output_types,
+                          batch_size)
     super(SqlDataset, self).__init__(dataset)
 
 
 class _SqlDataset(dataset_ops.Dataset):
   """A `Dataset` consisting of the results from a SQL query."""
 
-  def __init__(self, driver_name, data_source_name, query, output_types):
+  def __init__(self, driver_name, data_source_name, query, output_types,
+               batch_size=None):
     """Creates a `SqlDataset`.
 
     `SqlDataset` allows a user to read data from the result set of a SQL query.
@@ -246,6 +355,12 @@ class _SqlDataset(dataset_ops.Dataset):
         break
     ```
 
+    If `batch_size` is set, each element instead contains up to `batch_size`
+    consecutive rows, as one vector per column. This is equivalent to calling
+    `batch(batch_size)` on the unbatched dataset, but much faster for large
+    result sets, because each column of a batch is filled in place as the
+    query is stepped rather than building one tensor per row and column.
+
     Args:
       driver_name: A 0-D `tf.string` tensor containing the database type.
         Currently, the only supported value is 'sqlite'.
@@ -254,6 +369,11 @@ class _SqlDataset(dataset_ops.Dataset):
       query: A 0-D `tf.string` tensor containing the SQL query to execute.
       output_types: A tuple of `tf.DType` objects representing the types of the
         columns returned by `query`.
+      batch_size: (Optional.) A positive Python integer, the number of rows to
+        combine in each element. If not set, each element is a single row.
+
+    Raises:
+      ValueError: If `batch_size` is not positive.
     """
     super(_SqlDataset, self).__init__()
     self._driver_name = ops.convert_to_tensor(
@@ -263,12 +383,17 @@ class _SqlDataset(dataset_ops.Dataset):
     self._query = ops.convert_to_tensor(
         query, dtype=dtypes.string, name="query")
     self._output_types = output_types
+    if batch_size is not None and batch_size <= 0:
+      raise ValueError("`batch_size` must be positive, but got %d." %
+                       batch_size)
+    self._batch_size = batch_size
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.sql_dataset(self._driver_name,
                                        self._data_source_name, self._query,
                                        nest.flatten(self.output_types),
-                                       nest.flatten(self.output_shapes))
+                                       nest.flatten(self.output_shapes),
+                                       batch_size=self._batch_size or 0)
 
   @property
   def output_classes(self):
@@ -276,8 +401,11 @@ class _SqlDataset(dataset_ops.Dataset):
 
   @property
   def output_shapes(self):
-    return nest.map_structure(lambda _: tensor_shape.TensorShape([]),
-                              self._output_types)
+    if self._batch_size:
+      shape = tensor_shape.vector(None)
+    else:
+      shape = tensor_shape.scalar()
+    return nest.map_structure(lambda _: shape, self._output_types)
 
   @property
   def output_types(self):
@@ -24,6 +24,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import random_seed
+from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import gen_dataset_ops
 
 
@@ -118,3 +119,174 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     return _ShuffleAndRepeatDataset(dataset, buffer_size, count, seed)
 
   return _apply_fn
+
+
+def _seed_tensors(seed):
+  """Returns the `seed` and `seed2` tensors for a shuffling dataset op."""
+  seed, seed2 = random_seed.get_seed(seed)
+  if seed is None:
+    seed_t = constant_op.constant(0, dtype=dtypes.int64, name="seed")
+  else:
+    seed_t = ops.convert_to_tensor(seed, dtype=dtypes.int64, name="seed")
+  if seed2 is None:
+    seed2_t = constant_op.constant(0, dtype=dtypes.int64, name="seed2")
+  else:
+    seed2_t = ops.convert_to_tensor(seed2, dtype=dtypes.int64, name="seed2")
+  return seed_t, seed2_t
+
+
+class _SpillingShuffleDataset(dataset_ops.Dataset):
+  """A `Dataset` that shuffles its input, spilling its buffer to disk."""
+
+  def __init__(self, input_dataset, buffer_size, memory_limit,
+               spill_directory=None, count=1, seed=None):
+    """See `spilling_shuffle()` for details."""
+    super(_SpillingShuffleDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+    self._memory_limit = ops.convert_to_tensor(
+        memory_limit, dtype=dtypes.int64, name="memory_limit")
+    if spill_directory is None:
+      spill_directory = ""
+    self._spill_directory = ops.convert_to_tensor(
+        spill_directory, dtype=dtypes.string, name="spill_directory")
+    if count is None:
+      self._count = constant_op.constant(-1, dtype=dtypes.int64, name="count")
+    else:
+      self._count = ops.convert_to_tensor(
+          count, dtype=dtypes.int64, name="count")
+    self._seed, self._seed2 = _seed_tensors(seed)
+
+  def _as_variant_tensor(self):
+    # pylint: disable=protected-access
+    input_resource = self._input_dataset._as_variant_tensor()
+    return gen_dataset_ops.spilling_shuffle_dataset(
+        input_resource,
+        buffer_size=self._buffer_size,
+        seed=self._seed,
+        seed2=self._seed2,
+        count=self._count,
+        memory_limit=self._memory_limit,
+        spill_directory=self._spill_directory,
+        output_types=nest.flatten(
+            sparse.as_dense_types(self.output_types, self.output_classes)),
+        output_shapes=nest.flatten(
+            sparse.as_dense_shapes(self.output_shapes, self.output_classes)))
+    # pylint: enable=protected-access
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+
+def spilling_shuffle(buffer_size, memory_limit, spill_directory=None, count=1,
+                     seed=None):
+  """Shuffles a Dataset using a buffer that may spill to local disk.
+
+  `dataset.apply(tf.contrib.data.spilling_shuffle(buffer_size, memory_limit))`
+
+  produces the same elements as `dataset.shuffle(buffer_size)`, but keeps at
+  most `memory_limit` bytes of buffered elements in memory. The remaining
+  buffered elements are written to scratch files, and read back when they are
+  drawn. This makes it possible to use a buffer size that is much larger than
+  would fit in memory, at the cost of local disk I/O.
+
+  Args:
+    buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the
+      number of elements from this dataset from which the new
+      dataset will sample.
+    memory_limit: A `tf.int64` scalar `tf.Tensor`, representing the maximum
+      number of bytes of buffered tensor data to keep in memory.
+    spill_directory: (Optional.) A `tf.string` scalar `tf.Tensor`, naming a
+      local directory in which to write scratch files. If not specified, a
+      temporary directory is used.
+    count: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      number of times the dataset should be repeated, with the shuffle buffer
+      carried over between repetitions. If `None` or `-1`, the dataset is
+      repeated indefinitely.
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      random seed that will be used to create the distribution. See
+      @{tf.set_random_seed} for behavior.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    @{tf.contrib.data.Dataset.apply}.
+  """
+
+  def _apply_fn(dataset):  # pylint: disable=missing-docstring
+    return _SpillingShuffleDataset(dataset, buffer_size, memory_limit,
+                                   spill_directory, count, seed)
+
+  return _apply_fn
+
+
+class _IndexShuffleDataset(dataset_ops.Dataset):
+  """A `Dataset` of randomly permuted indices."""
+
+  def __init__(self, num_elements, count=1, seed=None):
+    """See `shuffled_indices()` for details."""
+    super(_IndexShuffleDataset, self).__init__()
+    self._num_elements = ops.convert_to_tensor(
+        num_elements, dtype=dtypes.int64, name="num_elements")
+    if count is None:
+      self._count = constant_op.constant(-1, dtype=dtypes.int64, name="count")
+    else:
+      self._count = ops.convert_to_tensor(
+          count, dtype=dtypes.int64, name="count")
+    self._seed, self._seed2 = _seed_tensors(seed)
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.index_shuffle_dataset(
+        num_elements=self._num_elements,
+        seed=self._seed,
+        seed2=self._seed2,
+        count=self._count)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.scalar()
+
+  @property
+  def output_types(self):
+    return dtypes.int64
+
+
+def shuffled_indices(num_elements, count=1, seed=None):
+  """Creates a `Dataset` of the indices `[0, num_elements)` in random order.
+
+  Shuffling the indices of an indexed source, and then reading the elements
+  in that order, gives a uniform shuffle without buffering any elements:
+
+  ```python
+  dataset = tf.contrib.data.shuffled_indices(num_records).map(read_record)
+  ```
+
+  Only the indices that have been displaced by the shuffle are kept in memory.
+
+  Args:
+    num_elements: A `tf.int64` scalar `tf.Tensor`, representing the number of
+      indices to shuffle.
+    count: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      number of permutations to produce, each in a different order. If `None`
+      or `-1`, permutations are produced indefinitely.
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+      random seed that will be used to create the distribution. See
+      @{tf.set_random_seed} for behavior.
+
+  Returns:
+    A `Dataset` of `tf.int64` scalars.
+  """
+  return _IndexShuffleDataset(num_elements, count, seed)
@@ -64,6 +64,14 @@ class StatsAggregator(object):
   tf.add_to_collection(tf.GraphKeys.SUMMARIES, stats_summary)
   ```
 
+  In addition to the statistics recorded by the transformations in this module,
+  every iterator in a pipeline records the latency of its `GetNext()` calls and
+  its "self time", which excludes the time spent waiting for its inputs. These
+  appear in the summary as histograms tagged `<iterator prefix>::latency` and
+  `<iterator prefix>::self_time`, with values in microseconds. Use
+  `StatsAggregator.get_bottleneck_report()` to find the iterator that most
+  likely bounds the throughput of the pipeline.
+
   Note: This interface is experimental and expected to change. In particular,
   we expect to add other implementations of `StatsAggregator` that provide
   different ways of exporting statistics, and add more types of statistics.
@@ -84,13 +92,28 @@ class StatsAggregator(object):
     """
     return gen_dataset_ops.stats_aggregator_summary(self._resource)
 
+  def get_bottleneck_report(self):
+    """Returns a string @{tf.Tensor} that identifies the pipeline bottleneck.
+
+    The report ranks the iterators of all subscribed pipelines by their total
+    self time, i.e. the time that each iterator spent in `GetNext()` excluding
+    the time spent in `GetNext()` on its inputs. The first line names the
+    iterator with the largest self time.
+
+    Returns:
+      A scalar string @{tf.Tensor} containing a human-readable report.
+    """
+    return gen_dataset_ops.stats_aggregator_bottleneck_report(self._resource)
+
   def subscribe(self, iterator):
     """Returns a @{tf.Operation} to associate this aggregator with `iterator`.
 
     Note: Each @{tf.data.Iterator} can be associated with at most one
     `StatsAggregator`. After running the operation that this function
     returns, all statistics recorded in the iteration of `iterator`
-    will be stored in `stats_aggregator`.
+    will be stored in `stats_aggregator`. The `GetNext()` latency of each
+    iterator in the pipeline is only recorded if the operation runs before
+    that iterator produces its first element.
 
     Args:
       iterator: A @{tf.data.Iterator} object.
@@ -35,6 +35,32 @@ bool ParseTensorProtoToTensor(const TensorProto& tensor_proto,
   return false;
 }
 
+// Returns the options for the arenas that own the per-step messages
+// below. Most steps feed and fetch a handful of tensors, so the first
+// block is sized to hold such a message and its submessages, and the
+// arena grows geometrically for steps with many sends and receives.
+protobuf::ArenaOptions StepMessageArenaOptions() {
+  protobuf::ArenaOptions options;
+  options.start_block_size = 2048;
+  options.max_block_size = 64 << 10;
+  return options;
+}
+
+// Moves the contents of `src` into `dst`. `TensorProto::Swap()` makes deep
+// copies when the two messages are owned by different arenas, so the
+// potentially large `tensor_content` is exchanged separately (the string
+// buffers themselves are never arena-allocated).
+void MoveTensorProto(TensorProto* src, TensorProto* dst) {
+  if (src->GetArena() == dst->GetArena()) {
+    dst->Swap(src);
+    return;
+  }
+  string tensor_content;
+  tensor_content.swap(*src->mutable_tensor_content());
+  dst->Swap(src);
+  dst->mutable_tensor_content()->swap(tensor_content);
+}
+
 }  // namespace
 
 const string& InMemoryRunStepRequest::session_handle() const {
@@ -127,29 +153,33 @@ const RunStepRequest& InMemoryRunStepRequest::ToProto() const {
   return *proto_version_;
 }
 
+MutableProtoRunStepRequest::MutableProtoRunStepRequest()
+    : arena_(StepMessageArenaOptions()),
+      request_(protobuf::Arena::CreateMessage<RunStepRequest>(&arena_)) {}
+
 const string& MutableProtoRunStepRequest::session_handle() const {
-  return request_.session_handle();
+  return request_->session_handle();
 }
 void MutableProtoRunStepRequest::set_session_handle(const string& handle) {
-  request_.set_session_handle(handle);
+  request_->set_session_handle(handle);
 }
 
 const string& MutableProtoRunStepRequest::partial_run_handle() const {
-  return request_.partial_run_handle();
+  return request_->partial_run_handle();
 }
 void MutableProtoRunStepRequest::set_partial_run_handle(const string& handle) {
-  request_.set_partial_run_handle(handle);
+  request_->set_partial_run_handle(handle);
 }
 
 size_t MutableProtoRunStepRequest::num_feeds() const {
-  return request_.feed_size();
+  return request_->feed_size();
 }
 const string& MutableProtoRunStepRequest::feed_name(size_t i) const {
-  return request_.feed(i).name();
+  return request_->feed(i).name();
 }
 Status MutableProtoRunStepRequest::FeedValue(size_t i,
                                              Tensor* out_tensor) const {
-  if (!ParseTensorProtoToTensor(request_.feed(i).tensor(), out_tensor)) {
+  if (!ParseTensorProtoToTensor(request_->feed(i).tensor(), out_tensor)) {
     return errors::InvalidArgument("Invalid TensorProto for feed value ", i);
   } else {
     return Status::OK();
@@ -158,64 +188,64 @@ Status MutableProtoRunStepRequest::FeedValue(size_t i,
 
 Status MutableProtoRunStepRequest::FeedValue(size_t i,
                                              TensorProto* out_tensor) const {
-  *out_tensor = request_.feed(i).tensor();
+  *out_tensor = request_->feed(i).tensor();
   return Status::OK();
 }
 
 void MutableProtoRunStepRequest::add_feed(const string& name,
                                           const Tensor& value) {
-  NamedTensorProto* feed = request_.add_feed();
+  NamedTensorProto* feed = request_->add_feed();
   feed->set_name(name);
   TensorProto* value_proto = feed->mutable_tensor();
   value.AsProtoTensorContent(value_proto);
 }
 
 size_t MutableProtoRunStepRequest::num_fetches() const {
-  return request_.fetch_size();
+  return request_->fetch_size();
 }
 
 const string& MutableProtoRunStepRequest::fetch_name(size_t i) const {
-  return request_.fetch(i);
+  return request_->fetch(i);
 }
 void MutableProtoRunStepRequest::add_fetch(const string& name) {
-  request_.add_fetch(name);
+  request_->add_fetch(name);
 }
 
 size_t MutableProtoRunStepRequest::num_targets() const {
-  return request_.target_size();
+  return request_->target_size();
 }
 
 const string& MutableProtoRunStepRequest::target_name(size_t i) const {
-  return request_.target(i);
+  return request_->target(i);
 }
 
 void MutableProtoRunStepRequest::add_target(const string& name) {
-  request_.add_target(name);
+  request_->add_target(name);
 }
 
 const RunOptions& MutableProtoRunStepRequest::options() const {
-  return request_.options();
+  return request_->options();
 }
 
 RunOptions* MutableProtoRunStepRequest::mutable_options() {
-  return request_.mutable_options();
+  return request_->mutable_options();
 }
 
 bool MutableProtoRunStepRequest::store_errors_in_response_body() const {
-  return request_.store_errors_in_response_body();
+  return request_->store_errors_in_response_body();
 }
 
 void MutableProtoRunStepRequest::set_store_errors_in_response_body(
     bool store_errors) {
-  request_.set_store_errors_in_response_body(store_errors);
+  request_->set_store_errors_in_response_body(store_errors);
 }
 
 string MutableProtoRunStepRequest::DebugString() const {
-  return request_.DebugString();
+  return request_->DebugString();
 }
 
 const RunStepRequest& MutableProtoRunStepRequest::ToProto() const {
-  return request_;
+  return *request_;
 }
 
 ProtoRunStepRequest::ProtoRunStepRequest(const RunStepRequest* request)
@@ -381,49 +411,53 @@ const RunGraphRequest& InMemoryRunGraphRequest::ToProto() const {
   return *proto_version_;
 }
 
+MutableProtoRunGraphRequest::MutableProtoRunGraphRequest()
+    : arena_(StepMessageArenaOptions()),
+      request_(protobuf::Arena::CreateMessage<RunGraphRequest>(&arena_)) {}
+
 const string& MutableProtoRunGraphRequest::session_handle() const {
-  return request_.session_handle();
+  return request_->session_handle();
 }
 
 void MutableProtoRunGraphRequest::set_session_handle(const string& handle) {
-  request_.set_session_handle(handle);
+  request_->set_session_handle(handle);
 }
 
 const string& MutableProtoRunGraphRequest::graph_handle() const {
-  return request_.graph_handle();
+  return request_->graph_handle();
 }
 
 void MutableProtoRunGraphRequest::set_graph_handle(const string& handle) {
-  request_.set_graph_handle(handle);
+  request_->set_graph_handle(handle);
 }
 
 int64 MutableProtoRunGraphRequest::step_id() const {
-  return request_.step_id();
+  return request_->step_id();
 }
 
 void MutableProtoRunGraphRequest::set_step_id(int64 step_id) {
-  request_.set_step_id(step_id);
+  request_->set_step_id(step_id);
 }
 
 const ExecutorOpts& MutableProtoRunGraphRequest::exec_opts() const {
-  return request_.exec_opts();
+  return request_->exec_opts();
 }
 
 ExecutorOpts* MutableProtoRunGraphRequest::mutable_exec_opts() {
-  return request_.mutable_exec_opts();
+  return request_->mutable_exec_opts();
 }
 
 size_t MutableProtoRunGraphRequest::num_sends() const {
-  return request_.send_size();
+  return request_->send_size();
 }
 
 const string& MutableProtoRunGraphRequest::send_key(size_t i) const {
-  return request_.send(i).name();
+  return request_->send(i).name();
 }
 
 Status MutableProtoRunGraphRequest::SendValue(size_t i,
                                               Tensor* out_tensor) const {
-  if (!ParseTensorProtoToTensor(request_.send(i).tensor(), out_tensor)) {
+  if (!ParseTensorProtoToTensor(request_->send(i).tensor(), out_tensor)) {
     return errors::InvalidArgument("Invalid TensorProto for feed value ", i);
   } else {
     return Status::OK();
@@ -433,52 +467,52 @@ Status MutableProtoRunGraphRequest::SendValue(size_t i,
 Status MutableProtoRunGraphRequest::AddSendFromRunStepRequest(
     const RunStepRequestWrapper& run_step_request, size_t i,
     const string& send_key) {
-  NamedTensorProto* send = request_.add_send();
+  NamedTensorProto* send = request_->add_send();
   send->set_name(send_key);
   TF_RETURN_IF_ERROR(run_step_request.FeedValue(i, send->mutable_tensor()));
   return Status::OK();
 }
 
 size_t MutableProtoRunGraphRequest::num_recvs() const {
-  return request_.recv_key_size();
+  return request_->recv_key_size();
 }
 
 const string& MutableProtoRunGraphRequest::recv_key(size_t i) const {
-  return request_.recv_key(i);
+  return request_->recv_key(i);
 }
 
 void MutableProtoRunGraphRequest::add_recv_key(const string& recv_key) {
-  request_.add_recv_key(recv_key);
+  request_->add_recv_key(recv_key);
 }
 
 bool MutableProtoRunGraphRequest::is_partial() const {
-  return request_.is_partial();
+  return request_->is_partial();
 }
 
 void MutableProtoRunGraphRequest::set_is_partial(bool is_partial) {
-  request_.set_is_partial(is_partial);
+  request_->set_is_partial(is_partial);
 }
 
 bool MutableProtoRunGraphRequest::is_last_partial_run() const {
-  return request_.is_last_partial_run();
+  return request_->is_last_partial_run();
 }
 
 void MutableProtoRunGraphRequest::set_is_last_partial_run(
     bool is_last_partial_run) {
-  request_.set_is_last_partial_run(is_last_partial_run);
+  request_->set_is_last_partial_run(is_last_partial_run);
 }
 
 bool MutableProtoRunGraphRequest::store_errors_in_response_body() const {
-  return request_.store_errors_in_response_body();
+  return request_->store_errors_in_response_body();
 }
 
 void MutableProtoRunGraphRequest::set_store_errors_in_response_body(
     bool store_errors) {
-  request_.set_store_errors_in_response_body(store_errors);
+  request_->set_store_errors_in_response_body(store_errors);
 }
 
 const RunGraphRequest& MutableProtoRunGraphRequest::ToProto() const {
-  return request_;
+  return *request_;
 }
 
 ProtoRunGraphRequest::ProtoRunGraphRequest(const RunGraphRequest* request)
@@ -592,22 +626,26 @@ void InMemoryRunGraphResponse::AddPartitionGraph(
   partition_graphs_.push_back(partition_graph);
 }
 
+OwnedProtoRunGraphResponse::OwnedProtoRunGraphResponse()
+    : arena_(StepMessageArenaOptions()),
+      response_(protobuf::Arena::CreateMessage<RunGraphResponse>(&arena_)) {}
+
 size_t OwnedProtoRunGraphResponse::num_recvs() const {
-  return response_.recv_size();
+  return response_->recv_size();
 }
 
 const string& OwnedProtoRunGraphResponse::recv_key(size_t i) const {
-  return response_.recv(i).name();
+  return response_->recv(i).name();
 }
 
 Status OwnedProtoRunGraphResponse::RecvValue(size_t i,
                                              TensorProto* out_tensor) {
-  out_tensor->Swap(response_.mutable_recv(i)->mutable_tensor());
+  MoveTensorProto(response_->mutable_recv(i)->mutable_tensor(), out_tensor);
   return Status::OK();
 }
 
 Status OwnedProtoRunGraphResponse::RecvValue(size_t i, Tensor* out_tensor) {
-  if (!ParseTensorProtoToTensor(response_.recv(i).tensor(), out_tensor)) {
+  if (!ParseTensorProtoToTensor(response_->recv(i).tensor(), out_tensor)) {
     return errors::InvalidArgument("Invalid TensorProto for recv value ", i);
   } else {
     return Status::OK();
@@ -616,46 +654,46 @@ Status OwnedProtoRunGraphResponse::RecvValue(size_t i, Tensor* out_tensor) {
 
 void OwnedProtoRunGraphResponse::AddRecv(const string& key,
                                          const Tensor& value) {
-  NamedTensorProto* recv = response_.add_recv();
+  NamedTensorProto* recv = response_->add_recv();
   recv->set_name(key);
   TensorProto* value_proto = recv->mutable_tensor();
   value.AsProtoTensorContent(value_proto);
 }
 
 StepStats* OwnedProtoRunGraphResponse::mutable_step_stats() {
-  return response_.mutable_step_stats();
+  return response_->mutable_step_stats();
 }
 
 CostGraphDef* OwnedProtoRunGraphResponse::mutable_cost_graph() {
-  return response_.mutable_cost_graph();
+  return response_->mutable_cost_graph();
 }
 
 errors::Code OwnedProtoRunGraphResponse::status_code() const {
-  return response_.status_code();
+  return response_->status_code();
 }
 
 const string& OwnedProtoRunGraphResponse::status_error_message() const {
-  return response_.status_error_message();
+  return response_->status_error_message();
 }
 
 void OwnedProtoRunGraphResponse::set_status(const Status& status) {
-  response_.set_status_code(status.code());
-  response_.set_status_error_message(status.error_message());
+  response_->set_status_code(status.code());
+  response_->set_status_error_message(status.error_message());
 }
 
-RunGraphResponse* OwnedProtoRunGraphResponse::get_proto() { return &response_; }
+RunGraphResponse* OwnedProtoRunGraphResponse::get_proto() { return response_; }
 
 size_t OwnedProtoRunGraphResponse::num_partition_graphs() const {
-  return response_.partition_graph_size();
+  return response_->partition_graph_size();
 }
 
 GraphDef* OwnedProtoRunGraphResponse::mutable_partition_graph(size_t i) {
-  return response_.mutable_partition_graph(i);
+  return response_->mutable_partition_graph(i);
 }
 
 void OwnedProtoRunGraphResponse::AddPartitionGraph(
     const GraphDef& partition_graph) {
-  GraphDef* graph_def = response_.mutable_partition_graph()->Add();
+  GraphDef* graph_def = response_->mutable_partition_graph()->Add();
   *graph_def = partition_graph;
 }
 
@@ -673,7 +711,7 @@ const string& NonOwnedProtoRunGraphResponse::recv_key(size_t i) const {
 
 Status NonOwnedProtoRunGraphResponse::RecvValue(size_t i,
                                                 TensorProto* out_tensor) {
-  out_tensor->Swap(response_->mutable_recv(i)->mutable_tensor());
+  MoveTensorProto(response_->mutable_recv(i)->mutable_tensor(), out_tensor);
   return Status::OK();
 }
 
@@ -777,17 +815,21 @@ RunStepResponse* InMemoryRunStepResponse::get_proto() {
   return nullptr;
 }
 
+OwnedProtoRunStepResponse::OwnedProtoRunStepResponse()
+    : arena_(StepMessageArenaOptions()),
+      response_(protobuf::Arena::CreateMessage<RunStepResponse>(&arena_)) {}
+
 size_t OwnedProtoRunStepResponse::num_tensors() const {
-  return response_.tensor_size();
+  return response_->tensor_size();
 }
 
 const string& OwnedProtoRunStepResponse::tensor_name(size_t i) const {
-  return response_.tensor(i).name();
+  return response_->tensor(i).name();
 }
 
 Status OwnedProtoRunStepResponse::TensorValue(size_t i,
                                               Tensor* out_tensor) const {
-  if (!ParseTensorProtoToTensor(response_.tensor(i).tensor(), out_tensor)) {
+  if (!ParseTensorProtoToTensor(response_->tensor(i).tensor(), out_tensor)) {
     return errors::InvalidArgument("Invalid TensorProto for fetch value ", i);
   } else {
     return Status::OK();
@@ -795,35 +837,35 @@ Status OwnedProtoRunStepResponse::TensorValue(size_t i,
 }
 
 const RunMetadata& OwnedProtoRunStepResponse::metadata() const {
-  return response_.metadata();
+  return response_->metadata();
 }
 
 Status OwnedProtoRunStepResponse::AddTensorFromRunGraphResponse(
     const string& name, MutableRunGraphResponseWrapper* run_graph_response,
     size_t i) {
-  NamedTensorProto* response_tensor = response_.add_tensor();
+  NamedTensorProto* response_tensor = response_->add_tensor();
   response_tensor->set_name(name);
   return run_graph_response->RecvValue(i, response_tensor->mutable_tensor());
 }
 
 RunMetadata* OwnedProtoRunStepResponse::mutable_metadata() {
-  return response_.mutable_metadata();
+  return response_->mutable_metadata();
 }
 
 errors::Code OwnedProtoRunStepResponse::status_code() const {
-  return response_.status_code();
+  return response_->status_code();
 }
 
 const string& OwnedProtoRunStepResponse::status_error_message() const {
-  return response_.status_error_message();
+  return response_->status_error_message();
 }
 
 void OwnedProtoRunStepResponse::set_status(const Status& status) {
-  response_.set_status_code(status.code());
-  response_.set_status_error_message(status.error_message());
+  response_->set_status_code(status.code());
+  response_->set_status_error_message(status.error_message());
 }
 
-RunStepResponse* OwnedProtoRunStepResponse::get_proto() { return &response_; }
+RunStepResponse* OwnedProtoRunStepResponse::get_proto() { return response_; }
 
 NonOwnedProtoRunStepResponse::NonOwnedProtoRunStepResponse(
     RunStepResponse* response)
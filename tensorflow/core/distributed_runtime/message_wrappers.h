@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb_text.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -162,6 +163,8 @@ class InMemoryRunStepRequest : public MutableRunStepRequestWrapper {
 // client and master in different address spaces.
 class MutableProtoRunStepRequest : public MutableRunStepRequestWrapper {
  public:
+  MutableProtoRunStepRequest();
+
   // RunStepRequestWrapper methods.
   const string& session_handle() const override;
   const string& partial_run_handle() const override;
@@ -188,7 +191,9 @@ class MutableProtoRunStepRequest : public MutableRunStepRequestWrapper {
   void set_store_errors_in_response_body(bool store_errors) override;
 
  private:
-  RunStepRequest request_;
+  // Owns `request_` and its submessages.
+  protobuf::Arena arena_;
+  RunStepRequest* const request_;
 };
 
 // Wrapper for immutable RunStep requests that use a non-owned
@@ -362,6 +367,8 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
 
 class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
  public:
+  MutableProtoRunGraphRequest();
+
   // RunGraphRequestWrapper methods.
   const string& session_handle() const override;
   const string& graph_handle() const override;
@@ -391,7 +398,9 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
   void set_store_errors_in_response_body(bool store_errors) override;
 
  private:
-  RunGraphRequest request_;
+  // Owns `request_` and its submessages.
+  protobuf::Arena arena_;
+  RunGraphRequest* const request_;
 };
 
 class ProtoRunGraphRequest : public RunGraphRequestWrapper {
@@ -513,6 +522,8 @@ class InMemoryRunGraphResponse : public MutableRunGraphResponseWrapper {
 // Proto-based message wrapper for use on the client side of the RunGraph RPC.
 class OwnedProtoRunGraphResponse : public MutableRunGraphResponseWrapper {
  public:
+  OwnedProtoRunGraphResponse();
+
   // MutableRunGraphResponseWrapper methods.
   size_t num_recvs() const override;
   const string& recv_key(size_t i) const override;
@@ -532,7 +543,9 @@ class OwnedProtoRunGraphResponse : public MutableRunGraphResponseWrapper {
   RunGraphResponse* get_proto() override;
 
  private:
-  RunGraphResponse response_;
+  // Owns `response_` and its submessages.
+  protobuf::Arena arena_;
+  RunGraphResponse* const response_;
 };
 
 // Proto-based message wrapper for use on the server side of the RunGraph RPC.
@@ -655,6 +668,8 @@ class InMemoryRunStepResponse : public MutableRunStepResponseWrapper {
 // Proto-based message wrapper for use on the client side of the RunStep RPC.
 class OwnedProtoRunStepResponse : public MutableRunStepResponseWrapper {
  public:
+  OwnedProtoRunStepResponse();
+
   // MutableRunStepResponseWrapper methods.
   size_t num_tensors() const override;
   const string& tensor_name(size_t i) const override;
@@ -672,7 +687,9 @@ class OwnedProtoRunStepResponse : public MutableRunStepResponseWrapper {
   RunStepResponse* get_proto() override;
 
  private:
-  RunStepResponse response_;
+  // Owns `response_` and its submessages.
+  protobuf::Arena arena_;
+  RunStepResponse* const response_;
 };
 
 // Proto-based message wrapper for use on the server side of the RunStep RPC.
@@ -338,6 +338,27 @@ TEST(MessageWrappers, RunStepResponse_Basic) {
     BuildRunStepResponse(&run_graph_response, &response);
     CheckRunStepResponse(response);
   }
+
+  {
+    // Worker -(owned proto)-> Master -(owned proto)-> Client.
+    // The tensors move between messages owned by two different arenas.
+    OwnedProtoRunGraphResponse run_graph_response;
+    BuildRunGraphResponse(&run_graph_response);
+    OwnedProtoRunStepResponse response;
+    BuildRunStepResponse(&run_graph_response, &response);
+    CheckRunStepResponse(response);
+  }
+
+  {
+    // Worker -(owned proto)-> Master -(non-owned proto)-> Client.
+    // The tensors move from an arena-owned message to a heap message.
+    OwnedProtoRunGraphResponse run_graph_response;
+    BuildRunGraphResponse(&run_graph_response);
+    RunStepResponse response_proto;
+    NonOwnedProtoRunStepResponse response(&response_proto);
+    BuildRunStepResponse(&run_graph_response, &response);
+    CheckRunStepResponse(response);
+  }
 }
 
 }  // namespace
@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 
+#include <type_traits>
+
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 #include "grpc++/grpc++.h"
 #include "grpc++/impl/codegen/service_type.h"
@@ -129,6 +132,26 @@ class UntypedCall : public core::RefCounted {
   };
 };
 
+// Allocates an object of type `T` on `arena`. Protocol buffer messages with
+// arena support are constructed with the arena, so that their submessages
+// (e.g. the `NamedTensorProto`s of a `RunGraphRequest`) are allocated from it
+// too. Any other type (e.g. `::grpc::ByteBuffer`) is simply placed on the
+// arena and destroyed with it.
+template <class T>
+T* CreateOnArena(protobuf::Arena* arena, std::true_type /* arena message */) {
+  return protobuf::Arena::CreateMessage<T>(arena);
+}
+template <class T>
+T* CreateOnArena(protobuf::Arena* arena, std::false_type /* arena message */) {
+  return protobuf::Arena::Create<T>(arena);
+}
+template <class T>
+T* CreateOnArena(protobuf::Arena* arena) {
+  return CreateOnArena<T>(
+      arena, std::integral_constant<
+                 bool, protobuf::Arena::is_arena_constructable<T>::value>());
+}
+
 // Represents a pending call with known request and response message
 // types, and a known request-handling method.
 template <class Service, class GrpcService, class RequestMessage,
@@ -149,7 +172,10 @@ class Call : public UntypedCall<Service> {
       Call<Service, GrpcService, RequestMessage, ResponseMessage>*);
 
   Call(HandleRequestFunction handle_request_function)
-      : handle_request_function_(handle_request_function), responder_(&ctx_) {}
+      : request(*CreateOnArena<RequestMessage>(&arena_)),
+        response(*CreateOnArena<ResponseMessage>(&arena_)),
+        handle_request_function_(handle_request_function),
+        responder_(&ctx_) {}
 
   virtual ~Call() {}
 
@@ -231,8 +257,16 @@ class Call : public UntypedCall<Service> {
                                     &call->request_received_tag_);
   }
 
-  RequestMessage request;
-  ResponseMessage response;
+ private:
+  // Owns `request`, `response` and their submessages, so that receiving a
+  // large request and building its response costs a few arena blocks
+  // instead of one heap allocation per submessage. Declared before them so
+  // that it is constructed first.
+  protobuf::Arena arena_;
+
+ public:
+  RequestMessage& request;
+  ResponseMessage& response;
 
   const std::multimap<::grpc::string_ref, ::grpc::string_ref>& client_metadata()
       const {
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <map>
 #include <unordered_map>
@@ -53,6 +55,15 @@ Status ValidateHostPortPair(const string& host_port) {
   }
   return Status::OK();
 }
+
+::grpc::ChannelArguments GetChannelArguments() {
+  ::grpc::ChannelArguments args;
+  args.SetInt(GRPC_ARG_MAX_MESSAGE_LENGTH, std::numeric_limits<int32>::max());
+  // NOTE(mrry): Some versions of gRPC use a 20-second minimum backoff
+  // on connection failure, which makes our tests time out.
+  args.SetInt("grpc.testing.fixed_reconnect_backoff_ms", 1000);
+  return args;
+}
 }  // namespace
 
 Status NewHostPortGrpcChannel(const string& target,
@@ -61,11 +72,22 @@ Status NewHostPortGrpcChannel(const string& target,
   TF_RETURN_IF_ERROR(ValidateHostPortPair(target));
 
   // TODO(mrry): Implement secure channels.
-  ::grpc::ChannelArguments args;
-  args.SetInt(GRPC_ARG_MAX_MESSAGE_LENGTH, std::numeric_limits<int32>::max());
-  // NOTE(mrry): Some versions of gRPC use a 20-second minimum backoff
-  // on connection failure, which makes our tests time out.
-  args.SetInt("grpc.testing.fixed_reconnect_backoff_ms", 1000);
+  *channel_pointer =
+      ::grpc::CreateCustomChannel("dns:///" + target,
+                                  ::grpc::InsecureChannelCredentials(),
+                                  GetChannelArguments());
+  return Status::OK();
+}
+
+Status NewUnsharedHostPortGrpcChannel(const string& target,
+                                      SharedGrpcChannelPtr* channel_pointer) {
+  TF_RETURN_IF_ERROR(ValidateHostPortPair(target));
+
+  // gRPC reuses a connection between channels whose arguments are
+  // identical, so we tag each channel with a unique (ignored) argument.
+  static std::atomic<int> next_channel_id(0);
+  ::grpc::ChannelArguments args = GetChannelArguments();
+  args.SetInt("grpc.tensorflow.channel_id", next_channel_id++);
   *channel_pointer = ::grpc::CreateCustomChannel(
       "dns:///" + target, ::grpc::InsecureChannelCredentials(), args);
   return Status::OK();
@@ -108,7 +130,7 @@ Status GrpcChannelSpec::AddHostPortsJob(
 
 namespace {
 
-// GrpcChannelCache that caches results to FindWorkerChannel() calls.
+// GrpcChannelCache that caches results to FindWorkerChannelPool() calls.
 class CachingGrpcChannelCache : public GrpcChannelCache {
  public:
   CachingGrpcChannelCache() {}
@@ -116,32 +138,41 @@ class CachingGrpcChannelCache : public GrpcChannelCache {
   ~CachingGrpcChannelCache() override {}
 
   SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
-    SharedGrpcChannelPtr ch = nullptr;
+    std::vector<SharedGrpcChannelPtr> pool = FindWorkerChannelPool(target);
+    return pool.empty() ? nullptr : pool[0];
+  }
+
+  std::vector<SharedGrpcChannelPtr> FindWorkerChannelPool(
+      const string& target) override {
     {
       mutex_lock l(mu_);  // could use reader lock
-      ch = gtl::FindPtrOrNull(channels_, target);
-      if (ch) {
-        return ch;
+      auto iter = channels_.find(target);
+      if (iter != channels_.end()) {
+        return iter->second;
       }
     }
-    ch = FindChannelOnce(target);
-    if (ch) {
+    std::vector<SharedGrpcChannelPtr> pool = FindChannelPoolOnce(target);
+    if (!pool.empty()) {
       mutex_lock l(mu_);
-      channels_.insert({target, ch});
+      // If another thread raced with us, keep the pool it inserted so
+      // that all callers observe the same channels.
+      return channels_.insert({target, std::move(pool)}).first->second;
     }
-    return ch;
+    return pool;
   }
 
  protected:
-  // Find the ClientChannel for "target".  Only called when no channel was
-  // found in the channels_ cache for "target".  A non nullptr result will be
-  // cached in channels_.
-  virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
+  // Find the ClientChannels for "target".  Only called when no pool was
+  // found in the channels_ cache for "target".  A non-empty result will be
+  // cached in channels_, and must not contain nullptr.
+  virtual std::vector<SharedGrpcChannelPtr> FindChannelPoolOnce(
+      const string& target) = 0;
 
  private:
   // TODO(zhifengc): Eviction when the map becomes too big.
   mutex mu_;
-  std::unordered_map<string, SharedGrpcChannelPtr> channels_ GUARDED_BY(mu_);
+  std::unordered_map<string, std::vector<SharedGrpcChannelPtr>> channels_
+      GUARDED_BY(mu_);
 };
 
 // A ChannelCache that is the union of multiple ChannelCaches.
@@ -182,16 +213,18 @@ class MultiGrpcChannelCache : public CachingGrpcChannelCache {
   }
 
  protected:
-  SharedGrpcChannelPtr FindChannelOnce(const string& target) override {
+  std::vector<SharedGrpcChannelPtr> FindChannelPoolOnce(
+      const string& target) override {
     for (GrpcChannelCache* cache : caches_) {
-      SharedGrpcChannelPtr ch(cache->FindWorkerChannel(target));
-      if (ch) {
+      std::vector<SharedGrpcChannelPtr> pool =
+          cache->FindWorkerChannelPool(target);
+      if (!pool.empty()) {
         mutex_lock l(mu_);
         target_caches_.insert({target, cache});
-        return ch;
+        return pool;
       }
     }
-    return nullptr;
+    return {};
   }
 
  private:
@@ -208,10 +241,12 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
  public:
   SparseGrpcChannelCache(const string& job_id,
                          const std::map<int, string>& host_ports,
-                         ChannelCreationFunction channel_func)
+                         ChannelCreationFunction channel_func,
+                         int num_channels_per_target)
       : job_id_(job_id),
         host_ports_(host_ports),
-        channel_func_(std::move(channel_func)) {
+        channel_func_(std::move(channel_func)),
+        num_channels_per_target_(std::max(1, num_channels_per_target)) {
     LOG(INFO) << "Initialize GrpcChannelCache for job " << ToString();
   }
   ~SparseGrpcChannelCache() override {}
@@ -248,12 +283,22 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
   }
 
  protected:
-  SharedGrpcChannelPtr FindChannelOnce(const string& target) override {
+  std::vector<SharedGrpcChannelPtr> FindChannelPoolOnce(
+      const string& target) override {
     const string host_port = TranslateTask(target);
     if (host_port.empty()) {
-      return nullptr;
+      return {};
+    }
+    std::vector<SharedGrpcChannelPtr> pool;
+    pool.reserve(num_channels_per_target_);
+    for (int i = 0; i < num_channels_per_target_; ++i) {
+      SharedGrpcChannelPtr ch = channel_func_(host_port);
+      if (!ch) {
+        return {};
+      }
+      pool.push_back(std::move(ch));
     }
-    return channel_func_(host_port);
+    return pool;
   }
 
  private:
@@ -271,13 +316,15 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
   const string job_id_;
   const std::map<int, string> host_ports_;
   const ChannelCreationFunction channel_func_;
+  const int num_channels_per_target_;
   TF_DISALLOW_COPY_AND_ASSIGN(SparseGrpcChannelCache);
 };
 
 }  // namespace
 
 GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
-                                      ChannelCreationFunction channel_func) {
+                                      ChannelCreationFunction channel_func,
+                                      int num_channels_per_target) {
   const int num_jobs = spec.host_ports_jobs().size();
   if (!num_jobs) {
     LOG(ERROR) << "Empty channel spec.";
@@ -286,8 +333,8 @@ GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
   std::vector<GrpcChannelCache*> caches;
   caches.reserve(num_jobs);
   for (auto& job : spec.host_ports_jobs()) {
-    caches.push_back(
-        new SparseGrpcChannelCache(job.job_id, job.host_ports, channel_func));
+    caches.push_back(new SparseGrpcChannelCache(
+        job.job_id, job.host_ports, channel_func, num_channels_per_target));
   }
   return caches.size() == 1 ? caches[0] : new MultiGrpcChannelCache(caches);
 }
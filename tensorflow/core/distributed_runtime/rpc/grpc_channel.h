@@ -73,14 +73,35 @@ class GrpcChannelCache {
   // E.g., /job:mnist/task:2
   virtual SharedGrpcChannelPtr FindWorkerChannel(const string& target) = 0;
 
+  // If found, returns the pool of gRPC channels that are connected to
+  // the remote worker named by 'target'. The pool is never empty when
+  // 'target' is found, and its first element is the channel returned by
+  // FindWorkerChannel(target). Returns an empty vector otherwise.
+  //
+  // The default implementation returns a pool of one channel.
+  virtual std::vector<SharedGrpcChannelPtr> FindWorkerChannelPool(
+      const string& target) {
+    SharedGrpcChannelPtr ch = FindWorkerChannel(target);
+    if (!ch) return {};
+    return {std::move(ch)};
+  }
+
   // Translates a string in the form `/job:X/task:Z` into a host_port.
   virtual string TranslateTask(const string& task) = 0;
 };
 
 typedef std::function<SharedGrpcChannelPtr(string)> ChannelCreationFunction;
 
+// Returns a GrpcChannelCache for the jobs in `channel_spec`.
+//
+// If `num_channels_per_target` is greater than one, the cache opens a
+// pool of that many channels to each target, by invoking `channel_func`
+// once per channel. Pooling is only effective if `channel_func` returns
+// channels that do not share a transport (see
+// NewUnsharedHostPortGrpcChannel()).
 GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& channel_spec,
-                                      ChannelCreationFunction channel_func);
+                                      ChannelCreationFunction channel_func,
+                                      int num_channels_per_target = 1);
 
 // Below here are internal-only functions.
 
@@ -91,6 +112,13 @@ ChannelCreationFunction ConvertToChannelCreationFunction(
 Status NewHostPortGrpcChannel(const string& target,
                               SharedGrpcChannelPtr* channel_pointer);
 
+// Like NewHostPortGrpcChannel(), but every returned channel is given
+// distinct channel arguments, so that gRPC opens a separate HTTP/2
+// connection for it instead of multiplexing it with other channels to
+// the same target.
+Status NewUnsharedHostPortGrpcChannel(const string& target,
+                                      SharedGrpcChannelPtr* channel_pointer);
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CHANNEL_H_
@@ -144,6 +144,51 @@ TEST(GrpcChannelTest, SparseHostPorts) {
             workers);
 }
 
+TEST(GrpcChannelTest, ChannelPool) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {"a:1", "b:2"}));
+  TF_EXPECT_OK(spec.AddHostPortsJob("ps", {{1, "c:3"}}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewUnsharedHostPortGrpcChannel);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, /*num_channels_per_target=*/3));
+
+  EXPECT_TRUE(cc->FindWorkerChannelPool("invalid_target").empty());
+  EXPECT_TRUE(cc->FindWorkerChannelPool("/job:mnist/replica:0/task:2").empty());
+  EXPECT_TRUE(cc->FindWorkerChannelPool("/job:ps/replica:0/task:0").empty());
+
+  for (const string& target :
+       {"/job:mnist/replica:0/task:0", "/job:ps/replica:0/task:1"}) {
+    std::vector<SharedGrpcChannelPtr> pool_1 =
+        cc->FindWorkerChannelPool(target);
+    std::vector<SharedGrpcChannelPtr> pool_2 =
+        cc->FindWorkerChannelPool(target);
+    ASSERT_EQ(3, pool_1.size());
+    EXPECT_EQ(pool_1, pool_2);
+    EXPECT_EQ(pool_1[0].get(), cc->FindWorkerChannel(target).get());
+    EXPECT_NE(pool_1[0].get(), pool_1[1].get());
+    EXPECT_NE(pool_1[0].get(), pool_1[2].get());
+    EXPECT_NE(pool_1[1].get(), pool_1[2].get());
+  }
+
+  EXPECT_NE(cc->FindWorkerChannel("/job:mnist/replica:0/task:0").get(),
+            cc->FindWorkerChannel("/job:mnist/replica:0/task:1").get());
+}
+
+TEST(GrpcChannelTest, DefaultChannelPoolHasOneChannel) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {"a:1"}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  std::unique_ptr<GrpcChannelCache> cc(NewGrpcChannelCache(spec, channel_func));
+
+  std::vector<SharedGrpcChannelPtr> pool =
+      cc->FindWorkerChannelPool("/job:mnist/replica:0/task:0");
+  ASSERT_EQ(1, pool.size());
+  EXPECT_EQ(pool[0].get(),
+            cc->FindWorkerChannel("/job:mnist/replica:0/task:0").get());
+}
+
 TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
   SharedGrpcChannelPtr mock_ptr;
 
@@ -154,6 +199,10 @@ TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
   EXPECT_FALSE(NewHostPortGrpcChannel("example.com/abc:2222", &mock_ptr).ok());
   EXPECT_FALSE(NewHostPortGrpcChannel("127.0.0.1:2222/", &mock_ptr).ok());
   EXPECT_FALSE(NewHostPortGrpcChannel("example.com/abc:", &mock_ptr).ok());
+
+  EXPECT_TRUE(NewUnsharedHostPortGrpcChannel("127.0.0.1:2222", &mock_ptr).ok());
+  EXPECT_FALSE(
+      NewUnsharedHostPortGrpcChannel("example.com/abc:2222", &mock_ptr).ok());
 }
 
 }  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <atomic>
 #include <utility>
+#include <vector>
 
 #include "grpc++/generic/generic_stub.h"
 #include "grpc++/grpc++.h"
@@ -39,12 +41,10 @@ namespace tensorflow {
 
 class GrpcRemoteWorker : public WorkerInterface {
  public:
-  explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
+  explicit GrpcRemoteWorker(const std::vector<SharedGrpcChannelPtr>& channels,
                             ::grpc::CompletionQueue* completion_queue,
                             WorkerCacheLogger* logger)
-      : channel_(std::move(channel)),
-        stub_(channel_),
-        cq_(completion_queue),
+      : cq_(completion_queue),
         getstatus_(Method(GrpcWorkerMethod::kGetStatus)),
         createworkersession_(Method(GrpcWorkerMethod::kCreateWorkerSession)),
         deleteworkersession_(Method(GrpcWorkerMethod::kDeleteWorkerSession)),
@@ -56,7 +56,13 @@ class GrpcRemoteWorker : public WorkerInterface {
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
-        logger_(logger) {}
+        logger_(logger) {
+    CHECK(!channels.empty());
+    channels_.reserve(channels.size());
+    for (const SharedGrpcChannelPtr& channel : channels) {
+      channels_.emplace_back(new ChannelState(channel));
+    }
+  }
 
   ~GrpcRemoteWorker() override {}
 
@@ -92,13 +98,15 @@ class GrpcRemoteWorker : public WorkerInterface {
 
   void RunGraphAsync(CallOptions* call_opts, const RunGraphRequest* request,
                      RunGraphResponse* response, StatusCallback done) override {
-    IssueRequest(request, response, rungraph_, std::move(done), call_opts);
+    IssueLoadBalancedRequest<protobuf::Message>(
+        request, response, rungraph_, std::move(done), call_opts);
   }
   void RunGraphAsync(CallOptions* call_opts, RunGraphRequestWrapper* request,
                      MutableRunGraphResponseWrapper* response,
                      StatusCallback done) override {
-    IssueRequest(&request->ToProto(), get_proto_from_wrapper(response),
-                 rungraph_, std::move(done), call_opts);
+    IssueLoadBalancedRequest<protobuf::Message>(
+        &request->ToProto(), get_proto_from_wrapper(response), rungraph_,
+        std::move(done), call_opts);
   }
 
   void CleanupGraphAsync(const CleanupGraphRequest* request,
@@ -168,7 +176,8 @@ class GrpcRemoteWorker : public WorkerInterface {
       cb_to_use = &wrapper_done;
     }
 
-    IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
+    IssueLoadBalancedRequest<TensorResponse>(request, response, recvtensor_,
+                                             *cb_to_use, call_opts);
   }
 
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
@@ -182,26 +191,70 @@ class GrpcRemoteWorker : public WorkerInterface {
   }
 
  private:
+  // A channel to the remote worker, and the number of calls issued with
+  // IssueLoadBalancedRequest() that are outstanding on it.
+  struct ChannelState {
+    explicit ChannelState(SharedGrpcChannelPtr ch)
+        : channel(std::move(ch)), stub(channel), in_flight(0) {}
+
+    SharedGrpcChannelPtr channel;
+    ::grpc::GenericStub stub;
+    std::atomic<int64> in_flight;
+  };
+
   // Utility method for issuing a generic asynchronous request. The
   // given callback, `done`, will be called when the RPC completes.
   void IssueRequest(const protobuf::Message* request,
                     protobuf::Message* response, const ::grpc::string& method,
                     StatusCallback done, CallOptions* call_opts = nullptr) {
-    new RPCState<protobuf::Message>(&stub_, cq_, method, *request, response,
-                                    std::move(done), call_opts);
+    new RPCState<protobuf::Message>(&channels_[0]->stub, cq_, method, *request,
+                                    response, std::move(done), call_opts);
   }
-  void IssueRequest(const protobuf::Message* request, TensorResponse* response,
-                    const ::grpc::string& method, StatusCallback done,
-                    CallOptions* call_opts = nullptr) {
-    new RPCState<TensorResponse>(&stub_, cq_, method, *request, response,
-                                 std::move(done), call_opts);
+
+  // Like IssueRequest(), but sends the request on the channel with the
+  // fewest outstanding calls, so that concurrent large transfers to the
+  // same worker are spread across the connections in the pool.
+  template <class Response>
+  void IssueLoadBalancedRequest(const protobuf::Message* request,
+                                Response* response,
+                                const ::grpc::string& method,
+                                StatusCallback done, CallOptions* call_opts) {
+    if (channels_.size() == 1) {
+      new RPCState<Response>(&channels_[0]->stub, cq_, method, *request,
+                             response, std::move(done), call_opts);
+      return;
+    }
+    ChannelState* ch = LeastLoadedChannel();
+    ch->in_flight.fetch_add(1, std::memory_order_relaxed);
+    new RPCState<Response>(&ch->stub, cq_, method, *request, response,
+                           [ch, done](const Status& s) {
+                             ch->in_flight.fetch_sub(
+                                 1, std::memory_order_relaxed);
+                             done(s);
+                           },
+                           call_opts);
+  }
+
+  // Returns the channel with the fewest outstanding calls. Ties go to the
+  // lowest index, so a lightly loaded worker keeps using one connection.
+  ChannelState* LeastLoadedChannel() {
+    ChannelState* best = channels_[0].get();
+    int64 best_load = best->in_flight.load(std::memory_order_relaxed);
+    for (size_t i = 1; i < channels_.size() && best_load > 0; ++i) {
+      const int64 load =
+          channels_[i]->in_flight.load(std::memory_order_relaxed);
+      if (load < best_load) {
+        best = channels_[i].get();
+        best_load = load;
+      }
+    }
+    return best;
   }
 
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
-  SharedGrpcChannelPtr channel_;
-  ::grpc::GenericStub stub_;
+  std::vector<std::unique_ptr<ChannelState>> channels_;
   ::grpc::CompletionQueue* cq_;
 
   const ::grpc::string getstatus_;
@@ -225,7 +278,13 @@ class GrpcRemoteWorker : public WorkerInterface {
 WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
                                      ::grpc::CompletionQueue* completion_queue,
                                      WorkerCacheLogger* logger) {
-  return new GrpcRemoteWorker(std::move(channel), completion_queue, logger);
+  return new GrpcRemoteWorker({std::move(channel)}, completion_queue, logger);
+}
+
+WorkerInterface* NewGrpcRemoteWorker(
+    const std::vector<SharedGrpcChannelPtr>& channels,
+    ::grpc::CompletionQueue* completion_queue, WorkerCacheLogger* logger) {
+  return new GrpcRemoteWorker(channels, completion_queue, logger);
 }
 
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_DISTRIBUTED_RUNTIME_RPC_GRPC_REMOTE_WORKER_H_
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
@@ -33,6 +34,14 @@ WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
                                      ::grpc::CompletionQueue* completion_queue,
                                      WorkerCacheLogger* logger);
 
+// Returns a WorkerInterface that issues its requests over a pool of
+// `channels` to the same worker. Requests that may carry large tensors
+// (RunGraph and RecvTensor) are sent on the least-loaded channel; all
+// other requests use `channels[0]`. `channels` must not be empty.
+WorkerInterface* NewGrpcRemoteWorker(
+    const std::vector<SharedGrpcChannelPtr>& channels,
+    ::grpc::CompletionQueue* completion_queue, WorkerCacheLogger* logger);
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_DISTRIBUTED_RUNTIME_RPC_GRPC_REMOTE_WORKER_H_
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
 
+#include <algorithm>
 #include <cstring>
 #include <limits>
 #include <memory>
@@ -286,8 +287,8 @@ Status GrpcServer::WorkerCacheFactory(const WorkerCacheFactoryOptions& options,
   GrpcChannelSpec channel_spec;
   TF_RETURN_IF_ERROR(ParseChannelSpec(options, &channel_spec));
 
-  std::unique_ptr<GrpcChannelCache> channel_cache(
-      NewGrpcChannelCache(channel_spec, GetChannelCreationFunction()));
+  std::unique_ptr<GrpcChannelCache> channel_cache(NewGrpcChannelCache(
+      channel_spec, GetChannelCreationFunction(), NumChannelsPerTarget()));
 
   string name_prefix = strings::StrCat("/job:", *options.job_name, "/replica:0",
                                        "/task:", options.task_index);
@@ -380,9 +381,18 @@ std::shared_ptr<::grpc::ServerCredentials> GrpcServer::GetServerCredentials(
 ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
   // We can do this because SparseGrpcChannelCache is robust to nullptr being
   // returned by the channel creation function
+  if (NumChannelsPerTarget() > 1) {
+    return ConvertToChannelCreationFunction(NewUnsharedHostPortGrpcChannel);
+  }
   return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
 }
 
+int GrpcServer::NumChannelsPerTarget() const {
+  return std::max(1, server_def_.default_session_config()
+                         .rpc_options()
+                         .num_channels_per_target());
+}
+
 std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
   return std::unique_ptr<Master>(new Master(master_env, 0.0));
 }
@@ -83,6 +83,10 @@ class GrpcServer : public ServerInterface {
 
   virtual ChannelCreationFunction GetChannelCreationFunction() const;
 
+  // Returns the number of channels to open to each remote task, as
+  // configured by `RPCOptions.num_channels_per_target`.
+  int NumChannelsPerTarget() const;
+
   virtual std::unique_ptr<Master> CreateMaster(MasterEnv* master_env);
 
   // Creates a WorkerCacheInterface for a session.
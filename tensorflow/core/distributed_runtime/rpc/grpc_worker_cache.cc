@@ -59,10 +59,11 @@ class GrpcWorkerCache : public WorkerCachePartial {
     if (target == local_target_) {
       return local_worker_;
     } else {
-      SharedGrpcChannelPtr channel = channel_cache_->FindWorkerChannel(target);
-      if (!channel) return nullptr;
+      std::vector<SharedGrpcChannelPtr> channels =
+          channel_cache_->FindWorkerChannelPool(target);
+      if (channels.empty()) return nullptr;
       return NewGrpcRemoteWorker(
-          channel, threads_[AssignWorkerToThread(target)].completion_queue(),
+          channels, threads_[AssignWorkerToThread(target)].completion_queue(),
           &logger_);
     }
   }
@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -25,10 +28,13 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/default_device.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
@@ -39,10 +45,9 @@ limitations under the License.
 namespace tensorflow {
 
 static const int kWorkers = 60;
-static thread::ThreadPool* worker_threads;
 
 void MakeGRPCCluster(const SessionOptions& options, int n,
-                     std::vector<string>* workers,
+                     int num_channels_per_target, std::vector<string>* workers,
                      std::vector<DeviceAttributes>* devices) {
   CHECK_GE(n, 1);
 
@@ -64,9 +69,12 @@ void MakeGRPCCluster(const SessionOptions& options, int n,
     num_gpus = iter->second;
   }
 
-  worker_threads = new thread::ThreadPool(Env::Default(), "worker_threads", n);
+  // The servers run until the process exits, so the pool is never deleted.
+  thread::ThreadPool* worker_threads =
+      new thread::ThreadPool(Env::Default(), "worker_threads", n);
   for (int worker_idx = 0; worker_idx < n; ++worker_idx) {
-    worker_threads->Schedule([worker_idx, n, num_cpus, num_gpus, &port] {
+    worker_threads->Schedule([worker_idx, n, num_cpus, num_gpus,
+                              num_channels_per_target, &port] {
       ServerDef server;
       server.set_protocol("grpc");
       server.set_job_name("localhost");
@@ -82,6 +90,8 @@ void MakeGRPCCluster(const SessionOptions& options, int n,
       auto config = server.mutable_default_session_config();
       (*config->mutable_device_count())["CPU"] = num_cpus;
       (*config->mutable_device_count())["GPU"] = num_gpus;
+      config->mutable_rpc_options()->set_num_channels_per_target(
+          num_channels_per_target);
 
       std::unique_ptr<ServerInterface> svr;
       TF_CHECK_OK(NewServer(server, &svr));
@@ -104,11 +114,13 @@ struct Cluster {
   std::vector<string> workers;
   std::vector<DeviceAttributes> devices;  // One per process
 
-  Cluster() {
+  explicit Cluster(int num_workers = kWorkers,
+                   int num_channels_per_target = 1) {
     (*options.config.mutable_device_count())["CPU"] = 1;
     options.config.set_intra_op_parallelism_threads(1);
     options.config.set_inter_op_parallelism_threads(1);
-    MakeGRPCCluster(options, kWorkers, &workers, &devices);
+    MakeGRPCCluster(options, num_workers, num_channels_per_target, &workers,
+                    &devices);
     LOG(ERROR) << "C " << workers.size() << " " << devices.size() << " "
                << workers[0] << " " << workers[1];
     options.target = workers[0];
@@ -248,4 +260,367 @@ BENCHMARK(BM_SingleDevice)
     ->ArgPair(4, 10000)
     ->ArgPair(1, 1000000);
 
+// Transport benchmarks.
+//
+// The benchmarks below measure the cost of moving tensors between the
+// servers of a small localhost cluster: RecvTensor latency and throughput
+// across tensor sizes and channel pool sizes, fan-in and fan-out, concurrent
+// steps, and dense versus sparse updates of a remote variable.
+//
+// In addition to the usual benchmark output, every configuration records its
+// step latency distribution and throughput, and the collected results are
+// printed as tab-separated "rpcbench_report" lines when the process exits.
+
+static const int kTransportWorkers = 8;
+
+// Returns a cluster of kTransportWorkers servers, each of which opens
+// `num_channels_per_target` channels to every other server.
+static const Cluster* GetTransportCluster(int num_channels_per_target) {
+  static mutex* mu = new mutex;
+  static std::map<int, Cluster*>* clusters = new std::map<int, Cluster*>;
+  mutex_lock l(*mu);
+  Cluster*& cluster = (*clusters)[num_channels_per_target];
+  if (cluster == nullptr) {
+    cluster = new Cluster(kTransportWorkers, num_channels_per_target);
+  }
+  return cluster;
+}
+
+// Collects one row of results per benchmark configuration.
+class TransportReport {
+ public:
+  struct Row {
+    int64 steps = 0;
+    double seconds = 0;
+    int64 bytes_per_step = 0;
+    double mean_us = 0;
+    double p50_us = 0;
+    double p90_us = 0;
+    double p99_us = 0;
+  };
+
+  static TransportReport* Get() {
+    static TransportReport* report = [] {
+      std::atexit([] { TransportReport::Get()->Print(); });
+      return new TransportReport;
+    }();
+    return report;
+  }
+
+  // The benchmark framework runs each configuration several times with an
+  // increasing number of iterations, so the last (longest) run is kept.
+  void Record(const string& name, const Row& row) {
+    mutex_lock l(mu_);
+    rows_[name] = row;
+  }
+
+  void Print() {
+    mutex_lock l(mu_);
+    printf(
+        "rpcbench_report\tbenchmark\tsteps\tsteps_per_sec\tMB_per_sec\t"
+        "mean_us\tp50_us\tp90_us\tp99_us\n");
+    for (const auto& name_row : rows_) {
+      const Row& row = name_row.second;
+      printf("rpcbench_report\t%s\t%lld\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n",
+             name_row.first.c_str(), static_cast<long long>(row.steps),
+             row.steps / row.seconds,
+             row.steps * row.bytes_per_step * 1e-6 / row.seconds, row.mean_us,
+             row.p50_us, row.p90_us, row.p99_us);
+    }
+    fflush(stdout);
+  }
+
+ private:
+  mutex mu_;
+  std::map<string, Row> rows_ GUARDED_BY(mu_);
+};
+
+// Creates a session for `def` on `cluster` and runs its "init" target.
+static std::unique_ptr<Session> CreateTransportSession(const Cluster* cluster,
+                                                       const GraphDef& def) {
+  std::unique_ptr<Session> session(NewSession(cluster->options));
+  TF_CHECK_OK(session->Create(def));
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {}, {"init"}, &outputs));
+  return session;
+}
+
+// Runs `iters` steps of the "sink" target of `session`, split across
+// `num_threads` concurrent client threads, and records the results under
+// `name`. Each step is expected to move `bytes_per_step` bytes.
+static void RunTransportSteps(int iters, const string& name, int num_threads,
+                              int64 bytes_per_step, Session* session) {
+  // Warm up, so that partitioning and connection setup are not measured.
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, {"sink"}, &outputs));
+  }
+
+  mutex mu;
+  histogram::Histogram latency_us;
+  thread::ThreadPool clients(Env::Default(), "rpcbench_clients", num_threads);
+  BlockingCounter counter(num_threads);
+  const uint64 start_us = Env::Default()->NowMicros();
+  testing::StartTiming();
+  for (int t = 0; t < num_threads; ++t) {
+    const int steps = iters / num_threads + (t < iters % num_threads ? 1 : 0);
+    clients.Schedule([session, steps, &mu, &latency_us, &counter]() {
+      std::vector<Tensor> outputs;
+      for (int i = 0; i < steps; ++i) {
+        const uint64 step_start_us = Env::Default()->NowMicros();
+        TF_CHECK_OK(session->Run({}, {}, {"sink"}, &outputs));
+        const uint64 step_end_us = Env::Default()->NowMicros();
+        mutex_lock l(mu);
+        latency_us.Add(step_end_us - step_start_us);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  testing::StopTiming();
+  const uint64 end_us = Env::Default()->NowMicros();
+
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes_per_step);
+  testing::ItemsProcessed(iters);
+
+  TransportReport::Row row;
+  row.steps = iters;
+  row.seconds = std::max<uint64>(end_us - start_us, 1) * 1e-6;
+  row.bytes_per_step = bytes_per_step;
+  row.mean_us = latency_us.Average();
+  row.p50_us = latency_us.Median();
+  row.p90_us = latency_us.Percentile(90);
+  row.p99_us = latency_us.Percentile(99);
+  TransportReport::Get()->Record(name, row);
+}
+
+// Returns the names of `count` distinct devices of `cluster`, starting with
+// the device at index `begin`.
+static std::vector<string> DeviceNames(const Cluster* cluster, int begin,
+                                       int count) {
+  CHECK_LE(begin + count, cluster->devices.size());
+  std::vector<string> names;
+  for (int i = begin; i < begin + count; ++i) {
+    names.push_back(cluster->devices[i].name());
+  }
+  return names;
+}
+
+// Makes a program in which every device in `dst_devices` reads a variable of
+// `num_floats` floats from every device in `src_devices`, so that running
+// the "sink" target performs one RecvTensor per (source, destination) pair.
+static GraphDef CreateTransferGraphDef(const std::vector<string>& src_devices,
+                                       const std::vector<string>& dst_devices,
+                                       int num_floats) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  Scope s = Scope::NewRootScope();
+
+  std::vector<Output> vars;
+  std::vector<Operation> init_ops;
+  for (const string& src_device : src_devices) {
+    Scope src = s.WithDevice(src_device);
+    Output var = Variable(src, PartialTensorShape({num_floats}), DT_FLOAT);
+    Output zeros = Fill(src, Const(src, {num_floats}), 0.0f);
+    init_ops.push_back(Assign(src, var, zeros).operation);
+    vars.push_back(var);
+  }
+  NoOp(s.WithOpName("init").WithControlDependencies(init_ops));
+
+  std::vector<Operation> reads;
+  for (const string& dst_device : dst_devices) {
+    Scope dst = s.WithDevice(dst_device);
+    for (const Output& var : vars) {
+      reads.push_back(Identity(dst, var).operation);
+    }
+  }
+  NoOp(s.WithOpName("sink")
+           .WithDevice(dst_devices[0])
+           .WithControlDependencies(reads));
+
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+static void BM_TransferHelper(int iters, const string& name, int num_sources,
+                              int num_destinations, int num_floats,
+                              int num_channels_per_target, int num_threads) {
+  testing::StopTiming();
+  const Cluster* cluster = GetTransportCluster(num_channels_per_target);
+  // Sources and destinations never share a device, so every read is remote.
+  CHECK_LE(num_sources + num_destinations, cluster->devices.size());
+  GraphDef def = CreateTransferGraphDef(
+      DeviceNames(cluster, 0, num_sources),
+      DeviceNames(cluster, num_sources, num_destinations), num_floats);
+  std::unique_ptr<Session> session = CreateTransportSession(cluster, def);
+
+  const int64 bytes_per_step = static_cast<int64>(num_sources) *
+                               num_destinations * num_floats * sizeof(float);
+  testing::SetLabel(strings::StrCat(num_sources, " src; ", num_destinations,
+                                    " dst; ", num_channels_per_target,
+                                    " channels; ", num_threads,
+                                    " steps in flight; tensor bytes/send: ",
+                                    num_floats * sizeof(float)));
+  RunTransportSteps(iters, name, num_threads, bytes_per_step, session.get());
+  TF_CHECK_OK(session->Close());
+}
+
+// Latency and throughput of a single RecvTensor, by tensor size and by the
+// number of channels that each server opens to its peers.
+static void BM_RecvTensor(int iters, int num_floats,
+                          int num_channels_per_target) {
+  BM_TransferHelper(iters,
+                    strings::StrCat("BM_RecvTensor/", num_floats, "/",
+                                    num_channels_per_target),
+                    1 /*num_sources*/, 1 /*num_destinations*/, num_floats,
+                    num_channels_per_target, 1 /*num_threads*/);
+}
+BENCHMARK(BM_RecvTensor)
+    ->ArgPair(1, 1)
+    ->ArgPair(1024, 1)
+    ->ArgPair(256 << 10, 1)
+    ->ArgPair(4 << 20, 1)
+    ->ArgPair(32 << 20, 1)
+    ->ArgPair(4 << 20, 4)
+    ->ArgPair(32 << 20, 4);
+
+// Several concurrent steps, each of which performs one RecvTensor between
+// the same pair of servers.
+static void BM_ConcurrentSteps(int iters, int num_threads,
+                               int num_channels_per_target) {
+  const int kNumFloats = 4 << 20;
+  BM_TransferHelper(iters,
+                    strings::StrCat("BM_ConcurrentSteps/", num_threads, "/",
+                                    num_channels_per_target),
+                    1 /*num_sources*/, 1 /*num_destinations*/, kNumFloats,
+                    num_channels_per_target, num_threads);
+}
+BENCHMARK(BM_ConcurrentSteps)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1)
+    ->ArgPair(4, 4)
+    ->ArgPair(16, 4);
+
+// One destination reads a tensor from each of `fan_in` sources.
+static void BM_FanIn(int iters, int fan_in, int num_floats) {
+  BM_TransferHelper(iters,
+                    strings::StrCat("BM_FanIn/", fan_in, "/", num_floats),
+                    fan_in, 1 /*num_destinations*/, num_floats,
+                    1 /*num_channels_per_target*/, 1 /*num_threads*/);
+}
+BENCHMARK(BM_FanIn)
+    ->ArgPair(1, 1024)
+    ->ArgPair(4, 1024)
+    ->ArgPair(7, 1024)
+    ->ArgPair(1, 1 << 20)
+    ->ArgPair(4, 1 << 20)
+    ->ArgPair(7, 1 << 20);
+
+// Each of `fan_out` destinations reads the same tensor from one source.
+static void BM_FanOut(int iters, int fan_out, int num_floats) {
+  BM_TransferHelper(iters,
+                    strings::StrCat("BM_FanOut/", fan_out, "/", num_floats),
+                    1 /*num_sources*/, fan_out, num_floats,
+                    1 /*num_channels_per_target*/, 1 /*num_threads*/);
+}
+BENCHMARK(BM_FanOut)
+    ->ArgPair(1, 1024)
+    ->ArgPair(4, 1024)
+    ->ArgPair(7, 1024)
+    ->ArgPair(1, 1 << 20)
+    ->ArgPair(4, 1 << 20)
+    ->ArgPair(7, 1 << 20);
+
+// Number of floats in each row of the variables updated below.
+static const int kRowSize = 64;
+
+// Makes a program in which a worker device updates a [num_rows, kRowSize]
+// variable on a parameter server device. If `num_updated_rows` is zero, the
+// "sink" target applies a dense update of the whole variable with AssignAdd;
+// otherwise it applies a sparse update of `num_updated_rows` evenly spaced
+// rows with ScatterAdd.
+static GraphDef CreateVariableUpdateGraphDef(const string& ps_device,
+                                             const string& worker_device,
+                                             int num_rows,
+                                             int num_updated_rows) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+  Scope s = Scope::NewRootScope();
+  Scope ps = s.WithDevice(ps_device);
+  Scope worker = s.WithDevice(worker_device);
+
+  Output var = Variable(ps, PartialTensorShape({num_rows, kRowSize}), DT_FLOAT);
+  Output zeros = Fill(ps, Const(ps, {num_rows, kRowSize}), 0.0f);
+  NoOp(s.WithOpName("init").WithControlDependencies(
+      Assign(ps, var, zeros).operation));
+
+  Operation update;
+  if (num_updated_rows == 0) {
+    Output delta = Fill(worker, Const(worker, {num_rows, kRowSize}), 1.0f);
+    update = AssignAdd(ps, var, delta).operation;
+  } else {
+    CHECK_LE(num_updated_rows, num_rows);
+    Tensor indices(DT_INT32, TensorShape({num_updated_rows}));
+    for (int i = 0; i < num_updated_rows; ++i) {
+      indices.flat<int32>()(i) =
+          static_cast<int64>(i) * num_rows / num_updated_rows;
+    }
+    Output delta =
+        Fill(worker, Const(worker, {num_updated_rows, kRowSize}), 1.0f);
+    update = ScatterAdd(ps, var, Const(worker, Input::Initializer(indices)),
+                        delta)
+                 .operation;
+  }
+  NoOp(s.WithOpName("sink").WithDevice(ps_device).WithControlDependencies(
+      update));
+
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+static void BM_VariableUpdateHelper(int iters, const string& name,
+                                    int num_rows, int num_updated_rows) {
+  testing::StopTiming();
+  const Cluster* cluster = GetTransportCluster(1);
+  GraphDef def = CreateVariableUpdateGraphDef(cluster->devices[0].name(),
+                                              cluster->devices[1].name(),
+                                              num_rows, num_updated_rows);
+  std::unique_ptr<Session> session = CreateTransportSession(cluster, def);
+
+  const int64 rows_per_step =
+      num_updated_rows == 0 ? num_rows : num_updated_rows;
+  int64 bytes_per_step = rows_per_step * kRowSize * sizeof(float);
+  if (num_updated_rows > 0) bytes_per_step += rows_per_step * sizeof(int32);
+  testing::SetLabel(strings::StrCat(
+      num_updated_rows == 0 ? "Dense" : "Sparse", " update of ",
+      rows_per_step, " of ", num_rows, " rows"));
+  RunTransportSteps(iters, name, 1 /*num_threads*/, bytes_per_step,
+                    session.get());
+  TF_CHECK_OK(session->Close());
+}
+
+static void BM_DenseVariableUpdate(int iters, int num_rows) {
+  BM_VariableUpdateHelper(
+      iters, strings::StrCat("BM_DenseVariableUpdate/", num_rows), num_rows,
+      0 /*num_updated_rows*/);
+}
+BENCHMARK(BM_DenseVariableUpdate)->Arg(1024)->Arg(16384)->Arg(262144);
+
+static void BM_SparseVariableUpdate(int iters, int num_rows,
+                                    int num_updated_rows) {
+  BM_VariableUpdateHelper(iters,
+                          strings::StrCat("BM_SparseVariableUpdate/", num_rows,
+                                          "/", num_updated_rows),
+                          num_rows, num_updated_rows);
+}
+BENCHMARK(BM_SparseVariableUpdate)
+    ->ArgPair(16384, 16)
+    ->ArgPair(16384, 1024)
+    ->ArgPair(262144, 16)
+    ->ArgPair(262144, 1024)
+    ->ArgPair(262144, 16384);
+
 }  // namespace tensorflow
@@ -490,8 +490,10 @@ class Tensor {
   friend Status batch_util::CopyElementToSlice(
       Tensor element, Tensor* parent,
       int64 index);                // For access to RefCountIsOne().
-  friend class NumpyTensorBuffer;  // For access to the private constructor
-                                   // taking the buffer.
+  friend class NumpyTensorBuffer;   // For access to the private constructor
+                                    // taking the buffer.
+  friend class MappedTensorBuffer;  // For access to the private constructor
+                                    // taking the buffer.
 
   // Creates a tensor with the input datatype, shape and buf.
   //
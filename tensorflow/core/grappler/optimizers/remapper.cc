@@ -0,0 +1,291 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// A Conv2D or MatMul together with the chain of nodes to fold into it.
+struct Fusion {
+  const NodeDef* contraction = nullptr;
+  // Exactly one of bias_add and batch_norm is set.
+  const NodeDef* bias_add = nullptr;
+  const NodeDef* batch_norm = nullptr;
+  const NodeDef* activation = nullptr;
+
+  const NodeDef* last() const {
+    if (activation) return activation;
+    return bias_add ? bias_add : batch_norm;
+  }
+};
+
+bool HasDataType(const NodeDef& node, const string& attr, DataType type) {
+  auto it = node.attr().find(attr);
+  return it != node.attr().end() && it->second.type() == type;
+}
+
+bool HasStringAttr(const NodeDef& node, const string& attr,
+                   const string& default_value, const string& value) {
+  auto it = node.attr().find(attr);
+  const string& actual =
+      it == node.attr().end() ? default_value : it->second.s();
+  return actual == value;
+}
+
+class FusionFinder {
+ public:
+  FusionFinder(const GraphDef& graph, const GrapplerItem& item,
+               bool default_is_cpu)
+      : nodes_to_preserve_(item.NodesToPreserve()),
+        default_is_cpu_(default_is_cpu) {
+    for (const NodeDef& node : graph.node()) {
+      for (const string& input : node.input()) {
+        const string input_name = NodeName(input);
+        ++num_references_[input_name];
+        consumers_[input_name].push_back(&node);
+        if (!IsControlInput(input) && NodePosition(input) != 0) {
+          reads_secondary_output_.insert(input_name);
+        }
+      }
+    }
+  }
+
+  // Returns true and fills 'fusion' if 'node' is the root of a fusable chain.
+  bool Find(const NodeDef& node, Fusion* fusion) const {
+    if (!IsCandidateContraction(node)) return false;
+    *fusion = Fusion();
+    fusion->contraction = &node;
+
+    const NodeDef* consumer = SoleConsumer(node);
+    if (consumer == nullptr || !IsOnCpu(*consumer)) return false;
+    if (IsBiasAdd(*consumer) &&
+        HasStringAttr(*consumer, "data_format", "NHWC", "NHWC") &&
+        IsDataInput(*consumer, 0, node)) {
+      fusion->bias_add = consumer;
+    } else if (IsConv2D(node) && IsInferenceBatchNorm(*consumer) &&
+               IsDataInput(*consumer, 0, node)) {
+      fusion->batch_norm = consumer;
+    } else {
+      return false;
+    }
+
+    const NodeDef* activation = SoleConsumer(*consumer);
+    if (activation != nullptr &&
+        (IsRelu(*activation) || IsRelu6(*activation)) &&
+        IsOnCpu(*activation) && IsDataInput(*activation, 0, *consumer)) {
+      fusion->activation = activation;
+    }
+
+    // The fused node takes over the name of the last node of the chain, but
+    // only reproduces its first output.
+    if (fusion->last() == fusion->batch_norm &&
+        (nodes_to_preserve_.count(consumer->name()) > 0 ||
+         reads_secondary_output_.count(consumer->name()) > 0)) {
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  bool IsCandidateContraction(const NodeDef& node) const {
+    if (!IsOnCpu(node)) return false;
+    if (IsConv2D(node)) {
+      return HasDataType(node, "T", DT_FLOAT) &&
+             HasStringAttr(node, "data_format", "NHWC", "NHWC");
+    }
+    // IsMatMul() also matches BatchMatMul, which has no fused kernel.
+    if (node.op() == "MatMul") {
+      return HasDataType(node, "T", DT_FLOAT) ||
+             HasDataType(node, "T", DT_DOUBLE);
+    }
+    return false;
+  }
+
+  bool IsInferenceBatchNorm(const NodeDef& node) const {
+    if (!IsFusedBatchNorm(node) || !HasDataType(node, "T", DT_FLOAT)) {
+      return false;
+    }
+    // FusedBatchNormV2 has a separate type for its statistics.
+    if (node.attr().count("U") > 0 && !HasDataType(node, "U", DT_FLOAT)) {
+      return false;
+    }
+    auto is_training = node.attr().find("is_training");
+    return is_training != node.attr().end() && !is_training->second.b() &&
+           HasStringAttr(node, "data_format", "NHWC", "NHWC");
+  }
+
+  // Returns the only consumer of 'node', provided that it reads output 0 of
+  // 'node' exactly once and 'node' can be removed from the graph.
+  const NodeDef* SoleConsumer(const NodeDef& node) const {
+    auto it = num_references_.find(node.name());
+    if (it == num_references_.end() || it->second != 1 ||
+        nodes_to_preserve_.count(node.name()) > 0 ||
+        reads_secondary_output_.count(node.name()) > 0) {
+      return nullptr;
+    }
+    return consumers_.at(node.name())[0];
+  }
+
+  static bool IsDataInput(const NodeDef& node, int index,
+                          const NodeDef& input) {
+    if (index >= node.input_size()) return false;
+    const string& name = node.input(index);
+    return !IsControlInput(name) && NodeName(name) == input.name() &&
+           NodePosition(name) == 0;
+  }
+
+  bool IsOnCpu(const NodeDef& node) const {
+    if (node.device().empty()) return default_is_cpu_;
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+        !DeviceNameUtils::ParseLocalName(node.device(), &parsed)) {
+      return false;
+    }
+    if (!parsed.has_type) return default_is_cpu_;
+    return str_util::Lowercase(parsed.type) == "cpu";
+  }
+
+  const std::unordered_set<string> nodes_to_preserve_;
+  const bool default_is_cpu_;
+  std::unordered_map<string, int> num_references_;
+  std::unordered_map<string, std::vector<const NodeDef*>> consumers_;
+  std::unordered_set<string> reads_secondary_output_;
+};
+
+// Builds the _FusedConv2D or _FusedMatMul node that replaces 'fusion'.
+NodeDef MakeFusedNode(const Fusion& fusion) {
+  const NodeDef& contraction = *fusion.contraction;
+  NodeDef fused;
+  fused.set_name(fusion.last()->name());
+  fused.set_op(IsConv2D(contraction) ? "_FusedConv2D" : "_FusedMatMul");
+  fused.set_device(contraction.device());
+  *fused.mutable_attr() = contraction.attr();
+
+  fused.add_input(contraction.input(0));
+  fused.add_input(contraction.input(1));
+  std::vector<string> fused_ops;
+  float epsilon = 0;
+  if (fusion.bias_add) {
+    fused_ops.push_back("BiasAdd");
+    fused.add_input(fusion.bias_add->input(1));
+  } else {
+    fused_ops.push_back("FusedBatchNorm");
+    for (int i = 1; i <= 4; ++i) {
+      fused.add_input(fusion.batch_norm->input(i));
+    }
+    auto it = fusion.batch_norm->attr().find("epsilon");
+    epsilon = it == fusion.batch_norm->attr().end() ? 0.0001f : it->second.f();
+  }
+  if (fusion.activation) {
+    fused_ops.push_back(fusion.activation->op());
+  }
+  const int num_args = fused.input_size() - 2;
+
+  // Keep the control dependencies of every node in the chain.
+  std::set<string> control_inputs;
+  for (const NodeDef* node : {fusion.contraction, fusion.bias_add,
+                              fusion.batch_norm, fusion.activation}) {
+    if (node == nullptr) continue;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) control_inputs.insert(input);
+    }
+  }
+  for (const string& input : control_inputs) {
+    fused.add_input(input);
+  }
+
+  auto* attr = fused.mutable_attr();
+  SetAttrValue(num_args, &(*attr)["num_args"]);
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+  SetAttrValue(epsilon, &(*attr)["epsilon"]);
+  return fused;
+}
+
+}  // namespace
+
+Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
+                          GraphDef* optimized_graph) {
+  // Nodes without a device are rewritten only when they cannot end up on a
+  // GPU, since the fused kernels are CPU only.
+  bool default_is_cpu = cluster != nullptr;
+  if (cluster != nullptr) {
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "GPU") default_is_cpu = false;
+    }
+  }
+  FusionFinder finder(item.graph, item, default_is_cpu);
+
+  // Find the fusions first, keyed by the node that the fused node replaces.
+  std::unordered_map<const NodeDef*, NodeDef> replacements;
+  std::unordered_set<const NodeDef*> removed;
+  for (const NodeDef& node : item.graph.node()) {
+    Fusion fusion;
+    if (!finder.Find(node, &fusion)) continue;
+    NodeDef fused = MakeFusedNode(fusion);
+    // Don't produce nodes that the CPU can't run, e.g. in builds that
+    // implement Conv2D with a different kernel.
+    if (!FindKernelDef(DeviceType(DEVICE_CPU), fused, nullptr, nullptr).ok()) {
+      continue;
+    }
+    VLOG(2) << "Fusing " << fusion.contraction->name() << " into "
+            << fused.name();
+    for (const NodeDef* node : {fusion.contraction, fusion.bias_add,
+                                fusion.batch_norm, fusion.activation}) {
+      if (node != nullptr) removed.insert(node);
+    }
+    replacements[fusion.last()] = std::move(fused);
+  }
+
+  optimized_graph->Clear();
+  *optimized_graph->mutable_library() = item.graph.library();
+  *optimized_graph->mutable_versions() = item.graph.versions();
+  for (const NodeDef& node : item.graph.node()) {
+    auto it = replacements.find(&node);
+    if (it != replacements.end()) {
+      *optimized_graph->add_node() = std::move(it->second);
+    } else if (removed.count(&node) == 0) {
+      *optimized_graph->add_node() = node;
+    }
+  }
+  return Status::OK();
+}
+
+void Remapper::Feedback(Cluster* /*cluster*/, const GrapplerItem& /*item*/,
+                        const GraphDef& /*optimized_graph*/,
+                        double /*result*/) {
+  // Nothing to do for Remapper.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
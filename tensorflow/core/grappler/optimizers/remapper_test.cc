@@ -0,0 +1,255 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class RemapperTest : public ::testing::Test {
+ protected:
+  std::vector<Tensor> EvaluateNodes(const GraphDef& graph,
+                                    const std::vector<string>& fetch) {
+    SessionOptions options;
+    // Evaluate the graph as given.
+    options.config.mutable_graph_options()
+        ->mutable_rewrite_options()
+        ->set_remapping(RewriterConfig::OFF);
+    std::unique_ptr<tensorflow::Session> session(NewSession(options));
+    TF_CHECK_OK(session->Create(graph));
+    RunOptions run_options;
+    std::vector<Tensor> output_tensors;
+    TF_CHECK_OK(
+        session->Run(run_options, {}, fetch, fetch, &output_tensors, nullptr));
+    TF_CHECK_OK(session->Close());
+    return output_tensors;
+  }
+
+  Output RandomConst(const Scope& s, const TensorShape& shape) {
+    Tensor t(DT_FLOAT, shape);
+    t.flat<float>().setRandom();
+    return ops::Const(s, Input::Initializer(t));
+  }
+
+  // Checks that 'fetch' computes the same values in both graphs.
+  void ExpectSameResults(const GraphDef& original, const GraphDef& optimized,
+                         const string& fetch) {
+    auto tensors_expected = EvaluateNodes(original, {fetch});
+    auto tensors = EvaluateNodes(optimized, {fetch});
+    ASSERT_EQ(1, tensors_expected.size());
+    ASSERT_EQ(1, tensors.size());
+    test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-4);
+  }
+};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) return &node;
+  }
+  return nullptr;
+}
+
+TEST_F(RemapperTest, FuseConv2DWithBiasAndRelu) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output input = RandomConst(s.WithOpName("input"), {2, 8, 8, 3});
+  Output filter = RandomConst(s.WithOpName("filter"), {3, 3, 3, 4});
+  Output bias = RandomConst(s.WithOpName("bias"), {4});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+
+  GrapplerItem item;
+  item.fetch.push_back("relu");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(4, output.node_size());
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  EXPECT_EQ(nullptr, FindNode(output, "bias_add"));
+  const NodeDef* fused = FindNode(output, "relu");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedConv2D", fused->op());
+  ASSERT_EQ(3, fused->input_size());
+  EXPECT_EQ("input", fused->input(0));
+  EXPECT_EQ("filter", fused->input(1));
+  EXPECT_EQ("bias", fused->input(2));
+  EXPECT_EQ(1, fused->attr().at("num_args").i());
+  const auto& fused_ops = fused->attr().at("fused_ops").list();
+  ASSERT_EQ(2, fused_ops.s_size());
+  EXPECT_EQ("BiasAdd", fused_ops.s(0));
+  EXPECT_EQ("Relu", fused_ops.s(1));
+
+  ExpectSameResults(item.graph, output, "relu");
+}
+
+TEST_F(RemapperTest, FuseConv2DWithBatchNorm) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output input = RandomConst(s.WithOpName("input"), {2, 8, 8, 3});
+  Output filter = RandomConst(s.WithOpName("filter"), {1, 1, 3, 4});
+  Output scale = RandomConst(s.WithOpName("scale"), {4});
+  Output offset = RandomConst(s.WithOpName("offset"), {4});
+  Output mean = RandomConst(s.WithOpName("mean"), {4});
+  // Keep the variance positive.
+  Output variance = ops::Square(s.WithOpName("variance"),
+                                RandomConst(s.WithOpName("stddev"), {4}));
+  Output conv = ops::Conv2D(s.WithOpName("conv"), input, filter, {1, 1, 1, 1},
+                            "VALID");
+  auto bn = ops::FusedBatchNorm(s.WithOpName("bn"), conv, scale, offset, mean,
+                                variance,
+                                ops::FusedBatchNorm::IsTraining(false));
+  Output relu6 = ops::Relu6(s.WithOpName("relu6"), bn.y);
+
+  GrapplerItem item;
+  item.fetch.push_back("relu6");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  EXPECT_EQ(nullptr, FindNode(output, "bn"));
+  const NodeDef* fused = FindNode(output, "relu6");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedConv2D", fused->op());
+  ASSERT_EQ(6, fused->input_size());
+  EXPECT_EQ("scale", fused->input(2));
+  EXPECT_EQ("variance", fused->input(5));
+  const auto& fused_ops = fused->attr().at("fused_ops").list();
+  ASSERT_EQ(2, fused_ops.s_size());
+  EXPECT_EQ("FusedBatchNorm", fused_ops.s(0));
+  EXPECT_EQ("Relu6", fused_ops.s(1));
+
+  ExpectSameResults(item.graph, output, "relu6");
+}
+
+TEST_F(RemapperTest, FuseMatMulWithBias) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output a = RandomConst(s.WithOpName("a"), {8, 16});
+  Output b = RandomConst(s.WithOpName("b"), {32, 16});
+  Output bias = RandomConst(s.WithOpName("bias"), {32});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), a, b,
+                              ops::MatMul::TransposeB(true));
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  Output id = ops::Identity(s.WithOpName("id"), bias_add);
+
+  GrapplerItem item;
+  item.fetch.push_back("id");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "matmul"));
+  const NodeDef* fused = FindNode(output, "bias_add");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedMatMul", fused->op());
+  EXPECT_TRUE(fused->attr().at("transpose_b").b());
+  const auto& fused_ops = fused->attr().at("fused_ops").list();
+  ASSERT_EQ(1, fused_ops.s_size());
+  EXPECT_EQ("BiasAdd", fused_ops.s(0));
+
+  ExpectSameResults(item.graph, output, "id");
+}
+
+TEST_F(RemapperTest, SkipBatchMatMul) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output a = RandomConst(s.WithOpName("a"), {2, 8, 16});
+  Output b = RandomConst(s.WithOpName("b"), {2, 16, 32});
+  Output bias = RandomConst(s.WithOpName("bias"), {32});
+  Output matmul = ops::BatchMatMul(s.WithOpName("matmul"), a, b);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+
+  GrapplerItem item;
+  item.fetch.push_back("bias_add");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  EXPECT_EQ("BatchMatMul", FindNode(output, "matmul")->op());
+  EXPECT_EQ("BiasAdd", FindNode(output, "bias_add")->op());
+}
+
+TEST_F(RemapperTest, KeepIntermediatesWithOtherUses) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output a = RandomConst(s.WithOpName("a"), {8, 16});
+  Output b = RandomConst(s.WithOpName("b"), {16, 32});
+  Output bias = RandomConst(s.WithOpName("bias"), {32});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), a, b);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  Output id = ops::Identity(s.WithOpName("id"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"relu", "id"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The MatMul output is also read by "id", so nothing can be fused.
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(FindNode(item.graph, node.name())->op(), node.op());
+  }
+}
+
+TEST_F(RemapperTest, SkipUnplacedNodesWithoutCluster) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = RandomConst(s.WithOpName("a"), {8, 16});
+  Output b = RandomConst(s.WithOpName("b"), {16, 32});
+  Output bias = RandomConst(s.WithOpName("bias"), {32});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), a, b);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+
+  GrapplerItem item;
+  item.fetch.push_back("bias_add");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Without a cluster the nodes might still be placed on a GPU.
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  EXPECT_EQ("BiasAdd", FindNode(output, "bias_add")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
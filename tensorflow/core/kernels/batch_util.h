@@ -32,6 +32,17 @@ Status CopyElementToSlice(Tensor element, Tensor* parent, int64 index);
 // Copies the index^th slice of parent (in the 0th dimension) into element.
 Status CopySliceToElement(const Tensor& parent, Tensor* element, int64 index);
 
+// Sets every element of `element` to the scalar `padding`, which must have the
+// same dtype.
+Status SetElementZero(Tensor* element, const Tensor& padding);
+
+// Copies `element` into the `index`th slice of `parent` (in the 0th dimension).
+// `parent` must have rank `element.dims() + 1`, and each of its remaining
+// dimensions must be at least as large as the corresponding dimension of
+// `element`; the rest of the slice is left unchanged.
+Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
+                                int index);
+
 }  // namespace batch_util
 }  // namespace tensorflow
 
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/conv_2d.h"
 #include "tensorflow/core/kernels/deep_conv2d.h"
+#include "tensorflow/core/kernels/fused_output_stage.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #ifdef TENSORFLOW_USE_LIBXSMM
 #include "tensorflow/core/kernels/xsmm_conv2d.h"
@@ -259,9 +260,9 @@ class LaunchXsmmConvOp<CPUDevice, float> {
 #endif
 
 template <typename Device, typename T>
-class Conv2DOp : public BinaryOp<T> {
+class Conv2DOp : public OpKernel {
  public:
-  explicit Conv2DOp(OpKernelConstruction* context) : BinaryOp<T>(context) {
+  explicit Conv2DOp(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dilations", &dilations_));
     OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
     string data_format;
@@ -453,6 +454,39 @@ TF_CALL_half(REGISTER_CPU);
 TF_CALL_float(REGISTER_CPU);
 #endif  // USE_GEMM_FOR_CONV
 
+#if !defined(USE_GEMM_FOR_CONV)
+// Conv2D followed by the bias or batch norm and activation that the grappler
+// remapper folded into it. Only NHWC is supported, so that the output
+// channels are the innermost dimension the output stage works on.
+template <typename T>
+class FusedConv2DOp : public Conv2DOp<CPUDevice, T> {
+ public:
+  explicit FusedConv2DOp(OpKernelConstruction* context)
+      : Conv2DOp<CPUDevice, T>(context) {
+    string data_format;
+    OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
+    OP_REQUIRES(context, data_format == "NHWC",
+                errors::Unimplemented("_FusedConv2D only supports NHWC"));
+    OP_REQUIRES_OK(context, output_stage_.Init(context));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    Conv2DOp<CPUDevice, T>::Compute(context);
+    if (!context->status().ok()) return;
+    output_stage_.Apply<T>(context, 2, context->mutable_output(0));
+  }
+
+ private:
+  FusedOutputStage output_stage_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConv2DOp);
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("_FusedConv2D").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    FusedConv2DOp<float>);
+#endif  // USE_GEMM_FOR_CONV
+
 // To be used inside depthwise_conv_op.cc.
 template class LaunchConv2DOp<CPUDevice, float>;
 
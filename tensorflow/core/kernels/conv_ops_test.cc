@@ -22,8 +22,11 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
@@ -464,4 +467,154 @@ TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+class FusedConv2DOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const std::vector<string>& fused_ops, int num_args,
+              float epsilon) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_conv_op", "_FusedConv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(num_args, DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("num_args", num_args)
+                     .Attr("strides", {1, 1, 1, 1})
+                     .Attr("padding", "SAME")
+                     .Attr("fused_ops", fused_ops)
+                     .Attr("epsilon", epsilon)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Adds the image and filter of ConvOpTest::HandwrittenConv, whose plain
+  // convolution is
+  // |  105  |  150  |  183  |   95  |
+  // |  235  |  312  |  357  |  178  |
+  // |  187  |  234  |  261  |  121  |
+  void AddImageAndFilter() {
+    AddInputFromArray<float>(TensorShape({1, 3, 4, 1}),
+                             {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    AddInputFromArray<float>(TensorShape({3, 3, 1, 1}),
+                             {1, 4, 7, 2, 5, 8, 3, 6, 9});
+  }
+};
+
+TEST_F(FusedConv2DOpTest, BiasAddRelu) {
+  MakeOp({"BiasAdd", "Relu"}, 1, 0.0001f);
+  AddImageAndFilter();
+  AddInputFromArray<float>(TensorShape({1}), {-150});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({1, 3, 4, 1}));
+  test::FillValues<float>(&expected,
+                          {0, 0, 33, 0, 85, 162, 207, 28, 37, 84, 111, 0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedConv2DOpTest, FusedBatchNormRelu6) {
+  MakeOp({"FusedBatchNorm", "Relu6"}, 4, 1.0f);
+  AddImageAndFilter();
+  AddInputFromArray<float>(TensorShape({1}), {2});    // scale
+  AddInputFromArray<float>(TensorShape({1}), {-1});   // offset
+  AddInputFromArray<float>(TensorShape({1}), {100});  // mean
+  AddInputFromArray<float>(TensorShape({1}), {99});   // variance
+  TF_ASSERT_OK(RunOpKernel());
+
+  // (x - 100) / sqrt(99 + 1) * 2 - 1, clipped to [0, 6].
+  Tensor expected(DT_FLOAT, TensorShape({1, 3, 4, 1}));
+  test::FillValues<float>(&expected,
+                          {0, 6, 6, 0, 6, 6, 6, 6, 6, 6, 6, 3.2});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedConv2DOpTest, InvalidArgs) {
+  MakeOp({"BiasAdd"}, 1, 0.0001f);
+  AddImageAndFilter();
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("must be a vector of 1"))
+      << s;
+}
+
+TEST_F(FusedConv2DOpTest, UnsupportedFusion) {
+  TF_ASSERT_OK(NodeDefBuilder("fused_conv_op", "_FusedConv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Attr("num_args", 1)
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "SAME")
+                   .Attr("fused_ops", {"Relu"})
+                   .Finalize(node_def()));
+  EXPECT_TRUE(errors::IsUnimplemented(InitOp()));
+}
+
+// Conv2D + BiasAdd + Relu, either as three nodes or as one _FusedConv2D.
+static Graph* ConvBiasRelu(int batch, int rows, int cols, int in_depth,
+                           int filter_size, int out_depth, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({batch, rows, cols, in_depth}));
+  input.flat<float>().setRandom();
+  Tensor filter(DT_FLOAT,
+                TensorShape({filter_size, filter_size, in_depth, out_depth}));
+  filter.flat<float>().setRandom();
+  Tensor bias(DT_FLOAT, TensorShape({out_depth}));
+  bias.flat<float>().setRandom();
+  Node* input_node = test::graph::Constant(g, input);
+  Node* filter_node = test::graph::Constant(g, filter);
+  Node* bias_node = test::graph::Constant(g, bias);
+  Node* node;
+  if (fused) {
+    std::vector<NodeBuilder::NodeOut> args = {bias_node};
+    TF_CHECK_OK(NodeBuilder(g->NewName("fused"), "_FusedConv2D")
+                    .Input(input_node)
+                    .Input(filter_node)
+                    .Input(args)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("num_args", 1)
+                    .Attr("strides", {1, 1, 1, 1})
+                    .Attr("padding", "SAME")
+                    .Attr("fused_ops", {"BiasAdd", "Relu"})
+                    .Finalize(g, &node));
+    return g;
+  }
+  Node* conv;
+  TF_CHECK_OK(NodeBuilder(g->NewName("conv"), "Conv2D")
+                  .Input(input_node)
+                  .Input(filter_node)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, &conv));
+  Node* bias_add;
+  TF_CHECK_OK(NodeBuilder(g->NewName("bias_add"), "BiasAdd")
+                  .Input(conv)
+                  .Input(bias_node)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &bias_add));
+  TF_CHECK_OK(NodeBuilder(g->NewName("relu"), "Relu")
+                  .Input(bias_add)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  return g;
+}
+
+#define BM_CONV_BIAS_RELU(N, H, W, C, FS, OD, FUSED)                          \
+  static void BM_ConvBiasRelu_##N##_##H##_##W##_##C##_##FS##_##OD##_##FUSED( \
+      int iters) {                                                           \
+    testing::UseRealTime();                                                  \
+    testing::ItemsProcessed(static_cast<int64>(iters) * N * H * W * C * FS * \
+                            FS * OD * 2);                                    \
+    test::Benchmark("cpu", ConvBiasRelu(N, H, W, C, FS, OD, FUSED))          \
+        .Run(iters);                                                         \
+  }                                                                          \
+  BENCHMARK(BM_ConvBiasRelu_##N##_##H##_##W##_##C##_##FS##_##OD##_##FUSED);
+
+BM_CONV_BIAS_RELU(8, 32, 32, 64, 1, 64, false);
+BM_CONV_BIAS_RELU(8, 32, 32, 64, 1, 64, true);
+BM_CONV_BIAS_RELU(8, 32, 32, 64, 3, 64, false);
+BM_CONV_BIAS_RELU(8, 32, 32, 64, 3, 64, true);
+BM_CONV_BIAS_RELU(1, 112, 112, 32, 3, 64, false);
+BM_CONV_BIAS_RELU(1, 112, 112, 32, 3, 64, true);
+
 }  // namespace tensorflow
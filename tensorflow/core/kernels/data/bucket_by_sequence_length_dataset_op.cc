@@ -0,0 +1,462 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/batch_util.h"
+#include "tensorflow/core/kernels/data/dataset.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class BucketBySequenceLengthDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit BucketBySequenceLengthDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("bucket_boundaries", &bucket_boundaries_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("bucket_batch_sizes", &bucket_batch_sizes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("length_component", &length_component_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("pad_to_bucket_boundary",
+                                     &pad_to_bucket_boundary_));
+    for (size_t i = 1; i < bucket_boundaries_.size(); ++i) {
+      OP_REQUIRES(
+          ctx, bucket_boundaries_[i - 1] < bucket_boundaries_[i],
+          errors::InvalidArgument("`bucket_boundaries` must be sorted in "
+                                  "strictly increasing order."));
+    }
+    OP_REQUIRES(ctx, bucket_boundaries_.empty() || bucket_boundaries_[0] > 0,
+                errors::InvalidArgument(
+                    "`bucket_boundaries` must be greater than zero."));
+    OP_REQUIRES(ctx,
+                bucket_batch_sizes_.size() == bucket_boundaries_.size() + 1,
+                errors::InvalidArgument(
+                    "`bucket_batch_sizes` must have one more element than "
+                    "`bucket_boundaries`, but got ",
+                    bucket_batch_sizes_.size(), " and ",
+                    bucket_boundaries_.size()));
+    for (int64 batch_size : bucket_batch_sizes_) {
+      OP_REQUIRES(ctx, batch_size > 0,
+                  errors::InvalidArgument(
+                      "`bucket_batch_sizes` must be greater than zero."));
+    }
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    const int64 num_components = input->output_shapes().size();
+    OP_REQUIRES(ctx,
+                length_component_ >= 0 && length_component_ < num_components,
+                errors::InvalidArgument(
+                    "`length_component` (", length_component_,
+                    ") must be the index of a component of the input "
+                    "dataset's elements, which have ",
+                    num_components, " components"));
+
+    OpInputList padded_shape_tensors;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padded_shapes", &padded_shape_tensors));
+    OP_REQUIRES(ctx, padded_shape_tensors.size() == num_components,
+                errors::InvalidArgument("Number of padded shapes (",
+                                        padded_shape_tensors.size(),
+                                        ") must match the number of components "
+                                        "in the input dataset's elements (",
+                                        num_components, ")"));
+    std::vector<PartialTensorShape> padded_shapes;
+    padded_shapes.reserve(padded_shape_tensors.size());
+    for (const Tensor& padded_shape_t : padded_shape_tensors) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                  errors::InvalidArgument("All padded shapes must be vectors"));
+      PartialTensorShape padded_shape;
+      OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                              padded_shape_t.vec<int64>().data(),
+                              padded_shape_t.NumElements(), &padded_shape));
+      padded_shapes.push_back(std::move(padded_shape));
+    }
+    OP_REQUIRES(ctx, padded_shapes[length_component_].dims() > 0,
+                errors::InvalidArgument(
+                    "The padded shape of the length component must have rank "
+                    "at least 1."));
+
+    OpInputList padding_values_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padding_values", &padding_values_list));
+    OP_REQUIRES(ctx, padding_values_list.size() == num_components,
+                errors::InvalidArgument(
+                    "Number of padding values (", padding_values_list.size(),
+                    ") must match the number of components in the input "
+                    "dataset's elements (",
+                    num_components, ")"));
+    std::vector<Tensor> padding_values;
+    padding_values.reserve(padding_values_list.size());
+    for (int i = 0; i < padding_values_list.size(); ++i) {
+      const Tensor& padding_value_t = padding_values_list[i];
+      OP_REQUIRES(
+          ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+          errors::InvalidArgument("All padding values must be scalars"));
+      OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                  errors::InvalidArgument(
+                      "Mismatched type between padding value ", i,
+                      " and input dataset's component ", i, ": ",
+                      DataTypeString(padding_value_t.dtype()), " vs. ",
+                      DataTypeString(input->output_dtypes()[i])));
+      padding_values.push_back(tensor::DeepCopy(padding_value_t));
+    }
+
+    *output = new Dataset(ctx, bucket_boundaries_, bucket_batch_sizes_,
+                          length_component_, pad_to_bucket_boundary_,
+                          std::move(padded_shapes), std::move(padding_values),
+                          input);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const std::vector<int64>& bucket_boundaries,
+            const std::vector<int64>& bucket_batch_sizes,
+            int64 length_component, bool pad_to_bucket_boundary,
+            std::vector<PartialTensorShape> padded_shapes,
+            std::vector<Tensor> padding_values, const DatasetBase* input)
+        : GraphDatasetBase(ctx),
+          bucket_boundaries_(bucket_boundaries),
+          bucket_batch_sizes_(bucket_batch_sizes),
+          length_component_(length_component),
+          pad_to_bucket_boundary_(pad_to_bucket_boundary),
+          padded_shapes_(std::move(padded_shapes)),
+          padding_values_(std::move(padding_values)),
+          input_(input) {
+      input_->Ref();
+
+      // Batches from different buckets have different sizes and, in general,
+      // different padded dimensions, so those are unknown statically.
+      output_shapes_.reserve(padded_shapes_.size());
+      for (const PartialTensorShape& padded_shape : padded_shapes_) {
+        output_shapes_.push_back(
+            PartialTensorShape({-1}).Concatenate(padded_shape));
+      }
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(new Iterator(
+          {this, strings::StrCat(prefix, "::BucketBySequenceLength")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return "BucketBySequenceLengthDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+
+      std::vector<Node*> padded_shapes;
+      padded_shapes.reserve(padded_shapes_.size());
+      for (size_t i = 0; i < padded_shapes_.size(); ++i) {
+        Node* node;
+        Tensor t(DT_INT64, TensorShape({padded_shapes_[i].dims()}));
+        for (int j = 0; j < padded_shapes_[i].dims(); j++) {
+          t.vec<int64>()(j) = padded_shapes_[i].dim_size(j);
+        }
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padded_shapes.emplace_back(node);
+      }
+
+      std::vector<Node*> padding_values;
+      padding_values.reserve(padding_values_.size());
+      for (const Tensor& t : padding_values_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padding_values.emplace_back(node);
+      }
+
+      AttrValue bucket_boundaries;
+      b->BuildAttrValue(bucket_boundaries_, &bucket_boundaries);
+      AttrValue bucket_batch_sizes;
+      b->BuildAttrValue(bucket_batch_sizes_, &bucket_batch_sizes);
+      AttrValue length_component;
+      b->BuildAttrValue(length_component_, &length_component);
+      AttrValue pad_to_bucket_boundary;
+      b->BuildAttrValue(pad_to_bucket_boundary_, &pad_to_bucket_boundary);
+      AttrValue output_types;
+      b->BuildAttrValue(output_dtypes(), &output_types);
+      AttrValue N;
+      b->BuildAttrValue<int64>(padded_shapes_.size(), &N);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {{0, input_graph_node}},
+          {{1, padded_shapes}, {2, padding_values}},
+          {{"bucket_boundaries", bucket_boundaries},
+           {"bucket_batch_sizes", bucket_batch_sizes},
+           {"length_component", length_component},
+           {"pad_to_bucket_boundary", pad_to_bucket_boundary},
+           {"Toutput_types", output_types},
+           {"N", N}},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
+            buckets_(params.dataset->bucket_batch_sizes_.size()) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        // The elements of the batch to produce, and the bucket they are in.
+        std::vector<std::vector<Tensor>> batch_elements;
+        size_t bucket = 0;
+        {
+          mutex_lock l(mu_);
+          while (input_impl_ && batch_elements.empty()) {
+            std::vector<Tensor> element;
+            bool end_of_input = false;
+            TF_RETURN_IF_ERROR(
+                input_impl_->GetNext(ctx, &element, &end_of_input));
+            if (end_of_input) {
+              input_impl_.reset();
+              break;
+            }
+            TF_RETURN_IF_ERROR(dataset()->BucketForElement(element, &bucket));
+            buckets_[bucket].push_back(std::move(element));
+            if (static_cast<int64>(buckets_[bucket].size()) ==
+                dataset()->bucket_batch_sizes_[bucket]) {
+              batch_elements.swap(buckets_[bucket]);
+            }
+          }
+          // Once the input is exhausted, flush the partial batches in bucket
+          // order.
+          for (size_t i = 0; i < buckets_.size() && batch_elements.empty() &&
+                             !input_impl_;
+               ++i) {
+            if (!buckets_[i].empty()) {
+              bucket = i;
+              batch_elements.swap(buckets_[i]);
+            }
+          }
+        }
+
+        if (batch_elements.empty()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(
+            dataset()->PadBatch(bucket, batch_elements, out_tensors));
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        if (input_impl_) {
+          TF_RETURN_IF_ERROR(SaveParent(writer, input_impl_));
+        } else {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("exhausted"), ""));
+        }
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+          const std::vector<std::vector<Tensor>>& bucket = buckets_[i];
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat("buckets[", i, "].size")),
+              bucket.size()));
+          for (size_t j = 0; j < bucket.size(); ++j) {
+            for (size_t k = 0; k < bucket[j].size(); ++k) {
+              TF_RETURN_IF_ERROR(writer->WriteTensor(
+                  full_name(strings::StrCat("buckets[", i, "][", j, "][", k,
+                                            "]")),
+                  bucket[j][k]));
+            }
+          }
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        if (reader->Contains(full_name("exhausted"))) {
+          input_impl_.reset();
+        } else {
+          input_impl_ = dataset()->input_->MakeIterator(prefix());
+          TF_RETURN_IF_ERROR(RestoreParent(ctx, reader, input_impl_));
+        }
+        const size_t num_components = dataset()->padded_shapes_.size();
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+          int64 bucket_size;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name(strings::StrCat("buckets[", i, "].size")),
+              &bucket_size));
+          std::vector<std::vector<Tensor>>& bucket = buckets_[i];
+          bucket.clear();
+          bucket.resize(bucket_size);
+          for (size_t j = 0; j < bucket.size(); ++j) {
+            bucket[j].resize(num_components);
+            for (size_t k = 0; k < num_components; ++k) {
+              TF_RETURN_IF_ERROR(reader->ReadTensor(
+                  full_name(strings::StrCat("buckets[", i, "][", j, "][", k,
+                                            "]")),
+                  &bucket[j][k]));
+            }
+          }
+        }
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      // The elements buffered in each bucket, which are fewer than that
+      // bucket's batch size.
+      std::vector<std::vector<std::vector<Tensor>>> buckets_ GUARDED_BY(mu_);
+    };
+
+    // Sets `*bucket` to the index of the bucket that `element` belongs to,
+    // which is the number of boundaries that are less than or equal to its
+    // length.
+    Status BucketForElement(const std::vector<Tensor>& element,
+                            size_t* bucket) const {
+      const Tensor& length_t = element[length_component_];
+      if (length_t.dims() == 0) {
+        return errors::InvalidArgument(
+            "Component ", length_component_,
+            " of each element must have rank at least 1, so that its length "
+            "can be computed, but got an element with shape ",
+            length_t.shape().DebugString());
+      }
+      const int64 length = length_t.dim_size(0);
+      *bucket = std::upper_bound(bucket_boundaries_.begin(),
+                                 bucket_boundaries_.end(), length) -
+                bucket_boundaries_.begin();
+      return Status::OK();
+    }
+
+    // Pads `batch_elements`, which all belong to `bucket`, and copies them
+    // into one output tensor per component.
+    Status PadBatch(size_t bucket,
+                    const std::vector<std::vector<Tensor>>& batch_elements,
+                    std::vector<Tensor>* out_tensors) const {
+      const int64 num_batch_elements = batch_elements.size();
+      // When `pad_to_bucket_boundary_` is set, every dimension of unknown size
+      // is padded to the largest length that the bucket admits. The last
+      // bucket has no upper boundary, so it is always padded to the longest
+      // element in the batch.
+      const int64 bucket_padded_size =
+          pad_to_bucket_boundary_ && bucket < bucket_boundaries_.size()
+              ? bucket_boundaries_[bucket] - 1
+              : -1;
+      out_tensors->reserve(padded_shapes_.size());
+      for (size_t component_index = 0; component_index < padded_shapes_.size();
+           ++component_index) {
+        // 1. Determine the shape of the padded tensor.
+        const PartialTensorShape& padded_shape =
+            padded_shapes_[component_index];
+        TensorShape batch_component_shape({num_batch_elements});
+        for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+          if (padded_shape.dim_size(dim) != -1) {
+            batch_component_shape.AddDim(padded_shape.dim_size(dim));
+          } else if (bucket_padded_size != -1) {
+            batch_component_shape.AddDim(bucket_padded_size);
+          } else {
+            batch_component_shape.AddDim(0);
+          }
+        }
+        for (int64 i = 0; i < num_batch_elements; ++i) {
+          const TensorShape& element_shape =
+              batch_elements[i][component_index].shape();
+          if (element_shape.dims() != padded_shape.dims()) {
+            return errors::InvalidArgument(
+                "All elements in a batch must have the same rank as the "
+                "padded shape for component",
+                component_index, ": expected rank ", padded_shape.dims(),
+                " but got element with rank ", element_shape.dims());
+          }
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            const int64 size = element_shape.dim_size(dim);
+            if (padded_shape.dim_size(dim) == -1 && bucket_padded_size == -1) {
+              // Take the max of all batch elements in this dimension.
+              if (size > batch_component_shape.dim_size(dim + 1)) {
+                batch_component_shape.set_dim(dim + 1, size);
+              }
+            } else if (size > batch_component_shape.dim_size(dim + 1)) {
+              return errors::InvalidArgument(
+                  "Attempted to pad dimension ", dim, " of component ",
+                  component_index, " to size ",
+                  batch_component_shape.dim_size(dim + 1),
+                  ", which is smaller than the element's size ", size);
+            }
+          }
+        }
+
+        // 2. Fill the output with padding, and copy each batch element into
+        // its slice.
+        Tensor batch_component(cpu_allocator(),
+                               output_dtypes()[component_index],
+                               batch_component_shape);
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &batch_component, padding_values_[component_index]));
+        for (int64 i = 0; i < num_batch_elements; ++i) {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+              batch_elements[i][component_index], &batch_component, i));
+        }
+        out_tensors->push_back(std::move(batch_component));
+      }
+      return Status::OK();
+    }
+
+    const std::vector<int64> bucket_boundaries_;
+    const std::vector<int64> bucket_batch_sizes_;
+    const int64 length_component_;
+    const bool pad_to_bucket_boundary_;
+    const std::vector<PartialTensorShape> padded_shapes_;
+    const std::vector<Tensor> padding_values_;
+    const DatasetBase* const input_;
+    std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  std::vector<int64> bucket_boundaries_;
+  std::vector<int64> bucket_batch_sizes_;
+  int64 length_component_;
+  bool pad_to_bucket_boundary_;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
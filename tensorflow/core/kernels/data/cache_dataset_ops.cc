@@ -12,17 +12,82 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 
+// A read-only memory mapping of one data file of a cache, shared by the
+// tensors whose buffers point into it.
+class MappedCacheFile : public core::RefCounted {
+ public:
+  explicit MappedCacheFile(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const char* data() const {
+    return static_cast<const char*>(region_->data());
+  }
+  uint64 length() const { return region_->length(); }
+
+ private:
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+// A tensor buffer backed by a range of a `MappedCacheFile`, which stays
+// mapped for as long as the buffer is alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(MappedCacheFile* file, const char* data, size_t len)
+      : file_(file), data_(data), len_(len) {
+    file_->Ref();
+  }
+
+  ~MappedTensorBuffer() override { file_->Unref(); }
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return len_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(len_));
+    proto->set_allocator_name("mapped_cache_file");
+  }
+  Tensor MakeTensor(DataType dtype, const TensorShape& shape) {
+    CHECK_EQ(len_, shape.num_elements() * DataTypeSize(dtype));
+    return Tensor(dtype, shape, this);
+  }
+
+  // The mapped pages are read-only, so prevent input forwarding from
+  // overwriting this buffer.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  MappedCacheFile* const file_;
+  const char* const data_;
+  const size_t len_;
+};
+
 namespace {
 
+// Tensors of at least this many bytes are aligned in the cache's data files,
+// and are read by mapping the data files when possible.
+constexpr int kMinMappedTensorBytes = Allocator::kAllocatorAlignment;
+
+BundleWriter::Options CacheWriterOptions() {
+  BundleWriter::Options options;
+  options.data_alignment = kMinMappedTensorBytes;
+  return options;
+}
+
 // See documentation in ../ops/dataset_ops.cc for a high-level description of
 // the following op.
 
@@ -107,7 +172,8 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           : DatasetIterator<FileDataset>(params),
             cur_index_(0),
             input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            writer_(params.dataset->env_, params.dataset->filename_),
+            writer_(params.dataset->env_, params.dataset->filename_,
+                    CacheWriterOptions()),
             lockfile_(strings::StrCat(params.dataset->filename_, ".lockfile")),
             lockfile_created_(false),
             iteration_completed_(false) {}
@@ -212,7 +278,18 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
       explicit FileReaderIterator(const Params& params)
           : DatasetIterator<FileDataset>(params),
             cur_index_(0),
-            reader_(dataset()->env_, dataset()->filename_) {}
+            reader_(dataset()->env_, dataset()->filename_) {
+        if (reader_.status().ok()) {
+          Status s = MapDataFiles();
+          if (!s.ok()) {
+            VLOG(1) << "Reading cache " << dataset()->filename_
+                    << " without memory mapping: " << s;
+            UnmapDataFiles();
+          }
+        }
+      }
+
+      ~FileReaderIterator() override { UnmapDataFiles(); }
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
@@ -237,7 +314,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           }
           StringPiece key = reader_.key();
           DCHECK_EQ(key, dataset()->FormatName(cur_index_, i));
-          TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          TF_RETURN_IF_ERROR(ReadCurrentLocked(&(*out_tensors)[i]));
           TF_RETURN_IF_ERROR(reader_.status());
         }
         cur_index_++;
@@ -245,9 +322,78 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
       }
 
      private:
+      // Maps each of the cache's data files into memory. Must be called
+      // while `reader_` is positioned at the header entry.
+      Status MapDataFiles() {
+        mutex_lock l(mu_);
+        BundleHeaderProto header;
+        if (!reader_.Valid() || reader_.key() != kHeaderEntryKey ||
+            !ParseProtoUnlimited(&header, reader_.value().data(),
+                                 reader_.value().size())) {
+          return errors::DataLoss("Unable to read the cache header");
+        }
+        for (int32 i = 0; i < header.num_shards(); ++i) {
+          std::unique_ptr<ReadOnlyMemoryRegion> region;
+          TF_RETURN_IF_ERROR(dataset()->env_->NewReadOnlyMemoryRegionFromFile(
+              DataFilename(dataset()->filename_, i, header.num_shards()),
+              &region));
+          data_files_.push_back(new MappedCacheFile(std::move(region)));
+        }
+        return Status::OK();
+      }
+
+      void UnmapDataFiles() {
+        mutex_lock l(mu_);
+        for (MappedCacheFile* file : data_files_) {
+          file->Unref();
+        }
+        data_files_.clear();
+      }
+
+      // Reads the tensor at the current position of `reader_`. Tensors that
+      // were aligned when the cache was written are returned without copying,
+      // backed by the mapped data file. Their checksums are not verified.
+      Status ReadCurrentLocked(Tensor* val) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (data_files_.empty()) {
+          return reader_.ReadCurrent(val);
+        }
+        BundleEntryProto entry;
+        if (!ParseProtoUnlimited(&entry, reader_.value().data(),
+                                 reader_.value().size())) {
+          return errors::DataLoss("Unable to parse cache entry for ",
+                                  reader_.key());
+        }
+        if (entry.slices_size() > 0 || !DataTypeCanUseMemcpy(entry.dtype()) ||
+            entry.shard_id() < 0 ||
+            static_cast<size_t>(entry.shard_id()) >= data_files_.size() ||
+            !TensorShape::IsValid(entry.shape()) || entry.offset() < 0) {
+          return reader_.ReadCurrent(val);
+        }
+        const TensorShape shape(entry.shape());
+        const uint64 bytes = shape.num_elements() * DataTypeSize(entry.dtype());
+        const uint64 offset = entry.offset();
+        MappedCacheFile* file = data_files_[entry.shard_id()];
+        if (bytes < static_cast<uint64>(kMinMappedTensorBytes) ||
+            static_cast<uint64>(entry.size()) != bytes ||
+            offset + bytes > file->length()) {
+          return reader_.ReadCurrent(val);
+        }
+        const char* data = file->data() + offset;
+        if (reinterpret_cast<uintptr_t>(data) % kMinMappedTensorBytes != 0) {
+          return reader_.ReadCurrent(val);
+        }
+        MappedTensorBuffer* buf = new MappedTensorBuffer(file, data, bytes);
+        *val = buf->MakeTensor(entry.dtype(), shape);
+        buf->Unref();
+        return Status::OK();
+      }
+
       mutex mu_;
       size_t cur_index_ GUARDED_BY(mu_);
       BundleReader reader_ GUARDED_BY(mu_);
+      // The cache's data files, indexed by shard ID, if they could be mapped
+      // into memory. Each holds a reference.
+      std::vector<MappedCacheFile*> data_files_ GUARDED_BY(mu_);
     };  // FileReaderIterator
 
     const DatasetBase* const input_;
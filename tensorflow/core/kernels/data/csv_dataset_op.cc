@@ -0,0 +1,435 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/util/csv_parser.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+// The number of bytes read from a file at a time if `buffer_size` is 0.
+constexpr int64 kDefaultBufferSize = 256 << 10;
+
+class CsvDatasetOp : public DatasetOpKernel {
+ public:
+  explicit CsvDatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    for (const PartialTensorShape& pts : output_shapes_) {
+      OP_REQUIRES(ctx, pts.dims() == 0,
+                  errors::InvalidArgument(
+                      "Each element of `output_shapes` must be a scalar."));
+    }
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(
+        ctx, buffer_size >= 0,
+        errors::InvalidArgument("`buffer_size` must be >= 0 (0 == default)"));
+
+    bool header;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, "header", &header));
+
+    string field_delim;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<string>(ctx, "field_delim", &field_delim));
+    OP_REQUIRES(ctx, field_delim.size() == 1,
+                errors::InvalidArgument("field_delim should be only 1 char"));
+
+    bool use_quote_delim;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<bool>(ctx, "use_quote_delim",
+                                                  &use_quote_delim));
+
+    string na_value;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<string>(ctx, "na_value", &na_value));
+
+    OpInputList record_defaults_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("record_defaults", &record_defaults_list));
+    std::vector<Tensor> record_defaults;
+    record_defaults.reserve(record_defaults_list.size());
+    for (int i = 0; i < record_defaults_list.size(); ++i) {
+      OP_REQUIRES(ctx, record_defaults_list[i].NumElements() < 2,
+                  errors::InvalidArgument(
+                      "There should only be 1 default per field but field ", i,
+                      " has ", record_defaults_list[i].NumElements()));
+      record_defaults.push_back(record_defaults_list[i]);
+    }
+
+    *output = new Dataset(
+        ctx, std::move(filenames),
+        buffer_size == 0 ? kDefaultBufferSize : buffer_size, header,
+        field_delim[0], use_quote_delim, na_value, std::move(record_defaults),
+        output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            int64 buffer_size, bool header, char delim, bool use_quote_delim,
+            const string& na_value, std::vector<Tensor> record_defaults,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          filenames_(std::move(filenames)),
+          buffer_size_(buffer_size),
+          header_(header),
+          delim_(delim),
+          use_quote_delim_(use_quote_delim),
+          na_value_(na_value),
+          record_defaults_(std::move(record_defaults)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Csv")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override { return "CsvDatasetOp::Dataset"; }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      Node* buffer_size = nullptr;
+      Node* header = nullptr;
+      Node* field_delim = nullptr;
+      Node* use_quote_delim = nullptr;
+      Node* na_value = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      TF_RETURN_IF_ERROR(b->AddScalar(header_, &header));
+      TF_RETURN_IF_ERROR(b->AddScalar(string(1, delim_), &field_delim));
+      TF_RETURN_IF_ERROR(b->AddScalar(use_quote_delim_, &use_quote_delim));
+      TF_RETURN_IF_ERROR(b->AddScalar(na_value_, &na_value));
+      std::vector<Node*> record_defaults;
+      record_defaults.reserve(record_defaults_.size());
+      for (const Tensor& t : record_defaults_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        record_defaults.push_back(node);
+      }
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {{0, filenames},
+           {1, buffer_size},
+           {2, header},
+           {3, field_delim},
+           {4, use_quote_delim},
+           {5, na_value}},         // Single tensor inputs.
+          {{6, record_defaults}},  // Tensor list inputs.
+          {},                      // Attrs.
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            parser_(params.dataset->delim_, params.dataset->use_quote_delim_) {
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          // We are currently processing a file, so try to read the next
+          // record.
+          if (file_) {
+            StringPiece record;
+            bool found;
+            TF_RETURN_IF_ERROR(ReadRecordLocked(&record, &found));
+            if (found) {
+              if (record.empty()) {
+                // Skip blank lines.
+                continue;
+              }
+              TF_RETURN_IF_ERROR(ParseRecordLocked(record, out_tensors));
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+            // We have reached the end of the current file, so maybe
+            // move on to next file.
+            file_.reset();
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          TF_RETURN_IF_ERROR(SetupFileLocked(ctx->env(), 0));
+          if (dataset()->header_) {
+            StringPiece header;
+            bool found;
+            TF_RETURN_IF_ERROR(ReadRecordLocked(&header, &found));
+          }
+        } while (true);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+        // `file_` is empty if
+        // 1. GetNext has not been called even once.
+        // 2. All files have been read and iterator has been exhausted.
+        if (file_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("current_pos"),
+                                  static_cast<int64>(buffer_offset_ + pos_)));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        file_.reset();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = size_t(current_file_index);
+        // The key "current_pos" is written only if the iterator was saved
+        // with an open file. The position is past the header, if any.
+        if (reader->Contains(full_name("current_pos"))) {
+          int64 current_pos;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("current_pos"), &current_pos));
+          TF_RETURN_IF_ERROR(SetupFileLocked(ctx->env(), current_pos));
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Opens the file at `current_file_index_`, to be read from `offset`.
+      Status SetupFileLocked(Env* env, uint64 offset)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (current_file_index_ >= dataset()->filenames_.size()) {
+          return errors::InvalidArgument(
+              "current_file_index_:", current_file_index_,
+              " >= filenames_.size():", dataset()->filenames_.size());
+        }
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+            dataset()->filenames_[current_file_index_], &file_));
+        buffer_.clear();
+        pos_ = 0;
+        buffer_offset_ = offset;
+        file_eof_ = false;
+        return Status::OK();
+      }
+
+      // Sets `*record` to the next record of the current file, which stays
+      // valid until the next call. Sets `*found` to false at the end of the
+      // file.
+      Status ReadRecordLocked(StringPiece* record, bool* found)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (true) {
+          size_t length;
+          size_t consumed;
+          if (parser_.FindRecord(StringPiece(buffer_).substr(pos_), file_eof_,
+                                 &length, &consumed)) {
+            *record = StringPiece(buffer_.data() + pos_, length);
+            pos_ += consumed;
+            *found = true;
+            return Status::OK();
+          }
+          if (file_eof_) {
+            *found = false;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(FillBufferLocked());
+        }
+      }
+
+      // Discards the records consumed from `buffer_`, and appends the next
+      // `buffer_size_` bytes of the file to it.
+      Status FillBufferLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        buffer_.erase(0, pos_);
+        buffer_offset_ += pos_;
+        pos_ = 0;
+        const size_t size = buffer_.size();
+        const size_t bytes_to_read = dataset()->buffer_size_;
+        buffer_.resize(size + bytes_to_read);
+        StringPiece data;
+        Status s = file_->Read(buffer_offset_ + size, bytes_to_read, &data,
+                               &buffer_[size]);
+        if (data.data() != &buffer_[size]) {
+          // RandomAccessFile placed the data in some other location.
+          memmove(&buffer_[size], data.data(), data.size());
+        }
+        buffer_.resize(size + data.size());
+        if (errors::IsOutOfRange(s)) {
+          file_eof_ = true;
+          return Status::OK();
+        }
+        return s;
+      }
+
+      // Converts the fields of `record` to one scalar tensor per column.
+      Status ParseRecordLocked(StringPiece record,
+                               std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const uint64 record_offset =
+            buffer_offset_ + (record.data() - buffer_.data());
+        const string& filename = dataset()->filenames_[current_file_index_];
+        Status s = parser_.SplitRecord(record, &fields_);
+        if (!s.ok()) {
+          return errors::InvalidArgument(s.error_message(), " in record at ",
+                                         record_offset, " of ", filename);
+        }
+        const DataTypeVector& types = dataset()->output_types_;
+        if (fields_.size() != types.size()) {
+          return errors::InvalidArgument(
+              "Expect ", types.size(), " fields but have ", fields_.size(),
+              " in record at ", record_offset, " of ", filename);
+        }
+
+        out_tensors->reserve(types.size());
+        for (size_t f = 0; f < types.size(); ++f) {
+          const StringPiece field = fields_[f];
+          const Tensor& record_default = dataset()->record_defaults_[f];
+          if (field.empty() || field == dataset()->na_value_) {
+            // If this field is empty or NA value, check if default is given:
+            // If yes, use default value; Otherwise report error.
+            if (record_default.NumElements() != 1) {
+              return errors::InvalidArgument(
+                  "Field ", f, " is required but missing in record at ",
+                  record_offset, " of ", filename);
+            }
+            out_tensors->emplace_back(cpu_allocator(), types[f],
+                                      TensorShape({}));
+            Tensor* value = &out_tensors->back();
+            switch (types[f]) {
+#define HANDLE_TYPE(T)                                  \
+  case DataTypeToEnum<T>::value:                        \
+    value->scalar<T>()() = record_default.flat<T>()(0); \
+    break;
+              TF_CALL_int32(HANDLE_TYPE);
+              TF_CALL_int64(HANDLE_TYPE);
+              TF_CALL_float(HANDLE_TYPE);
+              TF_CALL_double(HANDLE_TYPE);
+              TF_CALL_string(HANDLE_TYPE);
+#undef HANDLE_TYPE
+              default:
+                return errors::InvalidArgument("csv: data type ", types[f],
+                                               " not supported in field ", f);
+            }
+            continue;
+          }
+
+          out_tensors->emplace_back(cpu_allocator(), types[f], TensorShape({}));
+          Tensor* value = &out_tensors->back();
+          bool parsed = true;
+          switch (types[f]) {
+            case DT_INT32:
+              parsed = ParseCsvNumber(field, &value->scalar<int32>()());
+              break;
+            case DT_INT64:
+              parsed = ParseCsvNumber(field, &value->scalar<int64>()());
+              break;
+            case DT_FLOAT:
+              parsed = ParseCsvNumber(field, &value->scalar<float>()());
+              break;
+            case DT_DOUBLE:
+              parsed = ParseCsvNumber(field, &value->scalar<double>()());
+              break;
+            case DT_STRING:
+              value->scalar<string>()().assign(field.data(), field.size());
+              break;
+            default:
+              return errors::InvalidArgument("csv: data type ", types[f],
+                                             " not supported in field ", f);
+          }
+          if (!parsed) {
+            return errors::InvalidArgument(
+                "Field ", f, " in record at ", record_offset, " of ",
+                filename, " is not a valid ", DataTypeString(types[f]), ": ",
+                field);
+          }
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      CsvParser parser_ GUARDED_BY(mu_);
+      std::vector<StringPiece> fields_ GUARDED_BY(mu_);
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      std::unique_ptr<RandomAccessFile> file_ GUARDED_BY(mu_);
+      // Unconsumed bytes of the current file, starting at `buffer_offset_`.
+      string buffer_ GUARDED_BY(mu_);
+      // The position in `buffer_` of the next record.
+      size_t pos_ GUARDED_BY(mu_) = 0;
+      uint64 buffer_offset_ GUARDED_BY(mu_) = 0;
+      bool file_eof_ GUARDED_BY(mu_) = false;
+    };
+
+    const std::vector<string> filenames_;
+    const int64 buffer_size_;
+    const bool header_;
+    const char delim_;
+    const bool use_quote_delim_;
+    const string na_value_;
+    const std::vector<Tensor> record_defaults_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("CsvDataset").Device(DEVICE_CPU), CsvDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
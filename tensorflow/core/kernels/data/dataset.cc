@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/data/stats_aggregator.h"
 
 namespace tensorflow {
 
@@ -71,6 +72,30 @@ class DatasetVariantWrapper {
 
 }  // namespace
 
+GetNextStatsRecorder::GetNextStatsRecorder(IteratorContext* ctx,
+                                           const string& prefix,
+                                           StatsAggregator* stats_aggregator)
+    : ctx_(ctx),
+      prefix_(prefix),
+      stats_aggregator_(stats_aggregator),
+      parent_(ctx->get_next_recorder_),
+      start_usec_(ctx->env()->NowMicros()) {
+  ctx_->get_next_recorder_ = this;
+}
+
+GetNextStatsRecorder::~GetNextStatsRecorder() {
+  const uint64 end_usec = ctx_->env()->NowMicros();
+  const uint64 latency_usec =
+      end_usec > start_usec_ ? end_usec - start_usec_ : 0;
+  const uint64 self_usec =
+      latency_usec > nested_usec_ ? latency_usec - nested_usec_ : 0;
+  ctx_->get_next_recorder_ = parent_;
+  if (parent_ != nullptr) {
+    parent_->nested_usec_ += latency_usec;
+  }
+  stats_aggregator_->RecordGetNext(prefix_, latency_usec, self_usec);
+}
+
 Status GraphDefBuilderWrapper::AddDataset(
     const GraphDatasetBase* dataset,
     const std::vector<std::pair<size_t, Node*>>& inputs,
@@ -16,6 +16,7 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATA_DATASET_H_
 
 #include <memory>
+#include <mutex>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/variant_encode_decode.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tensorflow/core/lib/gtl/optional.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -223,6 +225,7 @@ class GraphDefBuilderWrapper {
   GraphDefBuilder* b_;
 };
 
+class GetNextStatsRecorder;
 class StatsAggregator;
 
 // A cut-down version of OpKernelContext for running computations in
@@ -264,6 +267,10 @@ class IteratorContext {
 
   explicit IteratorContext(Params params) : params_(std::move(params)) {}
 
+  // A copy does not inherit the active `GetNextStatsRecorder`, because copies
+  // are made to run iterators on other threads (e.g. asynchronous prefetching).
+  IteratorContext(const IteratorContext& other) : params_(other.params_) {}
+
   Env* env() const { return params_.env; }
 
   std::function<void(std::function<void()>)>* runner() {
@@ -283,7 +290,12 @@ class IteratorContext {
   }
 
  private:
+  friend class GetNextStatsRecorder;
+
   Params params_;
+
+  // The innermost `GetNextStatsRecorder` that is active on this context.
+  GetNextStatsRecorder* get_next_recorder_ = nullptr;
 };
 
 // Represents the current position in a range of outputs, where the
@@ -456,6 +468,34 @@ class GraphDatasetBase : public DatasetBase {
   const string op_name_;
 };
 
+// Records the duration of one call to `IteratorBase::GetNext()` in a
+// `StatsAggregator`, from construction to destruction.
+//
+// In addition to the total latency of the call, the recorder measures the
+// "self time" of the call: the latency minus the time spent in calls to
+// `GetNext()` on input iterators that are nested in this call with the same
+// `IteratorContext`. In a chain of synchronous iterators, the self time
+// attributes each microsecond to exactly one iterator. For an asynchronous
+// iterator (e.g. prefetching), the self time of a call is the time that the
+// consumer waited for an element to become available.
+class GetNextStatsRecorder {
+ public:
+  // `ctx`, `prefix` and `stats_aggregator` must outlive this object.
+  GetNextStatsRecorder(IteratorContext* ctx, const string& prefix,
+                       StatsAggregator* stats_aggregator);
+  ~GetNextStatsRecorder();
+
+ private:
+  IteratorContext* const ctx_;
+  const string& prefix_;
+  StatsAggregator* const stats_aggregator_;
+  GetNextStatsRecorder* const parent_;
+  const uint64 start_usec_;
+  uint64 nested_usec_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GetNextStatsRecorder);
+};
+
 // Represents an iterator that is associated with a particular parent dataset.
 template <class DatasetType>
 class DatasetIterator : public IteratorBase {
@@ -491,6 +531,15 @@ class DatasetIterator : public IteratorBase {
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) final {
     port::Tracing::TraceMe activity(params_.prefix);
+    // The aggregator is looked up once per iterator, so that the common case
+    // without one costs a single check per element.
+    std::call_once(stats_aggregator_once_, [this, ctx]() {
+      stats_aggregator_ = ctx->stats_aggregator();
+    });
+    gtl::optional<GetNextStatsRecorder> recorder;
+    if (TF_PREDICT_FALSE(stats_aggregator_ != nullptr)) {
+      recorder.emplace(ctx, params_.prefix, stats_aggregator_.get());
+    }
     Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
     if (TF_PREDICT_FALSE(errors::IsOutOfRange(s) && !*end_of_sequence)) {
       s = errors::Internal(
@@ -520,6 +569,9 @@ class DatasetIterator : public IteratorBase {
 
  private:
   Params params_;
+
+  std::once_flag stats_aggregator_once_;
+  std::shared_ptr<StatsAggregator> stats_aggregator_;
 };
 
 // Encapsulates the work required to plug a DatasetBase into the core TensorFlow
@@ -13,12 +13,15 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <deque>
+
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -36,6 +39,7 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sloppy", &sloppy_));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -71,9 +75,9 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
                                                  std::move(other_arguments),
                                                  &captured_func));
 
-    *output =
-        new Dataset(ctx, input, func_, std::move(captured_func), cycle_length,
-                    block_length, output_types_, output_shapes_);
+    *output = new Dataset(ctx, input, func_, std::move(captured_func),
+                          cycle_length, block_length, sloppy_, output_types_,
+                          output_shapes_);
   }
 
  private:
@@ -82,7 +86,7 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
     Dataset(OpKernelContext* ctx, const DatasetBase* input,
             const NameAttrList& func,
             std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
-            int64 block_length, const DataTypeVector& output_types,
+            int64 block_length, bool sloppy, const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes)
         : GraphDatasetBase(ctx),
           input_(input),
@@ -90,6 +94,7 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
           captured_func_(std::move(captured_func)),
           cycle_length_(cycle_length),
           block_length_(block_length),
+          sloppy_(sloppy),
           output_types_(output_types),
           output_shapes_(output_shapes) {
       input_->Ref();
@@ -99,6 +104,10 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
 
     std::unique_ptr<IteratorBase> MakeIterator(
         const string& prefix) const override {
+      if (sloppy_) {
+        return std::unique_ptr<IteratorBase>(new SloppyIterator(
+            {this, strings::StrCat(prefix, "::Interleave")}));
+      }
       return std::unique_ptr<IteratorBase>(
           new Iterator({this, strings::StrCat(prefix, "::Interleave")}));
     }
@@ -136,12 +145,17 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
       b->BuildAttrValue(func_, &f);
       AttrValue other_arguments_types_attr;
       b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+      AttrValue sloppy_attr;
+      b->BuildAttrValue(sloppy_, &sloppy_attr);
 
       TF_RETURN_IF_ERROR(b->AddDataset(
           this,
           {{0, input_node}, {2, cycle_length_node}, {3, block_length_node}},
           {{1, other_arguments}},
-          {{"f", f}, {"Targuments", other_arguments_types_attr}}, output));
+          {{"f", f},
+           {"Targuments", other_arguments_types_attr},
+           {"sloppy", sloppy_attr}},
+          output));
       return Status::OK();
     }
 
@@ -310,11 +324,195 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
       size_t num_open_ GUARDED_BY(mu_) = 0;
     };
 
+    // The iterator used when `sloppy_` is true.
+    //
+    // Each of the `cycle_length_` positions in the cycle is served by a
+    // thread, which takes the next element of the input, opens an iterator on
+    // the dataset that `captured_func_` maps it to, and buffers up to
+    // `2 * block_length_` of that iterator's elements before moving on to the
+    // next input element. `GetNext()` starts from the position that the
+    // deterministic order would use, but returns an element from any position
+    // that has one ready, so that a slow input only delays its own elements.
+    //
+    // Since the order of the output depends on timing, this iterator does not
+    // support saving and restoring its state.
+    class SloppyIterator : public DatasetIterator<Dataset> {
+     public:
+      explicit SloppyIterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
+            slots_(params.dataset->cycle_length_) {}
+
+      ~SloppyIterator() override {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        // Notify all threads in case they are blocked.
+        for (Slot& slot : slots_) {
+          slot.cond_var.notify_all();
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureThreadsStarted(ctx);
+        while (!cancelled_) {
+          bool all_done = true;
+          for (size_t i = 0; i < slots_.size(); ++i) {
+            const size_t index = (cycle_index_ + i) % slots_.size();
+            Slot& slot = slots_[index];
+            if (slot.outputs.empty()) {
+              all_done &= slot.done;
+              continue;
+            }
+            // Skipping ahead to another position starts a new block there.
+            if (i != 0) {
+              cycle_index_ = index;
+              block_index_ = 0;
+            }
+            if (++block_index_ == dataset()->block_length_) {
+              cycle_index_ = (index + 1) % slots_.size();
+              block_index_ = 0;
+            }
+            *end_of_sequence = false;
+            Status s = slot.outputs.front().status;
+            slot.outputs.front().output.swap(*out_tensors);
+            slot.outputs.pop_front();
+            slot.cond_var.notify_one();
+            return s;
+          }
+          if (all_done) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          cond_var_.wait(l);
+        }
+        return errors::Cancelled(
+            "InterleaveDatasetOp::Dataset::SloppyIterator::GetNext");
+      }
+
+     private:
+      struct OutputElem {
+        Status status;
+        std::vector<Tensor> output;
+
+        explicit OutputElem(const Status& s) : status(s) {}
+      };
+
+      // The state of one position in the cycle. All fields are protected by
+      // `mu_`.
+      struct Slot {
+        // The buffered output elements.
+        std::deque<OutputElem> outputs;
+        // Set when the thread has exhausted the input and will not append any
+        // more elements to `outputs`.
+        bool done = false;
+        // The thread waits on this condition variable when `outputs` is full.
+        condition_variable cond_var;
+      };
+
+      void EnsureThreadsStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (threads_.empty()) {
+          threads_.reserve(slots_.size());
+          for (size_t i = 0; i < slots_.size(); ++i) {
+            threads_.emplace_back(ctx->env()->StartThread(
+                {}, "interleave_thread",
+                std::bind(&SloppyIterator::SlotThread, this,
+                          new IteratorContext(*ctx), i)));
+          }
+        }
+      }
+
+      // Produces the elements of successive input elements into
+      // `slots_[slot_index]` until the input is exhausted.
+      void SlotThread(IteratorContext* ctx_ptr, const size_t slot_index) {
+        // std::function arguments are copy-constructable, so we pass raw
+        // pointers, and then immediately wrap them to ensure correct ownership.
+        std::unique_ptr<IteratorContext> ctx(ctx_ptr);
+        Slot* const slot = &slots_[slot_index];
+        auto cleanup = gtl::MakeCleanup([this, slot] {
+          mutex_lock l(mu_);
+          slot->done = true;
+          cond_var_.notify_one();
+        });
+
+        while (true) {
+          // 1. Take the next input element and open an iterator on it.
+          std::vector<Tensor> args;
+          Status s;
+          {
+            mutex_lock l(input_mu_);
+            if (!input_impl_) return;
+            bool end_of_input = false;
+            s = input_impl_->GetNext(ctx.get(), &args, &end_of_input);
+            if (end_of_input) {
+              input_impl_.reset();
+              return;
+            }
+          }
+          std::unique_ptr<IteratorBase> iterator;
+          if (s.ok()) {
+            s = dataset::MakeIteratorFromInputElement(
+                ctx.get(), args, slot_index, dataset()->captured_func_.get(),
+                prefix(), &iterator);
+          }
+          args.clear();  // Release memory as early as possible.
+          if (!s.ok()) {
+            if (!Append(slot, s, {})) return;
+            continue;
+          }
+
+          // 2. Produce its elements.
+          bool end_of_element = false;
+          while (true) {
+            std::vector<Tensor> output;
+            s = iterator->GetNext(ctx.get(), &output, &end_of_element);
+            if (end_of_element) break;
+            if (!Append(slot, s, std::move(output))) return;
+          }
+        }
+      }
+
+      // Waits for space in `slot->outputs` and appends an element to it.
+      // Returns false if the iterator has been cancelled.
+      bool Append(Slot* slot, const Status& s, std::vector<Tensor> output) {
+        mutex_lock l(mu_);
+        const size_t buffer_size = 2 * dataset()->block_length_;
+        while (!cancelled_ && slot->outputs.size() >= buffer_size) {
+          slot->cond_var.wait(l);
+        }
+        if (cancelled_) return false;
+        slot->outputs.emplace_back(s);
+        slot->outputs.back().output.swap(output);
+        cond_var_.notify_one();
+        return true;
+      }
+
+      // Serializes calls to `input_impl_->GetNext()` from the slot threads.
+      mutex input_mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(input_mu_);
+
+      mutex mu_;
+      // The consumer waits on this condition variable when no slot has an
+      // element ready.
+      condition_variable cond_var_;
+      std::vector<Slot> slots_ GUARDED_BY(mu_);
+      size_t cycle_index_ GUARDED_BY(mu_) = 0;
+      int64 block_index_ GUARDED_BY(mu_) = 0;
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      // The slot threads. This must be last to ensure the threads have exited
+      // before any other members are deallocated.
+      std::vector<std::unique_ptr<Thread>> threads_ GUARDED_BY(mu_);
+    };
+
     const DatasetBase* const input_;
     const NameAttrList func_;
     const std::unique_ptr<CapturedFunction> captured_func_;
     const int64 cycle_length_;
     const int64 block_length_;
+    const bool sloppy_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
   };
@@ -323,6 +521,7 @@ class InterleaveDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   NameAttrList func_;
+  bool sloppy_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("InterleaveDataset").Device(DEVICE_CPU),
@@ -14,21 +14,300 @@ limitations under the License.
 ==============================================================================*/
 #define EIGEN_USE_THREADS
 
+#include <unordered_map>
+
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/kernels/inplace_ops_functor.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Describes a map function that parses a serialized `Example` proto with a
+// single `ParseSingleExample` op, and returns some of its dense features. A
+// batch of elements of such a function can be parsed with a single call to
+// `example::FastParseExample()`, which writes each feature directly into its
+// batched output tensor.
+struct ParseExampleFunction {
+  example::FastParseExampleConfig config;
+  // For each return value of the function, the index of the corresponding
+  // feature in `config.dense`.
+  std::vector<int> output_to_dense;
+};
+
+typedef std::unordered_map<string, const NodeDef*> NodeMap;
+
+// Returns the node that produces `ref` (of the form "node:output:index"),
+// skipping any `Identity` nodes, and stores the name of that node's output in
+// `*output_name` and its index in `*output_index`. Returns nullptr if `ref`
+// refers to a function argument, and stores the argument's name in
+// `*output_name`.
+const NodeDef* ResolveInput(const NodeMap& nodes, string ref,
+                            string* output_name, int* output_index) {
+  while (true) {
+    std::vector<string> parts = str_util::Split(ref, ':');
+    if (parts.size() != 3) {
+      *output_name = ref;
+      *output_index = 0;
+      return nullptr;
+    }
+    auto it = nodes.find(parts[0]);
+    if (it == nodes.end() ||
+        !strings::safe_strto32(parts[2], output_index)) {
+      *output_name = ref;
+      return nullptr;
+    }
+    const NodeDef* node = it->second;
+    if (node->op() != "Identity" || node->input_size() != 1) {
+      *output_name = parts[1];
+      return node;
+    }
+    ref = node->input(0);
+  }
+}
+
+// Evaluates `ref`, if it is computed by `Const` and `Reshape` nodes only.
+bool EvaluateConstant(const NodeMap& nodes, const string& ref, Tensor* out) {
+  string output_name;
+  int output_index;
+  const NodeDef* node = ResolveInput(nodes, ref, &output_name, &output_index);
+  if (node == nullptr || output_index != 0) {
+    return false;
+  }
+  if (node->op() == "Const") {
+    auto it = node->attr().find("value");
+    return it != node->attr().end() && out->FromProto(it->second.tensor());
+  }
+  if (node->op() != "Reshape" || node->input_size() != 2) {
+    return false;
+  }
+  Tensor input;
+  Tensor shape_t;
+  if (!EvaluateConstant(nodes, node->input(0), &input) ||
+      !EvaluateConstant(nodes, node->input(1), &shape_t) ||
+      !TensorShapeUtils::IsVector(shape_t.shape())) {
+    return false;
+  }
+  TensorShape shape;
+  int64 inferred_dim = -1;
+  for (int64 i = 0; i < shape_t.NumElements(); ++i) {
+    int64 dim;
+    if (shape_t.dtype() == DT_INT32) {
+      dim = shape_t.flat<int32>()(i);
+    } else if (shape_t.dtype() == DT_INT64) {
+      dim = shape_t.flat<int64>()(i);
+    } else {
+      return false;
+    }
+    if (dim == -1 && inferred_dim == -1) {
+      inferred_dim = i;
+      dim = 1;
+    } else if (dim < 0) {
+      return false;
+    }
+    shape.AddDim(dim);
+  }
+  if (inferred_dim != -1) {
+    if (shape.num_elements() == 0 ||
+        input.NumElements() % shape.num_elements() != 0) {
+      return false;
+    }
+    shape.set_dim(inferred_dim, input.NumElements() / shape.num_elements());
+  }
+  return out->CopyFrom(input, shape);
+}
+
+// Returns true if `ref` resolves to the function argument named `arg_name`.
+bool IsArgument(const NodeMap& nodes, const string& ref,
+                const string& arg_name) {
+  string output_name;
+  int output_index;
+  return ResolveInput(nodes, ref, &output_name, &output_index) == nullptr &&
+         output_name == arg_name;
+}
+
+// Returns true if `ref` evaluates to a constant with the given `value`.
+template <typename T>
+bool IsConstantScalar(const NodeMap& nodes, const string& ref, T value) {
+  Tensor t;
+  return EvaluateConstant(nodes, ref, &t) && t.NumElements() == 1 &&
+         t.dtype() == DataTypeToEnum<T>::value && t.flat<T>()(0) == value;
+}
+
+// Returns true if `fdef` takes a single string argument, parses it as an
+// `Example` proto without sparse features, and returns fixed-shape dense
+// features, and stores a description of the function in `*parse_fn`.
+//
+// Two forms of functions are recognized: those that call the
+// `ParseSingleExample` op directly, and those that (like
+// `tf.parse_single_example()`) expand the argument to a batch of one, call the
+// `ParseExample` op, and squeeze each feature. Keys, names and default values
+// must be computed by `Const` and `Reshape` nodes only, and the function may
+// not contain any other computation.
+bool MatchParseExampleFunction(const FunctionDef& fdef,
+                               const DataTypeVector& output_types,
+                               ParseExampleFunction* parse_fn) {
+  const OpDef& signature = fdef.signature();
+  if (signature.input_arg_size() != 1 ||
+      signature.input_arg(0).type() != DT_STRING ||
+      signature.output_arg_size() != static_cast<int>(output_types.size()) ||
+      signature.output_arg_size() == 0) {
+    return false;
+  }
+  const string& arg_name = signature.input_arg(0).name();
+  NodeMap nodes;
+  for (const NodeDef& node : fdef.node_def()) {
+    if (node.op() != "ParseSingleExample" && node.op() != "ParseExample" &&
+        node.op() != "ExpandDims" && node.op() != "Squeeze" &&
+        node.op() != "Identity" && node.op() != "Const" &&
+        node.op() != "Reshape") {
+      return false;
+    }
+    for (const string& input : node.input()) {
+      if (str_util::StartsWith(input, "^")) {
+        return false;
+      }
+    }
+    nodes[node.name()] = &node;
+  }
+
+  // Each return value must be a dense feature of the same parsing node.
+  const NodeDef* parse_node = nullptr;
+  std::vector<int> output_to_dense;
+  for (const OpDef::ArgDef& output_arg : signature.output_arg()) {
+    auto ret = fdef.ret().find(output_arg.name());
+    if (ret == fdef.ret().end()) {
+      return false;
+    }
+    string output_name;
+    int output_index;
+    const NodeDef* node =
+        ResolveInput(nodes, ret->second, &output_name, &output_index);
+    if (node != nullptr && node->op() == "Squeeze") {
+      auto squeeze_dims = node->attr().find("squeeze_dims");
+      if (squeeze_dims == node->attr().end() ||
+          squeeze_dims->second.list().i_size() != 1 ||
+          squeeze_dims->second.list().i(0) != 0) {
+        return false;
+      }
+      node = ResolveInput(nodes, node->input(0), &output_name, &output_index);
+      if (node == nullptr || node->op() != "ParseExample") {
+        return false;
+      }
+    } else if (node == nullptr || node->op() != "ParseSingleExample") {
+      return false;
+    }
+    if (output_name != "dense_values" ||
+        (parse_node != nullptr && parse_node != node)) {
+      return false;
+    }
+    parse_node = node;
+    output_to_dense.push_back(output_index);
+  }
+
+  // Find the keys and the inputs that compute the default values.
+  const auto& attrs = parse_node->attr();
+  auto dense_types = attrs.find("Tdense");
+  auto dense_shapes = attrs.find("dense_shapes");
+  if (dense_types == attrs.end() || dense_shapes == attrs.end()) {
+    return false;
+  }
+  const int num_dense = dense_types->second.list().type_size();
+  std::vector<string> dense_keys;
+  int first_default_input;
+  if (parse_node->op() == "ParseSingleExample") {
+    auto num_sparse = attrs.find("num_sparse");
+    auto keys = attrs.find("dense_keys");
+    if (num_sparse == attrs.end() || num_sparse->second.i() != 0 ||
+        keys == attrs.end() || keys->second.list().s_size() != num_dense ||
+        parse_node->input_size() != 1 + num_dense ||
+        !IsArgument(nodes, parse_node->input(0), arg_name)) {
+      return false;
+    }
+    dense_keys.assign(keys->second.list().s().begin(),
+                      keys->second.list().s().end());
+    first_default_input = 1;
+  } else {
+    // Inputs: serialized, names, sparse_keys, dense_keys, dense_defaults.
+    auto num_sparse = attrs.find("Nsparse");
+    Tensor names;
+    if (num_sparse == attrs.end() || num_sparse->second.i() != 0 ||
+        parse_node->input_size() != 2 + 2 * num_dense ||
+        !EvaluateConstant(nodes, parse_node->input(1), &names) ||
+        names.NumElements() != 0) {
+      return false;
+    }
+    string output_name;
+    int output_index;
+    const NodeDef* expand_node = ResolveInput(
+        nodes, parse_node->input(0), &output_name, &output_index);
+    if (expand_node == nullptr || expand_node->op() != "ExpandDims" ||
+        expand_node->input_size() != 2 ||
+        !IsArgument(nodes, expand_node->input(0), arg_name) ||
+        !(IsConstantScalar<int32>(nodes, expand_node->input(1), 0) ||
+          IsConstantScalar<int64>(nodes, expand_node->input(1), 0))) {
+      return false;
+    }
+    for (int d = 0; d < num_dense; ++d) {
+      Tensor key;
+      if (!EvaluateConstant(nodes, parse_node->input(2 + d), &key) ||
+          key.dtype() != DT_STRING || key.NumElements() != 1) {
+        return false;
+      }
+      dense_keys.push_back(key.flat<string>()(0));
+    }
+    first_default_input = 2 + num_dense;
+  }
+  if (dense_shapes->second.list().shape_size() != num_dense) {
+    return false;
+  }
+
+  example::FastParseExampleConfig config;
+  for (int d = 0; d < num_dense; ++d) {
+    const DataType dtype =
+        static_cast<DataType>(dense_types->second.list().type(d));
+    const PartialTensorShape shape(dense_shapes->second.list().shape(d));
+    TensorShape fixed_shape;
+    Tensor default_value;
+    if (!shape.AsTensorShape(&fixed_shape) ||
+        !EvaluateConstant(nodes, parse_node->input(first_default_input + d),
+                          &default_value) ||
+        default_value.dtype() != dtype ||
+        (default_value.NumElements() != 0 &&
+         !default_value.shape().IsSameSize(fixed_shape))) {
+      return false;
+    }
+    config.dense.push_back({dense_keys[d], dtype, shape, default_value,
+                            false /* variable_length */,
+                            static_cast<std::size_t>(
+                                fixed_shape.num_elements())});
+  }
+  for (size_t i = 0; i < output_to_dense.size(); ++i) {
+    if (output_to_dense[i] < 0 || output_to_dense[i] >= num_dense ||
+        config.dense[output_to_dense[i]].dtype != output_types[i]) {
+      return false;
+    }
+  }
+
+  parse_fn->config = std::move(config);
+  parse_fn->output_to_dense = std::move(output_to_dense);
+  return true;
+}
+
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
@@ -71,9 +350,27 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                                                  std::move(other_arguments),
                                                  &captured_func));
 
+    // If the map function only parses a serialized `Example`, parse each
+    // batch with a single call to `example::FastParseExample()`.
+    std::unique_ptr<ParseExampleFunction> parse_fn;
+    const FunctionDef* fdef =
+        ctx->function_library()->GetFunctionLibraryDefinition()->Find(
+            func_.name());
+    if (fdef != nullptr && inputs.size() == 0) {
+      parse_fn.reset(new ParseExampleFunction);
+      if (MatchParseExampleFunction(*fdef, output_types_, parse_fn.get())) {
+        VLOG(1) << "Fusing parsing of Examples into MapAndBatchDataset for "
+                << "function " << func_.name();
+      } else {
+        parse_fn.reset();
+      }
+    }
+
     *output = new Dataset(input, batch_size, num_parallel_batches,
                           output_types_, output_shapes_,
-                          std::move(captured_func), &ctx->eigen_cpu_device());
+                          std::move(captured_func), std::move(parse_fn),
+                          &ctx->eigen_cpu_device(),
+                          ctx->device()->tensorflow_cpu_worker_threads());
   }
 
  private:
@@ -83,14 +380,18 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
             int64 num_parallel_batches, const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes,
             std::unique_ptr<CapturedFunction> captured_func,
-            const Eigen::ThreadPoolDevice* device)
+            std::unique_ptr<ParseExampleFunction> parse_fn,
+            const Eigen::ThreadPoolDevice* device,
+            const DeviceBase::CpuWorkerThreads* worker_threads)
         : input_(input),
           batch_size_(batch_size),
           num_parallel_batches_(num_parallel_batches),
           output_types_(output_types),
           output_shapes_(output_shapes),
           captured_func_(std::move(captured_func)),
-          device_(device) {
+          parse_fn_(std::move(parse_fn)),
+          device_(device),
+          worker_threads_(worker_threads) {
       input_->Ref();
     }
 
@@ -98,6 +399,10 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
 
     std::unique_ptr<IteratorBase> MakeIterator(
         const string& prefix) const override {
+      if (parse_fn_) {
+        return std::unique_ptr<IteratorBase>(new ParseExampleIterator(
+            {this, strings::StrCat(prefix, "::MapAndBatch")}));
+      }
       return std::unique_ptr<IteratorBase>(
           new Iterator({this, strings::StrCat(prefix, "::MapAndBatch")}));
     }
@@ -398,6 +703,127 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       std::vector<BatchResult> batch_results_ GUARDED_BY(mu_);
     };
 
+    // Produces each batch by parsing the serialized `Example` protos of its
+    // elements with a single call to `example::FastParseExample()`, instead of
+    // invoking the map function on each element and copying the results into
+    // the batch.
+    class ParseExampleIterator : public DatasetIterator<Dataset> {
+     public:
+      explicit ParseExampleIterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
+            batch_results_(params.dataset->num_parallel_batches_) {}
+
+      ~ParseExampleIterator() override {
+        mutex_lock l(mu_);
+        for (BatchResult& batch_result : batch_results_) {
+          if (batch_result.done) {
+            batch_result.done->WaitForNotification();
+          }
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+
+        // One-time initialization.
+        if (current_batch_index_ == -1) {
+          current_batch_index_ = 0;
+          for (size_t i = 0; i < batch_results_.size(); ++i) {
+            StartBatchLocked(ctx, &batch_results_[i]);
+          }
+        }
+
+        BatchResult* batch_result = &batch_results_[current_batch_index_];
+        {
+          port::Tracing::TraceMe activity(strings::StrCat(prefix(), "::Wait"));
+          batch_result->done->WaitForNotification();
+        }
+        if (batch_result->status.ok() && batch_result->num_elements == 0) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        Status status = batch_result->status;
+        if (status.ok()) {
+          for (int dense_index : dataset()->parse_fn_->output_to_dense) {
+            out_tensors->push_back(
+                batch_result->result.dense_values[dense_index]);
+          }
+          *end_of_sequence = false;
+        }
+        StartBatchLocked(ctx, batch_result);
+        current_batch_index_ =
+            (current_batch_index_ + 1) % dataset()->num_parallel_batches_;
+        return status;
+      }
+
+     private:
+      struct BatchResult {
+        Status status;
+        int64 num_elements = 0;
+        std::vector<string> serialized;
+        example::Result result;
+        std::unique_ptr<Notification> done;
+      };
+
+      // Reads the next batch of serialized protos from the input, and
+      // schedules parsing them into `*batch_result`.
+      void StartBatchLocked(IteratorContext* ctx, BatchResult* batch_result)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        port::Tracing::TraceMe activity(strings::StrCat(prefix(), "::Start"));
+        batch_result->status = Status::OK();
+        batch_result->num_elements = 0;
+        batch_result->serialized.clear();
+        batch_result->result = example::Result();
+        batch_result->done.reset(new Notification);
+
+        while (!end_of_input_ && batch_result->num_elements <
+                                     dataset()->batch_size_) {
+          std::vector<Tensor> input_element;
+          Status s = input_impl_->GetNext(ctx, &input_element, &end_of_input_);
+          if (!s.ok()) {
+            batch_result->status = s;
+            break;
+          }
+          if (end_of_input_) {
+            break;
+          }
+          if (input_element.size() != 1 ||
+              input_element[0].dtype() != DT_STRING ||
+              !TensorShapeUtils::IsScalar(input_element[0].shape())) {
+            batch_result->status = errors::InvalidArgument(
+                "Expected each input element to be a scalar string.");
+            break;
+          }
+          batch_result->serialized.push_back(
+              input_element[0].scalar<string>()());
+          ++batch_result->num_elements;
+        }
+
+        if (!batch_result->status.ok() || batch_result->num_elements == 0) {
+          batch_result->serialized.clear();
+          batch_result->done->Notify();
+          return;
+        }
+        (*ctx->runner())([this, batch_result]() {
+          batch_result->status = example::FastParseExample(
+              dataset()->parse_fn_->config, batch_result->serialized,
+              gtl::ArraySlice<string>(), dataset()->worker_threads_->workers,
+              &batch_result->result);
+          batch_result->serialized.clear();
+          batch_result->done->Notify();
+        });
+      }
+
+      mutex mu_;
+      int32 current_batch_index_ GUARDED_BY(mu_) = -1;
+      bool end_of_input_ GUARDED_BY(mu_) = false;
+      const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      std::vector<BatchResult> batch_results_ GUARDED_BY(mu_);
+    };
+
     const DatasetBase* const input_;
     const NameAttrList func_;
     const int64 batch_size_;
@@ -405,7 +831,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
     const std::unique_ptr<CapturedFunction> captured_func_;
-    const Eigen::ThreadPoolDevice* device_;  // not owned
+    const std::unique_ptr<ParseExampleFunction> parse_fn_;
+    const Eigen::ThreadPoolDevice* device_;                      // not owned
+    const DeviceBase::CpuWorkerThreads* const worker_threads_;  // not owned
   };
 
   const int graph_def_version_;
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/parallelism_tuner.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/random.h"
 
@@ -30,6 +31,10 @@ namespace {
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
+// The largest per-worker buffer size that will be chosen when
+// `buffer_output_elements` is tuned automatically.
+constexpr int64 kMaxAutoTunedBufferOutputElements = 64;
+
 class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit ParallelInterleaveDatasetOp(OpKernelConstruction* ctx)
@@ -68,9 +73,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
     int64 buffer_output_elements = 0;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "buffer_output_elements",
                                             &buffer_output_elements));
-    OP_REQUIRES(
-        ctx, buffer_output_elements > 0,
-        errors::InvalidArgument("`buffer_output_elements` must be > 0"));
+    OP_REQUIRES(ctx,
+                buffer_output_elements > 0 ||
+                    buffer_output_elements == ParallelismTuner::kAutoTune,
+                errors::InvalidArgument(
+                    "`buffer_output_elements` must be > 0 or -1 (autotune)"));
 
     int64 prefetch_input_elements = 0;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "prefetch_input_elements",
@@ -187,7 +194,16 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
             input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            workers_(dataset()->num_threads()) {}
+            workers_(dataset()->num_threads()) {
+        if (dataset()->buffer_output_elements_ == ParallelismTuner::kAutoTune) {
+          // The number of worker threads determines the order of the
+          // output, so only the amount of buffering per worker is tuned.
+          // A larger buffer only costs memory, so it is never decreased.
+          tuner_.reset(new ParallelismTuner(
+              Env::Default(), 1, kMaxAutoTunedBufferOutputElements, 1,
+              false /* shrink_when_idle */));
+        }
+      }
 
       ~Iterator() override {
         mutex_lock l(mu_);
@@ -206,6 +222,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsureWorkerThreadsStarted(ctx));
+        const uint64 start_usec = tuner_ ? ctx->env()->NowMicros() : 0;
         while (!cancelled_) {
           // Wait for an item to become available, blocking if necessary. If we
           // are allowed to be sloppy, we can skip over input datasets that do
@@ -234,6 +251,10 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
               current_worker->outputs.front().output.swap(*out_tensors);
               current_worker->outputs.pop_front();
               current_worker->cond_var.notify_one();
+              if (tuner_) {
+                tuner_->RecordConsumerWait(ctx->env()->NowMicros() -
+                                           start_usec);
+              }
               return s;
             } else if (current_worker->is_producing && !dataset()->sloppy_) {
               // current_worker.outputs.empty(), and we must wait for this
@@ -382,6 +403,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         std::unique_ptr<IteratorContext> ctx(ctx_ptr);
         auto cleanup = gtl::MakeCleanup([this, thread_index] {
           mutex_lock l(mu_);
+          if (dataset()->sloppy_) {
+            sloppy_cond_var_.notify_all();
+          }
           workers_[thread_index].cond_var.notify_all();
         });
 
@@ -408,22 +432,27 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
             mutex_lock l(mu_);
             workers_[thread_index].outputs.emplace_back(s);
             workers_[thread_index].is_producing = false;
-            workers_[thread_index].cond_var.notify_one();
+            NotifyConsumer(thread_index);
           } else {
             // 3. Produce elements
             bool end_of_sequence = false;
             while (!end_of_sequence) {
               // 3.a Produce an element!
               std::vector<Tensor> output_elem;
+              const uint64 start_usec = tuner_ ? ctx->env()->NowMicros() : 0;
               s = iterator->GetNext(ctx.get(), &output_elem, &end_of_sequence);
+              if (tuner_) {
+                tuner_->RecordProducerBusy(ctx->env()->NowMicros() -
+                                           start_usec);
+              }
 
               // 3.b Make it available to the client.
               {
                 mutex_lock l(mu_);
 
                 // Wait for space in the prefetch queue.
-                while (!cancelled_ && workers_[thread_index].outputs.size() ==
-                                          dataset()->buffer_output_elements_) {
+                while (!cancelled_ && workers_[thread_index].outputs.size() >=
+                                          BufferOutputElements()) {
                   workers_[thread_index].cond_var.wait(l);
                 }
                 if (cancelled_) return;
@@ -435,17 +464,29 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                   workers_[thread_index].outputs.back().output.swap(
                       output_elem);
                 }
-                if (dataset()->sloppy_) {
-                  sloppy_cond_var_.notify_one();
-                } else {
-                  workers_[thread_index].cond_var.notify_one();
-                }
+                NotifyConsumer(thread_index);
               }
             }
           }
         }
       }
 
+      // Wakes the main thread if it may be waiting for `thread_index` to
+      // produce an element or reach the end of its input. In sloppy mode the
+      // main thread waits for any worker, rather than a particular one.
+      void NotifyConsumer(int64 thread_index) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (dataset()->sloppy_) {
+          sloppy_cond_var_.notify_one();
+        } else {
+          workers_[thread_index].cond_var.notify_one();
+        }
+      }
+
+      // Returns the number of elements that each worker thread may buffer.
+      size_t BufferOutputElements() const {
+        return tuner_ ? tuner_->value() : dataset()->buffer_output_elements_;
+      }
+
       // Mutex & condition variable to guard mutable iterator internals and
       // coordinate among worker threads and client thread[s].
       mutex mu_;
@@ -473,6 +514,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       size_t block_count_ GUARDED_BY(mu_) = 0;
       // Flag to instruct the worker threads to exit.
       bool cancelled_ GUARDED_BY(mu_) = false;
+      // Non-null if and only if `dataset()->buffer_output_elements_` is
+      // `ParallelismTuner::kAutoTune`.
+      std::unique_ptr<ParallelismTuner> tuner_;
       // The worker threads. This must be last to ensure the
       // threads have exited before any other members are deallocated.
       // TODO(b/65178177): Avoid allocating additional threads.
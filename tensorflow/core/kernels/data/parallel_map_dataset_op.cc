@@ -19,7 +19,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/parallelism_tuner.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 
@@ -52,9 +54,12 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     int32 num_parallel_calls;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                             &num_parallel_calls));
-    OP_REQUIRES(ctx, num_parallel_calls > 0,
+    OP_REQUIRES(ctx,
+                num_parallel_calls > 0 ||
+                    num_parallel_calls == ParallelismTuner::kAutoTune,
                 errors::InvalidArgument(
-                    "num_parallel_calls must be greater than zero."));
+                    "num_parallel_calls must be greater than zero, or -1 to "
+                    "tune it automatically."));
 
     std::unique_ptr<CapturedFunction> captured_func;
     OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
@@ -103,8 +108,18 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
      public:
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
-            input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            invocation_results_(params.dataset->num_parallel_calls_) {}
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)) {
+        if (dataset()->num_parallel_calls_ == ParallelismTuner::kAutoTune) {
+          // Start with a single outstanding invocation, and allow up to one
+          // invocation per schedulable CPU.
+          tuner_.reset(new ParallelismTuner(Env::Default(), 1,
+                                            port::NumSchedulableCPUs(), 1,
+                                            true /* shrink_when_idle */));
+          invocation_results_.resize(port::NumSchedulableCPUs());
+        } else {
+          invocation_results_.resize(dataset()->num_parallel_calls_);
+        }
+      }
 
       ~Iterator() override {
         // TODO(mrry): Replace this cancellation logic with a
@@ -114,7 +129,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         // potentially-blocking iterators, when we add these.
         {
           mutex_lock l(mu_);
-          for (size_t i = 0; i < dataset()->num_parallel_calls_; ++i) {
+          for (size_t i = 0; i < invocation_results_.size(); ++i) {
             if (invocation_results_[i].notification) {
               invocation_results_[i].notification->WaitForNotification();
             }
@@ -127,10 +142,11 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
 
-        // Ensure that there are `dataset()->num_parallel_calls_`
-        // invocations of `func_` outstanding at once.
-        while (!end_of_input_ && (num_inputs_consumed_ - num_outputs_consumed_ <
-                                  dataset()->num_parallel_calls_)) {
+        // Ensure that there are `ParallelCalls()` invocations of `func_`
+        // outstanding at once.
+        const int64 parallel_calls = ParallelCalls();
+        while (!end_of_input_ &&
+               num_inputs_consumed_ - num_outputs_consumed_ < parallel_calls) {
           InvokeFunctionLocked(ctx);
         }
 
@@ -142,11 +158,18 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         // Read the next result out of `invocation_results_`, which
         // acts as a circular buffer.
         const size_t result_index =
-            num_outputs_consumed_ % dataset()->num_parallel_calls_;
+            num_outputs_consumed_ % invocation_results_.size();
         InvocationResult* result = &invocation_results_[result_index];
         *end_of_sequence = false;
         if (result->notification) {
-          result->notification->WaitForNotification();
+          if (tuner_) {
+            const uint64 start_usec = Env::Default()->NowMicros();
+            result->notification->WaitForNotification();
+            tuner_->RecordConsumerWait(Env::Default()->NowMicros() -
+                                       start_usec);
+          } else {
+            result->notification->WaitForNotification();
+          }
           if (result->status.ok()) {
             std::swap(*out_tensors, result->return_values);
           }
@@ -162,16 +185,23 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         std::vector<Tensor> return_values;
       };
 
+      // Returns the number of invocations of `func_` that may be outstanding
+      // at once. When tuning is enabled, this may change between calls, but
+      // never exceeds `invocation_results_.size()`.
+      int64 ParallelCalls() const {
+        return tuner_ ? tuner_->value() : dataset()->num_parallel_calls_;
+      }
+
       void InvokeFunctionLocked(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         DCHECK(!end_of_input_);
         DCHECK(num_inputs_consumed_ - num_outputs_consumed_ <
-               dataset()->num_parallel_calls_);
+               static_cast<int64>(invocation_results_.size()));
 
         // The result of invoking the function will be written into the next
         // slot in `invocation_results_`, which acts as a circular buffer.
         const size_t result_index =
-            num_inputs_consumed_ % dataset()->num_parallel_calls_;
+            num_inputs_consumed_ % invocation_results_.size();
         InvocationResult* result = &invocation_results_[result_index];
         *result = InvocationResult();
 
@@ -202,10 +232,16 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
               });
           opts.step_container = step_container;
           opts.runner = ctx->runner();
+          ParallelismTuner* tuner = tuner_.get();
+          const uint64 start_usec = tuner ? Env::Default()->NowMicros() : 0;
           dataset()->captured_func_->RunAsync(
               opts, std::move(input_element), &result->return_values,
-              [result, step_container, result_index](Status ret_status) {
+              [result, step_container, tuner, start_usec](Status ret_status) {
                 delete step_container;
+                if (tuner) {
+                  tuner->RecordProducerBusy(Env::Default()->NowMicros() -
+                                            start_usec);
+                }
                 result->status.Update(ret_status);
                 result->notification->Notify();
               });
@@ -218,6 +254,9 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       bool end_of_input_ GUARDED_BY(mu_) = false;
       int64 num_inputs_consumed_ GUARDED_BY(mu_) = 0;
       int64 num_outputs_consumed_ GUARDED_BY(mu_) = 0;
+      // Non-null if and only if `dataset()->num_parallel_calls_` is
+      // `ParallelismTuner::kAutoTune`.
+      std::unique_ptr<ParallelismTuner> tuner_;
     };
 
     const DatasetBase* const input_;
@@ -0,0 +1,108 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/parallelism_tuner.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A window ends once it contains `kMaxWindowElements` elements, or once it
+// spans `kMaxWindowUsec` microseconds and contains at least
+// `kMinWindowElements` elements.
+constexpr int64 kMinWindowElements = 4;
+constexpr int64 kMaxWindowElements = 64;
+constexpr uint64 kMaxWindowUsec = 100000;
+
+// The fraction of a window that the consumer may spend waiting before the
+// value is increased.
+constexpr double kWaitThreshold = 0.05;
+
+// Extra parallelism requested on top of the estimate, to absorb variance in
+// the producers' running time.
+constexpr double kHeadroom = 1.2;
+
+}  // namespace
+
+constexpr int64 ParallelismTuner::kAutoTune;
+
+ParallelismTuner::ParallelismTuner(Env* env, int64 min_value, int64 max_value,
+                                   int64 initial_value, bool shrink_when_idle)
+    : env_(env),
+      min_value_(min_value),
+      max_value_(std::max(min_value, max_value)),
+      shrink_when_idle_(shrink_when_idle),
+      value_(std::min(max_value_, std::max(min_value_, initial_value))),
+      window_start_usec_(env->NowMicros()) {}
+
+void ParallelismTuner::RecordConsumerWait(int64 wait_usec) {
+  const uint64 now_usec = env_->NowMicros();
+  mutex_lock l(mu_);
+  ++window_elements_;
+  window_wait_usec_ += wait_usec;
+  MaybeAdjustLocked(now_usec);
+}
+
+void ParallelismTuner::RecordProducerBusy(int64 busy_usec) {
+  mutex_lock l(mu_);
+  window_busy_usec_ += busy_usec;
+}
+
+void ParallelismTuner::MaybeAdjustLocked(uint64 now_usec) {
+  const uint64 elapsed_usec =
+      now_usec > window_start_usec_ ? now_usec - window_start_usec_ : 0;
+  if (window_elements_ < kMinWindowElements ||
+      (window_elements_ < kMaxWindowElements &&
+       elapsed_usec < kMaxWindowUsec)) {
+    return;
+  }
+
+  const int64 current = value_.load(std::memory_order_relaxed);
+  const double wait_fraction =
+      elapsed_usec > 0
+          ? static_cast<double>(window_wait_usec_) / elapsed_usec
+          : 0.0;
+  const double consumer_usec = std::max<double>(
+      1.0, static_cast<double>(elapsed_usec) - window_wait_usec_);
+  const int64 estimate = static_cast<int64>(
+      std::ceil(kHeadroom * window_busy_usec_ / consumer_usec));
+
+  int64 next = current;
+  if (wait_fraction > kWaitThreshold) {
+    next = std::max(current + 1, estimate);
+  } else if (shrink_when_idle_ && window_wait_usec_ == 0 &&
+             estimate < current) {
+    next = current - 1;
+  }
+  next = std::min(max_value_, std::max(min_value_, next));
+  if (next != current) {
+    VLOG(2) << "Adjusting parallelism from " << current << " to " << next
+            << " (wait fraction: " << wait_fraction
+            << ", estimate: " << estimate << ")";
+    value_.store(next, std::memory_order_relaxed);
+  }
+
+  window_start_usec_ = now_usec;
+  window_elements_ = 0;
+  window_wait_usec_ = 0;
+  window_busy_usec_ = 0;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,84 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATA_PARALLELISM_TUNER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATA_PARALLELISM_TUNER_H_
+
+#include <atomic>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Adjusts a performance knob of an asynchronous dataset iterator (such as the
+// number of concurrent function invocations, or the number of buffered
+// elements) at runtime, based on how long the iterator's consumer waits for
+// elements and how long its producers take to produce them.
+//
+// Observations are grouped into windows. At the end of each window, the
+// tuner estimates the parallelism that would let the producers keep up with
+// the consumer:
+//
+//   estimate = producer busy time / (window wall time - consumer wait time)
+//
+// If the consumer spent a noticeable fraction of the window waiting, the
+// value grows, by at least one, towards the estimate. If the consumer did not
+// wait, and `shrink_when_idle` is set, the value shrinks by one towards the
+// estimate so that unused parallelism is returned to the rest of the
+// process. The value always stays in `[min_value, max_value]`.
+//
+// This class is thread-safe.
+class ParallelismTuner {
+ public:
+  // The value of a dataset op's attribute or input that requests tuning.
+  static constexpr int64 kAutoTune = -1;
+
+  ParallelismTuner(Env* env, int64 min_value, int64 max_value,
+                   int64 initial_value, bool shrink_when_idle);
+
+  // Returns the current value of the knob. This method does not block.
+  int64 value() const { return value_.load(std::memory_order_relaxed); }
+
+  // Records that the consumer obtained one element after waiting for
+  // `wait_usec` microseconds.
+  void RecordConsumerWait(int64 wait_usec);
+
+  // Records that a producer spent `busy_usec` microseconds producing one
+  // element.
+  void RecordProducerBusy(int64 busy_usec);
+
+ private:
+  void MaybeAdjustLocked(uint64 now_usec) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const int64 min_value_;
+  const int64 max_value_;
+  const bool shrink_when_idle_;
+  std::atomic<int64> value_;
+
+  mutex mu_;
+  uint64 window_start_usec_ GUARDED_BY(mu_);
+  int64 window_elements_ GUARDED_BY(mu_) = 0;
+  int64 window_wait_usec_ GUARDED_BY(mu_) = 0;
+  int64 window_busy_usec_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelismTuner);
+};
+
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATA_PARALLELISM_TUNER_H_
@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/parallelism_tuner.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 
 namespace tensorflow {
@@ -26,6 +27,10 @@ namespace {
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
+// The largest buffer size that will be chosen when `buffer_size` is tuned
+// automatically.
+constexpr int64 kMaxAutoTunedBufferSize = 64;
+
 class PrefetchDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit PrefetchDatasetOp(OpKernelConstruction* ctx)
@@ -37,8 +42,9 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
     int64 buffer_size;
     OP_REQUIRES_OK(
         ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
-    OP_REQUIRES(ctx, buffer_size > 0,
-                errors::InvalidArgument("buffer_size must be > 0"));
+    OP_REQUIRES(
+        ctx, buffer_size > 0 || buffer_size == ParallelismTuner::kAutoTune,
+        errors::InvalidArgument("buffer_size must be > 0 or -1 (autotune)"));
 
     *output = new Dataset(ctx, input, buffer_size);
   }
@@ -85,7 +91,15 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
      public:
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
-            input_impl_(params.dataset->input_->MakeIterator(params.prefix)) {}
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)) {
+        if (dataset()->buffer_size_ == ParallelismTuner::kAutoTune) {
+          // A larger buffer only costs memory, so the tuned buffer size is
+          // never decreased.
+          tuner_.reset(new ParallelismTuner(Env::Default(), 1,
+                                            kMaxAutoTunedBufferSize, 1,
+                                            false /* shrink_when_idle */));
+        }
+      }
 
       ~Iterator() override {
         // Signal the prefetch thread to terminate it. We will then
@@ -109,6 +123,7 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
 
+        const uint64 start_usec = tuner_ ? ctx->env()->NowMicros() : 0;
         while (true) {
           // Wait until the next element in the buffer has been
           // produced, or we are shutting down.
@@ -131,6 +146,9 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
             }
             buffer_.pop_front();
             *end_of_sequence = false;
+            if (tuner_) {
+              tuner_->RecordConsumerWait(ctx->env()->NowMicros() - start_usec);
+            }
 
             // Wake the prefetch thread, in case it has been waiting
             // for space in the buffer.
@@ -242,7 +260,7 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
           // 1. Wait for a slot in the buffer.
           {
             mutex_lock l(mu_);
-            while (!cancelled_ && buffer_.size() == dataset()->buffer_size_) {
+            while (!cancelled_ && buffer_.size() >= BufferLimit()) {
               cond_var_.wait(l);
             }
 
@@ -260,8 +278,12 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
           mutex_lock parent_l(parent_mu_);
           bool end_of_sequence;
           BufferElement buffer_element;
+          const uint64 start_usec = tuner_ ? ctx->env()->NowMicros() : 0;
           buffer_element.status = input_impl_->GetNext(
               ctx, &buffer_element.value, &end_of_sequence);
+          if (tuner_) {
+            tuner_->RecordProducerBusy(ctx->env()->NowMicros() - start_usec);
+          }
           if (buffer_element.status.ok() && end_of_sequence) {
             mutex_lock l(mu_);
             prefetch_thread_finished_ = true;
@@ -278,6 +300,11 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
         }
       }
 
+      // Returns the number of elements that the prefetch thread may buffer.
+      size_t BufferLimit() const {
+        return tuner_ ? tuner_->value() : dataset()->buffer_size_;
+      }
+
       Status WriteStatus(IteratorStateWriter* writer, size_t index,
                          const Status& status) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(
@@ -322,6 +349,10 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
       // allow prefetching to run in parallel with GetNext calls.
       mutex parent_mu_ ACQUIRED_BEFORE(mu_);
       const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(parent_mu_);
+      // Non-null if and only if `dataset()->buffer_size_` is
+      // `ParallelismTuner::kAutoTune`. Declared before
+      // `prefetch_thread_`, which uses it, so that it outlives the thread.
+      std::unique_ptr<ParallelismTuner> tuner_;
       condition_variable cond_var_;
       std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
       std::unique_ptr<Thread> prefetch_thread_ GUARDED_BY(mu_);
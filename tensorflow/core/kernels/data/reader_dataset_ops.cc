@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <string.h>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
@@ -31,7 +33,10 @@ namespace {
 
 class TextLineDatasetOp : public DatasetOpKernel {
  public:
-  using DatasetOpKernel::DatasetOpKernel;
+  explicit TextLineDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_mmap", &use_mmap_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
     const Tensor* filenames_tensor;
@@ -74,7 +79,7 @@ class TextLineDatasetOp : public DatasetOpKernel {
     }
 
     *output = new Dataset(ctx, std::move(filenames), compression_type,
-                          zlib_compression_options);
+                          zlib_compression_options, use_mmap_);
   }
 
  private:
@@ -82,12 +87,13 @@ class TextLineDatasetOp : public DatasetOpKernel {
    public:
     Dataset(OpKernelContext* ctx, std::vector<string> filenames,
             const string& compression_type,
-            const io::ZlibCompressionOptions& options)
+            const io::ZlibCompressionOptions& options, bool use_mmap)
         : GraphDatasetBase(ctx),
           filenames_(std::move(filenames)),
           compression_type_(compression_type),
           use_compression_(!compression_type.empty()),
-          options_(options) {}
+          options_(options),
+          use_mmap_(use_mmap) {}
 
     std::unique_ptr<IteratorBase> MakeIterator(
         const string& prefix) const override {
@@ -118,8 +124,11 @@ class TextLineDatasetOp : public DatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
       TF_RETURN_IF_ERROR(
           b->AddScalar(options_.input_buffer_size, &buffer_size));
-      TF_RETURN_IF_ERROR(b->AddDataset(
-          this, {filenames, compression_type, buffer_size}, output));
+      AttrValue use_mmap;
+      b->BuildAttrValue(use_mmap_, &use_mmap);
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {filenames, compression_type, buffer_size},
+                        {{"use_mmap", use_mmap}}, output));
       return Status::OK();
     }
 
@@ -134,15 +143,26 @@ class TextLineDatasetOp : public DatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         do {
-          // We are currently processing a file, so try to read the next line.
-          if (buffered_input_stream_) {
-            string line_contents;
-            Status s = buffered_input_stream_->ReadLine(&line_contents);
+          // We are currently processing a mapped file, so try to read the
+          // next line from it.
+          if (mapped_file_) {
+            Tensor line_tensor(cpu_allocator(), DT_STRING, {});
+            if (ReadMappedLineLocked(&line_tensor.scalar<string>()())) {
+              out_tensors->emplace_back(std::move(line_tensor));
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+            ResetStreamsLocked();
+            ++current_file_index_;
+          } else if (buffered_input_stream_) {
+            // We are currently processing a file, so try to read the next
+            // line.
+            Tensor line_tensor(cpu_allocator(), DT_STRING, {});
+            Status s = buffered_input_stream_->ReadLine(
+                &line_tensor.scalar<string>()());
 
             if (s.ok()) {
               // Produce the line as output.
-              Tensor line_tensor(cpu_allocator(), DT_STRING, {});
-              line_tensor.scalar<string>()() = line_contents;
               out_tensors->emplace_back(std::move(line_tensor));
               *end_of_sequence = false;
               return Status::OK();
@@ -172,10 +192,15 @@ class TextLineDatasetOp : public DatasetOpKernel {
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
                                                current_file_index_));
 
-        // `buffered_input_stream_` is empty if
+        // `buffered_input_stream_` and `mapped_file_` are empty if
         // 1. GetNext has not been called even once.
         // 2. All files have been read and iterator has been exhausted.
-        if (buffered_input_stream_) {
+        // Both read positions are offsets into the file, so a checkpoint
+        // can be restored whether or not the file is mapped.
+        if (mapped_file_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name("current_pos"), static_cast<int64>(mapped_pos_)));
+        } else if (buffered_input_stream_) {
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               full_name("current_pos"), buffered_input_stream_->Tell()));
         }
@@ -198,7 +223,17 @@ class TextLineDatasetOp : public DatasetOpKernel {
               reader->ReadScalar(full_name("current_pos"), &current_pos));
 
           TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-          TF_RETURN_IF_ERROR(buffered_input_stream_->Seek(current_pos));
+          if (mapped_file_) {
+            if (current_pos < 0 ||
+                static_cast<uint64>(current_pos) > mapped_file_->length()) {
+              return errors::DataLoss("Invalid position ", current_pos,
+                                      " in file of ", mapped_file_->length(),
+                                      " bytes");
+            }
+            mapped_pos_ = current_pos;
+          } else {
+            TF_RETURN_IF_ERROR(buffered_input_stream_->Seek(current_pos));
+          }
         }
         return Status::OK();
       }
@@ -213,8 +248,23 @@ class TextLineDatasetOp : public DatasetOpKernel {
         }
 
         // Actually move on to next file.
-        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-            dataset()->filenames_[current_file_index_], &file_));
+        const string& filename = dataset()->filenames_[current_file_index_];
+        if (dataset()->use_mmap_ && !dataset()->use_compression_) {
+          // Empty files cannot be mapped, and file systems other than the
+          // local one may not support mapping; both are read as streams.
+          uint64 file_size = 0;
+          TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+          if (file_size > 0) {
+            Status s =
+                env->NewReadOnlyMemoryRegionFromFile(filename, &mapped_file_);
+            if (s.ok()) {
+              mapped_pos_ = 0;
+              return Status::OK();
+            }
+            if (!errors::IsUnimplemented(s)) return s;
+          }
+        }
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
         input_stream_.reset(
             new io::RandomAccessInputStream(file_.get(), false));
 
@@ -233,8 +283,30 @@ class TextLineDatasetOp : public DatasetOpKernel {
         return Status::OK();
       }
 
+      // Reads the line at `mapped_pos_` of `mapped_file_` into `*line`,
+      // following the same rules as `io::BufferedInputStream::ReadLine()`.
+      // Returns false at the end of the file.
+      bool ReadMappedLineLocked(string* line) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const char* data = static_cast<const char*>(mapped_file_->data());
+        const char* begin = data + mapped_pos_;
+        const char* end = data + mapped_file_->length();
+        const char* newline =
+            static_cast<const char*>(memchr(begin, '\n', end - begin));
+        const char* line_end = newline != nullptr ? newline : end;
+        line->clear();
+        io::AppendWithoutCarriageReturns(begin, line_end, line);
+        mapped_pos_ = line_end - data;
+        if (newline != nullptr) {
+          ++mapped_pos_;
+          return true;
+        }
+        return !line->empty();
+      }
+
       // Resets all reader streams.
       void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        mapped_file_.reset();
+        mapped_pos_ = 0;
         input_stream_.reset();
         zlib_input_stream_.reset();
         buffered_input_stream_.reset();
@@ -250,13 +322,19 @@ class TextLineDatasetOp : public DatasetOpKernel {
       size_t current_file_index_ GUARDED_BY(mu_) = 0;
       std::unique_ptr<RandomAccessFile> file_
           GUARDED_BY(mu_);  // must outlive input_stream_
+      // Set instead of the streams above when the current file is mapped.
+      std::unique_ptr<ReadOnlyMemoryRegion> mapped_file_ GUARDED_BY(mu_);
+      uint64 mapped_pos_ GUARDED_BY(mu_) = 0;
     };
 
     const std::vector<string> filenames_;
     const string compression_type_;
     const bool use_compression_;
     const io::ZlibCompressionOptions options_;
+    const bool use_mmap_;
   };
+
+  bool use_mmap_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TextLineDataset").Device(DEVICE_CPU),
@@ -498,7 +576,10 @@ REGISTER_KERNEL_BUILDER(Name("FixedLengthRecordDataset").Device(DEVICE_CPU),
 
 class TFRecordDatasetOp : public DatasetOpKernel {
  public:
-  using DatasetOpKernel::DatasetOpKernel;
+  explicit TFRecordDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("async_io", &async_io_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
     const Tensor* filenames_tensor;
@@ -524,15 +605,16 @@ class TFRecordDatasetOp : public DatasetOpKernel {
                 errors::InvalidArgument(
                     "`buffer_size` must be >= 0 (0 == no buffering)"));
 
-    *output =
-        new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+    *output = new Dataset(ctx, std::move(filenames), compression_type,
+                          buffer_size, async_io_);
   }
 
  private:
   class Dataset : public GraphDatasetBase {
    public:
     explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                     const string& compression_type, int64 buffer_size)
+                     const string& compression_type, int64 buffer_size,
+                     bool async_io)
         : GraphDatasetBase(ctx),
           filenames_(std::move(filenames)),
           compression_type_(compression_type),
@@ -541,6 +623,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
       if (buffer_size > 0) {
         options_.buffer_size = buffer_size;
       }
+      options_.async_io = async_io;
     }
 
     std::unique_ptr<IteratorBase> MakeIterator(
@@ -571,8 +654,11 @@ class TFRecordDatasetOp : public DatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
       Node* buffer_size = nullptr;
       TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-      TF_RETURN_IF_ERROR(b->AddDataset(
-          this, {filenames, compression_type, buffer_size}, output));
+      AttrValue async_io;
+      b->BuildAttrValue(options_.async_io, &async_io);
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {filenames, compression_type, buffer_size},
+                        {{"async_io", async_io}}, output));
       return Status::OK();
     }
 
@@ -682,6 +768,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
     const string compression_type_;
     io::RecordReaderOptions options_;
   };
+
+  bool async_io_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TFRecordDataset").Device(DEVICE_CPU),
@@ -14,14 +14,21 @@ limitations under the License.
 ==============================================================================*/
 
 #include <deque>
+#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 namespace tensorflow {
 
@@ -29,6 +36,177 @@ namespace {
 
 const int64 kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 
+// The size at which `SpillFile` stops appending to a segment and starts a
+// new one.
+const uint64 kSpillSegmentBytes = 64 << 20;  // 64 MB.
+
+// Stores the elements of a shuffle buffer that do not fit within its memory
+// limit in a sequence of local scratch files ("segments").
+//
+// Elements are appended to the current segment, and read back in any order
+// using the `Location` returned when they were written. A segment is deleted
+// once it is full and every element written to it has been released, so the
+// disk space used is proportional to the number of spilled elements that are
+// still buffered.
+//
+// This class is not thread-safe.
+class SpillFile {
+ public:
+  struct Location {
+    int64 segment = -1;
+    uint64 offset = 0;
+    uint64 length = 0;
+  };
+
+  SpillFile(Env* env, const string& directory)
+      : env_(env),
+        prefix_(io::JoinPath(directory, strings::StrCat("shuffle_spill_",
+                                                        random::New64()))) {}
+
+  ~SpillFile() {
+    for (auto& segment : segments_) {
+      DeleteSegment(&segment.second);
+    }
+  }
+
+  // Appends `element` to the current segment and sets `*location` to its
+  // location.
+  Status Write(const std::vector<Tensor>& element, Location* location) {
+    string data;
+    for (const Tensor& t : element) {
+      TensorProto proto;
+      t.AsProtoTensorContent(&proto);
+      string serialized;
+      if (!proto.SerializeToString(&serialized)) {
+        return errors::Internal("Failed to serialize a shuffle buffer element");
+      }
+      core::PutVarint64(&data, serialized.size());
+      data.append(serialized);
+    }
+
+    if (current_ == nullptr || current_->size >= kSpillSegmentBytes) {
+      TF_RETURN_IF_ERROR(StartSegment());
+    }
+    TF_RETURN_IF_ERROR(current_->writer->Append(data));
+    current_->dirty = true;
+    location->segment = current_id_;
+    location->offset = current_->size;
+    location->length = data.size();
+    current_->size += data.size();
+    ++current_->num_live;
+    return Status::OK();
+  }
+
+  // Reads the element stored at `location` into `*element`.
+  Status Read(const Location& location, std::vector<Tensor>* element) {
+    auto it = segments_.find(location.segment);
+    if (it == segments_.end()) {
+      return errors::Internal("Shuffle buffer spill segment ",
+                              location.segment, " does not exist");
+    }
+    Segment* segment = &it->second;
+    if (segment->dirty) {
+      TF_RETURN_IF_ERROR(segment->writer->Flush());
+      segment->dirty = false;
+    }
+    std::unique_ptr<char[]> scratch(new char[location.length]);
+    StringPiece data;
+    TF_RETURN_IF_ERROR(segment->reader->Read(location.offset, location.length,
+                                             &data, scratch.get()));
+    if (data.size() != location.length) {
+      return errors::DataLoss("Truncated shuffle buffer spill file: ",
+                              segment->filename);
+    }
+
+    element->clear();
+    while (!data.empty()) {
+      uint64 size;
+      if (!core::GetVarint64(&data, &size) || size > data.size()) {
+        return errors::DataLoss("Corrupted shuffle buffer spill file: ",
+                                segment->filename);
+      }
+      TensorProto proto;
+      Tensor t;
+      if (!ParseProtoUnlimited(&proto, data.data(), size) ||
+          !t.FromProto(proto)) {
+        return errors::DataLoss("Corrupted shuffle buffer spill file: ",
+                                segment->filename);
+      }
+      element->push_back(std::move(t));
+      data.remove_prefix(size);
+    }
+    return Status::OK();
+  }
+
+  // Releases the element stored at `location`, deleting its segment if no
+  // other live element remains in it.
+  void Release(const Location& location) {
+    auto it = segments_.find(location.segment);
+    if (it == segments_.end()) return;
+    --it->second.num_live;
+    if (it->second.num_live == 0 && &it->second != current_) {
+      DeleteSegment(&it->second);
+      segments_.erase(it);
+    }
+  }
+
+ private:
+  struct Segment {
+    string filename;
+    std::unique_ptr<WritableFile> writer;
+    std::unique_ptr<RandomAccessFile> reader;
+    uint64 size = 0;
+    int64 num_live = 0;
+    bool dirty = false;
+  };
+
+  Status StartSegment() {
+    if (current_ != nullptr && current_->num_live == 0) {
+      DeleteSegment(current_);
+      segments_.erase(current_id_);
+    }
+    current_ = nullptr;
+
+    const int64 id = next_id_++;
+    Segment segment;
+    segment.filename = strings::StrCat(prefix_, "_", id);
+    TF_RETURN_IF_ERROR(
+        env_->NewWritableFile(segment.filename, &segment.writer));
+    TF_RETURN_IF_ERROR(
+        env_->NewRandomAccessFile(segment.filename, &segment.reader));
+    current_ = &(segments_[id] = std::move(segment));
+    current_id_ = id;
+    return Status::OK();
+  }
+
+  void DeleteSegment(Segment* segment) {
+    segment->reader.reset();
+    if (segment->writer) {
+      segment->writer->Close().IgnoreError();
+      segment->writer.reset();
+    }
+    env_->DeleteFile(segment->filename).IgnoreError();
+  }
+
+  Env* const env_;
+  const string prefix_;
+  std::map<int64, Segment> segments_;
+  Segment* current_ = nullptr;
+  int64 current_id_ = -1;
+  int64 next_id_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SpillFile);
+};
+
+// Returns the number of bytes of tensor data in `element`.
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& t : element) {
+    bytes += t.TotalBytes();
+  }
+  return bytes;
+}
+
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
@@ -41,12 +219,19 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
   // Abstract base dataset that implements a shuffling iterator.
   class ShuffleDatasetBase : public GraphDatasetBase {
    public:
+    // If `memory_limit` is positive, elements that would take the total size
+    // of the in-memory buffer above `memory_limit` bytes are spilled to
+    // scratch files in `spill_directory` (or a local temporary directory, if
+    // empty), and read back when they are drawn from the buffer.
     ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                       int64 buffer_size, int64 count)
+                       int64 buffer_size, int64 count, int64 memory_limit = 0,
+                       const string& spill_directory = "")
         : GraphDatasetBase(ctx),
           input_(input),
           buffer_size_(buffer_size),
-          count_(count) {
+          count_(count),
+          memory_limit_(memory_limit),
+          spill_directory_(spill_directory) {
       input_->Ref();
     }
 
@@ -73,6 +258,10 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
             parent_generator_(seed, seed2),
             generator_(&parent_generator_) {
         buffer_.reset(new std::vector<Tensor>[params.dataset->buffer_size_]);
+        if (params.dataset->memory_limit_ > 0) {
+          spill_locations_.reset(
+              new SpillFile::Location[params.dataset->buffer_size_]);
+        }
         slices_.emplace_back(new Slice{0, 0});
       }
 
@@ -117,8 +306,9 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
             input_impl_ = dataset()->input_->MakeIterator(prefix());
           }
           if (!end_of_input_sequence) {
-            buffer_[slices_.back()->end % dataset()->buffer_size_] =
-                std::move(input_element);
+            TF_RETURN_IF_ERROR(StoreElementLocked(
+                ctx->env(), slices_.back()->end % dataset()->buffer_size_,
+                std::move(input_element)));
             num_elements_++;
             slices_.back()->end++;
           } else {
@@ -143,9 +333,9 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               Random() % (slices_.front()->end - slices_.front()->start);
           int64 index =
               (slices_.front()->start + offset) % dataset()->buffer_size_;
-          *out_tensors = std::move(buffer_[index]);
-          std::swap(buffer_[index],
-                    buffer_[slices_.front()->start % dataset()->buffer_size_]);
+          TF_RETURN_IF_ERROR(TakeElementLocked(index, out_tensors));
+          SwapElementsLocked(
+              index, slices_.front()->start % dataset()->buffer_size_);
           slices_.front()->start++;
           num_elements_--;
         } else {
@@ -186,13 +376,20 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               full_name(strings::StrCat("slices_end_", i)), slices_[i]->end));
           for (size_t j = slices_[i]->start; j < slices_[i]->end; ++j) {
             size_t index = j % dataset()->buffer_size_;
+            const std::vector<Tensor>* element = &buffer_[index];
+            std::vector<Tensor> spilled_element;
+            if (IsSpilledLocked(index)) {
+              TF_RETURN_IF_ERROR(spill_file_->Read(spill_locations_[index],
+                                                   &spilled_element));
+              element = &spilled_element;
+            }
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 full_name(strings::StrCat("buffer_", index, "_size")),
-                buffer_[index].size()));
-            for (size_t k = 0; k < buffer_[index].size(); ++k) {
+                element->size()));
+            for (size_t k = 0; k < element->size(); ++k) {
               TF_RETURN_IF_ERROR(writer->WriteTensor(
                   full_name(strings::StrCat("buffer_", index, "_", k)),
-                  buffer_[index][k]));
+                  (*element)[k]));
             }
           }
         }
@@ -229,6 +426,12 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
           slices_size = static_cast<size_t>(temp);
         }
         buffer_.reset(new std::vector<Tensor>[dataset()->buffer_size_]);
+        if (spill_locations_) {
+          spill_locations_.reset(
+              new SpillFile::Location[dataset()->buffer_size_]);
+          spill_file_.reset();
+          buffered_bytes_ = 0;
+        }
         for (size_t i = 0; i < slices_size; ++i) {
           int64 start;
           TF_RETURN_IF_ERROR(reader->ReadScalar(
@@ -243,12 +446,14 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(reader->ReadScalar(
                 full_name(strings::StrCat("buffer_", index, "_size")),
                 &list_size));
-            buffer_[index] = std::vector<Tensor>(list_size);
+            std::vector<Tensor> element(list_size);
             for (int k = 0; k < list_size; ++k) {
               TF_RETURN_IF_ERROR(reader->ReadTensor(
                   full_name(strings::StrCat("buffer_", index, "_", k)),
-                  &buffer_[index][k]));
+                  &element[k]));
             }
+            TF_RETURN_IF_ERROR(
+                StoreElementLocked(ctx->env(), index, std::move(element)));
           }
         }
 
@@ -268,6 +473,65 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
         int64 end;
       };
 
+      bool IsSpilledLocked(int64 index) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return spill_locations_ && spill_locations_[index].segment >= 0;
+      }
+
+      // Stores `element` in slot `index` of the buffer, spilling it to disk
+      // if keeping it in memory would exceed the dataset's memory limit.
+      Status StoreElementLocked(Env* env, int64 index,
+                                std::vector<Tensor> element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_locations_) {
+          const int64 bytes = ElementBytes(element);
+          if (buffered_bytes_ + bytes > dataset()->memory_limit_) {
+            if (!spill_file_) {
+              string directory = dataset()->spill_directory_;
+              if (directory.empty()) {
+                std::vector<string> directories;
+                env->GetLocalTempDirectories(&directories);
+                if (directories.empty()) {
+                  return errors::Unavailable(
+                      "No local temporary directory in which to spill the "
+                      "shuffle buffer");
+                }
+                directory = directories[0];
+              }
+              spill_file_.reset(new SpillFile(env, directory));
+            }
+            return spill_file_->Write(element, &spill_locations_[index]);
+          }
+          buffered_bytes_ += bytes;
+        }
+        buffer_[index] = std::move(element);
+        return Status::OK();
+      }
+
+      // Moves the element in slot `index` of the buffer to `*out_tensors`,
+      // reading it back from disk if it was spilled.
+      Status TakeElementLocked(int64 index, std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (IsSpilledLocked(index)) {
+          TF_RETURN_IF_ERROR(
+              spill_file_->Read(spill_locations_[index], out_tensors));
+          spill_file_->Release(spill_locations_[index]);
+          spill_locations_[index] = SpillFile::Location();
+          return Status::OK();
+        }
+        if (spill_locations_) {
+          buffered_bytes_ -= ElementBytes(buffer_[index]);
+        }
+        *out_tensors = std::move(buffer_[index]);
+        return Status::OK();
+      }
+
+      void SwapElementsLocked(int64 i, int64 j) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::swap(buffer_[i], buffer_[j]);
+        if (spill_locations_) {
+          std::swap(spill_locations_[i], spill_locations_[j]);
+        }
+      }
+
       random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         num_random_samples_++;
@@ -285,6 +549,12 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
 
       mutex mu_;
       std::unique_ptr<std::vector<Tensor>[]> buffer_ GUARDED_BY(mu_);
+      // The following members are only used when the dataset has a memory
+      // limit. `spill_locations_[i]` is the location of the element in slot
+      // `i` of `buffer_` if that element has been spilled to disk.
+      std::unique_ptr<SpillFile::Location[]> spill_locations_ GUARDED_BY(mu_);
+      std::unique_ptr<SpillFile> spill_file_ GUARDED_BY(mu_);
+      int64 buffered_bytes_ GUARDED_BY(mu_) = 0;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
       const int64 seed_ GUARDED_BY(mu_);
       const int64 seed2_ GUARDED_BY(mu_);
@@ -300,6 +570,8 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
     const DatasetBase* const input_;
     const int64 buffer_size_;
     const int64 count_;
+    const int64 memory_limit_;
+    const string spill_directory_;
   };
 };
 
@@ -516,12 +788,334 @@ class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
   };
 };
 
+class SpillingShuffleDatasetOp : public ShuffleDatasetOpBase {
+ public:
+  explicit SpillingShuffleDatasetOp(OpKernelConstruction* ctx)
+      : ShuffleDatasetOpBase(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(
+        ctx, buffer_size > 0,
+        errors::InvalidArgument("buffer_size must be greater than zero."));
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+
+    int64 count;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "count", &count));
+
+    int64 memory_limit;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "memory_limit", &memory_limit));
+    OP_REQUIRES(
+        ctx, memory_limit > 0,
+        errors::InvalidArgument("memory_limit must be greater than zero."));
+
+    string spill_directory;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "spill_directory",
+                                                    &spill_directory));
+
+    // By TensorFlow convention, if both seeds are 0, then shuffling should be
+    // seeded non-deterministically.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, input, buffer_size, seed, seed2, count,
+                          memory_limit, spill_directory);
+  }
+
+ private:
+  class Dataset : public ShuffleDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
+            int64 seed, int64 seed2, int64 count, int64 memory_limit,
+            const string& spill_directory)
+        : ShuffleDatasetBase(ctx, input, buffer_size, count, memory_limit,
+                             spill_directory),
+          seed_(seed),
+          seed2_(seed2) {}
+
+    string DebugString() override {
+      return strings::StrCat("SpillingShuffleDatasetOp(", buffer_size_, ", ",
+                             seed_, ", ", seed2_, ", ", count_, ", ",
+                             memory_limit_, ")::Dataset");
+    }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(new ShuffleDatasetBase::Iterator(
+          {this, strings::StrCat(prefix, "::SpillingShuffle")}, seed_,
+          seed2_));
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* buffer_size = nullptr;
+      Node* seed = nullptr;
+      Node* seed2 = nullptr;
+      Node* count = nullptr;
+      Node* memory_limit = nullptr;
+      Node* spill_directory = nullptr;
+
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      TF_RETURN_IF_ERROR(b->AddScalar(count_, &count));
+      TF_RETURN_IF_ERROR(b->AddScalar(memory_limit_, &memory_limit));
+      TF_RETURN_IF_ERROR(b->AddScalar(spill_directory_, &spill_directory));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {input_graph_node, buffer_size, seed, seed2, count, memory_limit,
+           spill_directory},  // Inputs
+          {},                 // Attrs
+          output));
+      return Status::OK();
+    }
+
+   private:
+    const int64 seed_;
+    const int64 seed2_;
+  };
+};
+
+// Produces a uniformly random permutation of the indices
+// `[0, num_elements)`, `count` times, using a sparse Fisher-Yates shuffle.
+// Only the indices displaced by the shuffle so far are kept in memory, so the
+// full range can be shuffled without buffering any of the elements it
+// indexes.
+class IndexShuffleDatasetOp : public DatasetOpKernel {
+ public:
+  explicit IndexShuffleDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    int64 num_elements;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "num_elements", &num_elements));
+    OP_REQUIRES(
+        ctx, num_elements >= 0,
+        errors::InvalidArgument("num_elements must be non-negative."));
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+
+    int64 count;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "count", &count));
+
+    // By TensorFlow convention, if both seeds are 0, then shuffling should be
+    // seeded non-deterministically.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, num_elements, seed, seed2, count);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, int64 num_elements, int64 seed, int64 seed2,
+            int64 count)
+        : GraphDatasetBase(ctx),
+          num_elements_(num_elements),
+          seed_(seed),
+          seed2_(seed2),
+          count_(count) {}
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::IndexShuffle")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_INT64});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() override {
+      return strings::StrCat("IndexShuffleDatasetOp(", num_elements_, ", ",
+                             seed_, ", ", seed2_, ", ", count_, ")::Dataset");
+    }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* num_elements = nullptr;
+      Node* seed = nullptr;
+      Node* seed2 = nullptr;
+      Node* count = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(num_elements_, &num_elements));
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      TF_RETURN_IF_ERROR(b->AddScalar(count_, &count));
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {num_elements, seed, seed2, count}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            parent_generator_(params.dataset->seed_, params.dataset->seed2_),
+            generator_(&parent_generator_) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        const int64 n = dataset()->num_elements_;
+        if (n > 0 && position_ == n) {
+          // Start a new epoch.
+          ++epoch_;
+          position_ = 0;
+          displaced_.clear();
+        }
+        if (n == 0 ||
+            (dataset()->count_ != -1 && epoch_ >= dataset()->count_)) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        // Swap the index at `position_` with one chosen uniformly at random
+        // from `[position_, n)`, and produce the latter. Slots before
+        // `position_` are never read again, so their entries are dropped.
+        const int64 target = position_ + Random64() % (n - position_);
+        const int64 index = Lookup(target);
+        if (target != position_) {
+          displaced_[target] = Lookup(position_);
+        }
+        displaced_.erase(position_);
+        ++position_;
+
+        Tensor result(cpu_allocator(), DT_INT64, {});
+        result.scalar<int64>()() = index;
+        out_tensors->push_back(std::move(result));
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("num_random_samples"),
+                                               num_random_samples_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("epoch"), epoch_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("position"), position_));
+        Tensor keys(DT_INT64, {static_cast<int64>(displaced_.size())});
+        Tensor values(DT_INT64, {static_cast<int64>(displaced_.size())});
+        int64 i = 0;
+        for (const auto& entry : displaced_) {
+          keys.vec<int64>()(i) = entry.first;
+          values.vec<int64>()(i) = entry.second;
+          ++i;
+        }
+        TF_RETURN_IF_ERROR(writer->WriteTensor(full_name("displaced_keys"),
+                                               keys));
+        TF_RETURN_IF_ERROR(writer->WriteTensor(full_name("displaced_values"),
+                                               values));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("num_random_samples"),
+                                              &num_random_samples_));
+        parent_generator_ = random::PhiloxRandom(dataset()->seed_,
+                                                 dataset()->seed2_);
+        generator_ = random::SingleSampleAdapter<random::PhiloxRandom>(
+            &parent_generator_);
+        generator_.Skip(num_random_samples_);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("epoch"), &epoch_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("position"), &position_));
+        Tensor keys;
+        Tensor values;
+        TF_RETURN_IF_ERROR(
+            reader->ReadTensor(full_name("displaced_keys"), &keys));
+        TF_RETURN_IF_ERROR(
+            reader->ReadTensor(full_name("displaced_values"), &values));
+        if (keys.NumElements() != values.NumElements()) {
+          return errors::DataLoss("Mismatched displaced index checkpoint");
+        }
+        displaced_.clear();
+        for (int64 i = 0; i < keys.NumElements(); ++i) {
+          displaced_[keys.vec<int64>()(i)] = values.vec<int64>()(i);
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Returns the index currently stored in slot `i` of the permutation.
+      int64 Lookup(int64 i) const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        auto it = displaced_.find(i);
+        return it == displaced_.end() ? i : it->second;
+      }
+
+      uint64 Random64() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        num_random_samples_ += 2;
+        const uint64 hi = generator_();
+        const uint64 lo = generator_();
+        return (hi << 32) | lo;
+      }
+
+      mutex mu_;
+      random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+      random::SingleSampleAdapter<random::PhiloxRandom> generator_
+          GUARDED_BY(mu_);
+      int64 num_random_samples_ GUARDED_BY(mu_) = 0;
+      int64 epoch_ GUARDED_BY(mu_) = 0;
+      int64 position_ GUARDED_BY(mu_) = 0;
+      // Maps each slot of the permutation whose index differs from the
+      // identity to the index it currently holds.
+      std::unordered_map<int64, int64> displaced_ GUARDED_BY(mu_);
+    };
+
+    const int64 num_elements_;
+    const int64 seed_;
+    const int64 seed2_;
+    const int64 count_;
+  };
+};
+
 REGISTER_KERNEL_BUILDER(Name("ShuffleDataset").Device(DEVICE_CPU),
                         ShuffleDatasetOp);
 
 REGISTER_KERNEL_BUILDER(Name("ShuffleAndRepeatDataset").Device(DEVICE_CPU),
                         ShuffleAndRepeatDatasetOp);
 
+REGISTER_KERNEL_BUILDER(Name("SpillingShuffleDataset").Device(DEVICE_CPU),
+                        SpillingShuffleDatasetOp);
+
+REGISTER_KERNEL_BUILDER(Name("IndexShuffleDataset").Device(DEVICE_CPU),
+                        IndexShuffleDatasetOp);
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -58,6 +58,21 @@ class QueryConnection {
   // undefined.
   virtual Status GetNext(std::vector<Tensor>* out_tensors,
                          bool* end_of_sequence) = 0;
+
+  // Retrieves up to `batch_size` of the next rows of the result set of the
+  // query from the most recent call to `Open()`.
+  //
+  // If at least one such row exists, then `*out_tensors` will contain one
+  // vector per column, whose length is the number of rows retrieved, and
+  // `false` will be stored in `*end_of_sequence`. Fewer than `batch_size` rows
+  // are retrieved only at the end of the result set.
+  //
+  // If there are no more rows in the result set, then instead `true` will be
+  // stored in `*end_of_sequence`, and the content of `*out_tensors` will be
+  // undefined.
+  virtual Status GetNextBatch(int64 batch_size,
+                              std::vector<Tensor>* out_tensors,
+                              bool* end_of_sequence) = 0;
 };
 
 }  // namespace sql
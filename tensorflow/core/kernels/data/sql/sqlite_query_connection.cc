@@ -44,6 +44,7 @@ Status SqliteQueryConnection::Open(const string& data_source_name,
 
 Status SqliteQueryConnection::Close() {
   stmt_ = SqliteStatement();
+  done_ = false;
   db_->Unref();
   db_ = nullptr;
   return Status::OK();
@@ -51,19 +52,60 @@ Status SqliteQueryConnection::Close() {
 
 Status SqliteQueryConnection::GetNext(std::vector<Tensor>* out_tensors,
                                       bool* end_of_sequence) {
-  if (!stmt_) TF_RETURN_IF_ERROR(PrepareQuery());
-  TF_RETURN_IF_ERROR(stmt_.Step(end_of_sequence));
+  TF_RETURN_IF_ERROR(Step(end_of_sequence));
   if (!*end_of_sequence) {
     for (int i = 0; i < column_count_; i++) {
       DataType dt = output_types_[i];
       Tensor tensor(cpu_allocator(), dt, {});
-      FillTensorWithResultSetEntry(dt, i, &tensor);
+      FillTensorWithResultSetEntry(dt, i, 0, &tensor);
       out_tensors->emplace_back(std::move(tensor));
     }
   }
   return Status::OK();
 }
 
+Status SqliteQueryConnection::GetNextBatch(int64 batch_size,
+                                           std::vector<Tensor>* out_tensors,
+                                           bool* end_of_sequence) {
+  // Each column of the batch is allocated once and filled in place as the
+  // statement is stepped, rather than building a tensor per row and column.
+  std::vector<Tensor> columns;
+  int64 num_rows = 0;
+  while (num_rows < batch_size) {
+    bool end_of_rows = false;
+    TF_RETURN_IF_ERROR(Step(&end_of_rows));
+    if (end_of_rows) break;
+    if (columns.empty()) {
+      columns.reserve(column_count_);
+      for (int i = 0; i < column_count_; i++) {
+        columns.emplace_back(cpu_allocator(), output_types_[i],
+                             TensorShape({batch_size}));
+      }
+    }
+    for (int i = 0; i < column_count_; i++) {
+      FillTensorWithResultSetEntry(output_types_[i], i, num_rows, &columns[i]);
+    }
+    ++num_rows;
+  }
+  *end_of_sequence = num_rows == 0;
+  for (Tensor& column : columns) {
+    out_tensors->emplace_back(num_rows < batch_size ? column.Slice(0, num_rows)
+                                                    : std::move(column));
+  }
+  return Status::OK();
+}
+
+Status SqliteQueryConnection::Step(bool* end_of_sequence) {
+  if (!stmt_) TF_RETURN_IF_ERROR(PrepareQuery());
+  if (done_) {
+    *end_of_sequence = true;
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(stmt_.Step(end_of_sequence));
+  done_ = *end_of_sequence;
+  return Status::OK();
+}
+
 Status SqliteQueryConnection::PrepareQuery() {
   TF_RETURN_IF_ERROR(db_->Prepare(query_, &stmt_));
   int column_count = stmt_.ColumnCount();
@@ -79,14 +121,22 @@ Status SqliteQueryConnection::PrepareQuery() {
 }
 
 void SqliteQueryConnection::FillTensorWithResultSetEntry(
-    const DataType& data_type, int column_index, Tensor* tensor) {
-#define CASE(T, M)                                                 \
-  case DataTypeToEnum<T>::value:                                   \
-    tensor->scalar<T>()() = static_cast<T>(stmt_.M(column_index)); \
+    const DataType& data_type, int column_index, int64 row_index,
+    Tensor* tensor) {
+#define CASE(T, M)                                                           \
+  case DataTypeToEnum<T>::value:                                             \
+    tensor->flat<T>()(row_index) = static_cast<T>(stmt_.M(column_index));    \
     break;
 #define INT_CASE(T) CASE(T, ColumnInt)
 #define DOUBLE_CASE(T) CASE(T, ColumnDouble)
-#define STRING_CASE(T) CASE(T, ColumnString)
+// TEXT and BLOB values are copied straight from SQLite's buffer into the
+// tensor, without materializing an intermediate string.
+#define STRING_CASE(T)                                                       \
+  case DataTypeToEnum<T>::value: {                                           \
+    StringPiece value = stmt_.ColumnStringUnsafe(column_index);              \
+    tensor->flat<T>()(row_index).assign(value.data(), value.size());         \
+    break;                                                                   \
+  }
   switch (data_type) {
     TF_CALL_int8(INT_CASE)
     TF_CALL_uint8(INT_CASE)
@@ -100,7 +150,7 @@ void SqliteQueryConnection::FillTensorWithResultSetEntry(
     TF_CALL_double(DOUBLE_CASE)
     TF_CALL_string(STRING_CASE)
     case DT_BOOL:
-      tensor->scalar<bool>()() = stmt_.ColumnInt(column_index) != 0;
+      tensor->flat<bool>()(row_index) = stmt_.ColumnInt(column_index) != 0;
       break;
       // Error preemptively thrown by SqlDatasetOp::MakeDataset in this case.
     default: {
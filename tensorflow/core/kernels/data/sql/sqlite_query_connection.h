@@ -34,17 +34,26 @@ class SqliteQueryConnection : public QueryConnection {
   Status Close() override;
   Status GetNext(std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) override;
+  Status GetNextBatch(int64 batch_size, std::vector<Tensor>* out_tensors,
+                      bool* end_of_sequence) override;
 
  private:
   // Prepares the query string `query_`.
   Status PrepareQuery();
-  // Fills `tensor` with the column_index_th element of the current row of
-  // `stmt_`.
+  // Advances `stmt_` to the next row of the result set, setting
+  // `*end_of_sequence` to true if there is none.
+  Status Step(bool* end_of_sequence);
+
+  // Sets the `row_index`th element of `tensor` to the column_index_th element
+  // of the current row of `stmt_`.
   void FillTensorWithResultSetEntry(const DataType& data_type, int column_index,
-                                    Tensor* tensor);
+                                    int64 row_index, Tensor* tensor);
   Sqlite* db_ = nullptr;
   SqliteStatement stmt_;
   int column_count_ = 0;
+  // True once `stmt_` has returned every row of the result set. SQLite would
+  // otherwise restart the query if it were stepped again.
+  bool done_ = false;
   string query_;
   DataTypeVector output_types_;
 };
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
@@ -47,6 +48,19 @@ class StatsAggregator {
   virtual void AddToHistogram(const string& name,
                               gtl::ArraySlice<double> values) = 0;
 
+  // Records one call to `GetNext()` on the iterator with the given `prefix`,
+  // which took `latency_usec` microseconds, of which `self_usec` were not
+  // spent in calls to `GetNext()` on its input iterators. Every iterator in a
+  // pipeline calls this method when a `StatsAggregator` is associated with
+  // the pipeline.
+  virtual void RecordGetNext(const string& prefix, uint64 latency_usec,
+                             uint64 self_usec) = 0;
+
+  // Returns a human-readable report of the iterators recorded by
+  // `RecordGetNext()`, which identifies the iterator that most likely bounds
+  // the throughput of the pipeline.
+  virtual string BottleneckReport() = 0;
+
   // Stores a protocol buffer representation of the aggregator state in the
   // given `out_summary`.
   // TODO(mrry): Consider separating this method from the `StatsAggregator`
@@ -14,12 +14,18 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/stats_aggregator.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_op_kernel.h"
 #include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
@@ -38,6 +44,18 @@ class StatsAggregatorImpl : public StatsAggregator {
     }
   }
 
+  void RecordGetNext(const string& prefix, uint64 latency_usec,
+                     uint64 self_usec) override {
+    IteratorStatsShard& shard = ShardFor(prefix);
+    mutex_lock l(shard.mu);
+    IteratorStats& stats = shard.stats[prefix];
+    ++stats.calls;
+    stats.total_latency_usec += latency_usec;
+    stats.total_self_usec += self_usec;
+    stats.latency_usec.Add(static_cast<double>(latency_usec));
+    stats.self_usec.Add(static_cast<double>(self_usec));
+  }
+
   void EncodeToProto(Summary* out_summary) override {
     mutex_lock l(mu_);
     for (const auto& pair : histograms_) {
@@ -49,11 +67,105 @@ class StatsAggregatorImpl : public StatsAggregator {
       histogram.EncodeToProto(value->mutable_histo(),
                               true /* preserve_zero_buckets */);
     }
+    for (IteratorStatsShard& shard : iterator_stats_) {
+      mutex_lock shard_lock(shard.mu);
+      for (const auto& pair : shard.stats) {
+        const string& prefix = pair.first;
+        const IteratorStats& stats = pair.second;
+
+        Summary::Value* latency = out_summary->add_value();
+        latency->set_tag(strings::StrCat(prefix, "::latency"));
+        stats.latency_usec.EncodeToProto(latency->mutable_histo(),
+                                         true /* preserve_zero_buckets */);
+        Summary::Value* self_time = out_summary->add_value();
+        self_time->set_tag(strings::StrCat(prefix, "::self_time"));
+        stats.self_usec.EncodeToProto(self_time->mutable_histo(),
+                                      true /* preserve_zero_buckets */);
+      }
+    }
+  }
+
+  // Ranks the iterators by their total self time. In a synchronous pipeline,
+  // the iterator with the largest self time contributes the most to the time
+  // that it takes to produce each element. Behind an asynchronous iterator,
+  // the producers run concurrently with the consumer, and an upstream
+  // iterator is the bottleneck only if its self time exceeds the time that
+  // the consumer spends waiting, which is reported as the self time of the
+  // asynchronous iterator.
+  string BottleneckReport() override {
+    std::vector<IteratorSummary> ranked;
+    uint64 total_self_usec = 0;
+    for (IteratorStatsShard& shard : iterator_stats_) {
+      mutex_lock shard_lock(shard.mu);
+      for (const auto& pair : shard.stats) {
+        const IteratorStats& stats = pair.second;
+        ranked.push_back({pair.first, stats.calls, stats.total_latency_usec,
+                          stats.total_self_usec,
+                          stats.latency_usec.Percentile(90)});
+        total_self_usec += stats.total_self_usec;
+      }
+    }
+    if (ranked.empty()) {
+      return "No iterator statistics have been recorded.\n";
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const IteratorSummary& a, const IteratorSummary& b) {
+                return a.total_self_usec > b.total_self_usec;
+              });
+
+    string report = strings::StrCat("Bottleneck: ", ranked[0].prefix, "\n");
+    for (const IteratorSummary& summary : ranked) {
+      const double calls = static_cast<double>(summary.calls);
+      strings::Appendf(
+          &report,
+          "%s: %lld calls, mean latency %.1fus (p90 %.1fus), mean self time "
+          "%.1fus, %.1f%% of total self time\n",
+          summary.prefix.c_str(), static_cast<long long>(summary.calls),
+          summary.total_latency_usec / calls, summary.p90_latency_usec,
+          summary.total_self_usec / calls,
+          total_self_usec > 0
+              ? 100.0 * summary.total_self_usec / total_self_usec
+              : 0.0);
+    }
+    return report;
   }
 
  private:
+  // Statistics about the calls to `GetNext()` on one iterator. All times are
+  // in microseconds.
+  struct IteratorStats {
+    int64 calls = 0;
+    uint64 total_latency_usec = 0;
+    uint64 total_self_usec = 0;
+    histogram::Histogram latency_usec;
+    histogram::Histogram self_usec;
+  };
+
+  // Every iterator in a pipeline records each element, so the per-iterator
+  // statistics are sharded by prefix to keep the iterators of a pipeline
+  // from contending on a single lock.
+  static constexpr int kNumIteratorStatsShards = 16;
+  struct IteratorStatsShard {
+    mutex mu;
+    std::unordered_map<string, IteratorStats> stats GUARDED_BY(mu);
+  };
+
+  // The part of `IteratorStats` that `BottleneckReport()` uses.
+  struct IteratorSummary {
+    string prefix;
+    int64 calls;
+    uint64 total_latency_usec;
+    uint64 total_self_usec;
+    double p90_latency_usec;
+  };
+
+  IteratorStatsShard& ShardFor(const string& prefix) {
+    return iterator_stats_[Hash64(prefix) % kNumIteratorStatsShards];
+  }
+
   mutex mu_;
   std::unordered_map<string, histogram::Histogram> histograms_ GUARDED_BY(mu_);
+  IteratorStatsShard iterator_stats_[kNumIteratorStatsShards];
   TF_DISALLOW_COPY_AND_ASSIGN(StatsAggregatorImpl);
 };
 
@@ -99,10 +211,35 @@ class StatsAggregatorSummaryOp : public OpKernel {
   }
 };
 
+class StatsAggregatorBottleneckReportOp : public OpKernel {
+ public:
+  explicit StatsAggregatorBottleneckReportOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& resource_handle_t = ctx->input(0);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(resource_handle_t.shape()),
+                errors::InvalidArgument("resource_handle must be a scalar"));
+
+    StatsAggregatorResource* resource;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 0), &resource));
+    core::ScopedUnref unref_iterator(resource);
+
+    Tensor* report_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &report_t));
+    report_t->scalar<string>()() =
+        resource->stats_aggregator()->BottleneckReport();
+  }
+};
+
 REGISTER_KERNEL_BUILDER(Name("StatsAggregatorHandle").Device(DEVICE_CPU),
                         StatsAggregatorHandleOp);
 REGISTER_KERNEL_BUILDER(Name("StatsAggregatorSummary").Device(DEVICE_CPU),
                         StatsAggregatorSummaryOp);
+REGISTER_KERNEL_BUILDER(
+    Name("StatsAggregatorBottleneckReport").Device(DEVICE_CPU),
+    StatsAggregatorBottleneckReportOp);
 
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,355 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtN };
+
+Status ParseCombiner(const string& combiner, Combiner* result) {
+  if (combiner == "sum") {
+    *result = Combiner::kSum;
+  } else if (combiner == "mean") {
+    *result = Combiner::kMean;
+  } else if (combiner == "sqrtn") {
+    *result = Combiner::kSqrtN;
+  } else {
+    return errors::InvalidArgument("Unsupported combiner: ", combiner);
+  }
+  return Status::OK();
+}
+
+// The ids of one output row: ids[begin, end) all have segment id `segment`.
+struct Segment {
+  int32 segment;
+  int64 begin;
+  int64 end;
+};
+
+// Validates the `ids`, `segment_ids` and `weights` inputs shared by the
+// forward and gradient kernels, and splits the ids into runs of equal
+// segment ids. `num_params` is the number of rows of the embedding matrix, or
+// -1 if ids are not checked against it. The ids are copied once into
+// `ids_copy`, and the kernels must only read that copy, since the input
+// tensor may change while it is being read.
+template <typename Tidx>
+Status GetSegments(const Tensor& ids, const Tensor& segment_ids,
+                   const Tensor& weights, int64 num_params,
+                   std::vector<Tidx>* ids_copy,
+                   std::vector<Segment>* segments) {
+  if (!TensorShapeUtils::IsVector(ids.shape())) {
+    return errors::InvalidArgument("ids should be a vector, got shape ",
+                                   ids.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(segment_ids.shape())) {
+    return errors::InvalidArgument("segment_ids should be a vector, got shape ",
+                                   segment_ids.shape().DebugString());
+  }
+  const int64 num_ids = ids.NumElements();
+  if (segment_ids.NumElements() != num_ids) {
+    return errors::InvalidArgument(
+        "segment_ids and ids should have same size, got ",
+        segment_ids.NumElements(), " and ", num_ids);
+  }
+  if (!TensorShapeUtils::IsVector(weights.shape()) ||
+      (weights.NumElements() != 0 && weights.NumElements() != num_ids)) {
+    return errors::InvalidArgument(
+        "weights should be empty or a vector of the same size as ids, got "
+        "shape ",
+        weights.shape().DebugString());
+  }
+
+  const auto ids_vec = ids.vec<Tidx>();
+  const auto segment_vec = segment_ids.vec<int32>();
+  ids_copy->resize(num_ids);
+  segments->clear();
+  for (int64 i = 0; i < num_ids; ++i) {
+    const int32 segment = internal::SubtleMustCopy(segment_vec(i));
+    if (segments->empty() || segments->back().segment != segment) {
+      if (segment < 0) {
+        return errors::InvalidArgument("segment ids must be >= 0, got ",
+                                       segment);
+      }
+      if (!segments->empty() && segments->back().segment > segment) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+      segments->push_back({segment, i, i});
+    }
+    ++segments->back().end;
+    const Tidx id = internal::SubtleMustCopy(ids_vec(i));
+    (*ids_copy)[i] = id;
+    if (num_params >= 0) {
+      if (!FastBoundsCheck(id, num_params)) {
+        return errors::InvalidArgument("ids[", i, "] = ", id,
+                                       " is not in [0, ", num_params, ")");
+      }
+    }
+  }
+  return Status::OK();
+}
+
+// Returns the factor that the weighted sum of the embeddings of `segment` is
+// multiplied by.
+template <typename T>
+T SegmentScale(Combiner combiner, const Segment& segment,
+               const T* weights_data) {
+  if (combiner == Combiner::kSum) return T(1);
+  T total(0);
+  for (int64 i = segment.begin; i < segment.end; ++i) {
+    const T w = weights_data != nullptr ? weights_data[i] : T(1);
+    total += combiner == Combiner::kMean ? w : w * w;
+  }
+  return combiner == Combiner::kMean ? T(1) / total
+                                     : T(1) / std::sqrt(total);
+}
+
+}  // namespace
+
+template <typename T, typename Tidx>
+class FusedEmbeddingLookupSparseOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    string combiner;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(ctx, ParseCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& params = ctx->input(0);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& segment_ids = ctx->input(2);
+    const Tensor& weights = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+                errors::InvalidArgument(
+                    "params must be at least 1 dimensional, got shape ",
+                    params.shape().DebugString()));
+
+    std::vector<Tidx> ids_copy;
+    std::vector<Segment> segments;
+    OP_REQUIRES_OK(ctx,
+                   GetSegments<Tidx>(ids, segment_ids, weights,
+                                     params.dim_size(0), &ids_copy, &segments));
+
+    const int64 num_rows = segments.empty() ? 0 : segments.back().segment + 1;
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_rows);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    if (num_rows == 0) return;
+
+    const auto params_flat = params.flat_outer_dims<T>();
+    auto output_flat = output->flat_outer_dims<T>();
+    const int64 dim = params_flat.dimension(1);
+    const T* params_data = params_flat.data();
+    T* output_data = output_flat.data();
+    const Tidx* ids_data = ids_copy.data();
+    const T* weights_data =
+        weights.NumElements() > 0 ? weights.vec<T>().data() : nullptr;
+    const Combiner combiner = combiner_;
+
+    // Each output row is written by exactly one shard: the rows of a
+    // segment's combined embedding and of any empty segments before it.
+    auto work = [&](int64 start, int64 end) {
+      for (int64 s = start; s < end; ++s) {
+        const Segment& segment = segments[s];
+        const int64 first_row = s > 0 ? segments[s - 1].segment + 1 : 0;
+        std::fill(output_data + first_row * dim,
+                  output_data + segment.segment * dim, T(0));
+        T* out = output_data + segment.segment * dim;
+        for (int64 i = segment.begin; i < segment.end; ++i) {
+          if (i + 1 < segment.end) {
+            port::prefetch<port::PREFETCH_HINT_T0>(params_data +
+                                                   ids_data[i + 1] * dim);
+          }
+          const T* row = params_data + ids_data[i] * dim;
+          const T w = weights_data != nullptr ? weights_data[i] : T(1);
+          if (i == segment.begin) {
+            for (int64 d = 0; d < dim; ++d) out[d] = w * row[d];
+          } else {
+            for (int64 d = 0; d < dim; ++d) out[d] += w * row[d];
+          }
+        }
+        const T scale = SegmentScale(combiner, segment, weights_data);
+        if (combiner != Combiner::kSum) {
+          for (int64 d = 0; d < dim; ++d) out[d] *= scale;
+        }
+      }
+    };
+    const int64 ids_per_segment =
+        std::max<int64>(1, ids.NumElements() / segments.size());
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          segments.size(), ids_per_segment * dim * 2, work);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+template <typename T, typename Tidx>
+class FusedEmbeddingLookupSparseGradOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseGradOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    string combiner;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(ctx, ParseCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& grad = ctx->input(0);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& segment_ids = ctx->input(2);
+    const Tensor& weights = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVectorOrHigher(grad.shape()),
+                errors::InvalidArgument("grad must be at least 1 dimensional"));
+
+    std::vector<Tidx> ids_copy;
+    std::vector<Segment> segments;
+    OP_REQUIRES_OK(ctx, GetSegments<Tidx>(ids, segment_ids, weights, -1,
+                                          &ids_copy, &segments));
+    const int64 num_rows = segments.empty() ? 0 : segments.back().segment + 1;
+    OP_REQUIRES(ctx, grad.dim_size(0) == num_rows,
+                errors::InvalidArgument("grad has ", grad.dim_size(0),
+                                        " rows, expected ", num_rows));
+
+    // Group the occurrences of each distinct id, in order of first
+    // occurrence, so that each row of the result is computed by one shard.
+    const int64 num_ids = ids.NumElements();
+    gtl::FlatMap<Tidx, int64> unique_index(num_ids);
+    std::vector<int64> unique_of_id(num_ids);
+    std::vector<int64> unique_counts;
+    for (int64 i = 0; i < num_ids; ++i) {
+      auto inserted = unique_index.insert({ids_copy[i], unique_counts.size()});
+      if (inserted.second) unique_counts.push_back(0);
+      unique_of_id[i] = inserted.first->second;
+      ++unique_counts[unique_of_id[i]];
+    }
+    const int64 num_unique = unique_counts.size();
+    const int64 num_segments = segments.size();
+    std::vector<int64> occurrence_start(num_unique + 1, 0);
+    for (int64 u = 0; u < num_unique; ++u) {
+      occurrence_start[u + 1] = occurrence_start[u] + unique_counts[u];
+    }
+    std::vector<int64> occurrences(num_ids);
+    std::vector<int64> segment_of_id(num_ids);
+    for (int64 s = 0; s < num_segments; ++s) {
+      for (int64 i = segments[s].begin; i < segments[s].end; ++i) {
+        segment_of_id[i] = s;
+      }
+    }
+    {
+      std::vector<int64> next(occurrence_start.begin(),
+                              occurrence_start.end() - 1);
+      for (int64 i = 0; i < num_ids; ++i) {
+        occurrences[next[unique_of_id[i]]++] = i;
+      }
+    }
+
+    TensorShape values_shape = grad.shape();
+    values_shape.set_dim(0, num_unique);
+    Tensor* values = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, values_shape, &values));
+    Tensor* unique_ids = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({num_unique}),
+                                             &unique_ids));
+    auto unique_ids_vec = unique_ids->vec<Tidx>();
+    for (const auto& entry : unique_index) {
+      unique_ids_vec(entry.second) = entry.first;
+    }
+    if (num_unique == 0) return;
+
+    const T* weights_data =
+        weights.NumElements() > 0 ? weights.vec<T>().data() : nullptr;
+    const Combiner combiner = combiner_;
+    std::vector<T> scales(num_segments);
+    for (int64 s = 0; s < num_segments; ++s) {
+      scales[s] = SegmentScale(combiner, segments[s], weights_data);
+    }
+
+    const auto grad_flat = grad.flat_outer_dims<T>();
+    auto values_flat = values->flat_outer_dims<T>();
+    const int64 dim = grad_flat.dimension(1);
+    const T* grad_data = grad_flat.data();
+    T* values_data = values_flat.data();
+    auto work = [&](int64 start, int64 end) {
+      for (int64 u = start; u < end; ++u) {
+        T* out = values_data + u * dim;
+        for (int64 k = occurrence_start[u]; k < occurrence_start[u + 1]; ++k) {
+          const int64 i = occurrences[k];
+          const int64 s = segment_of_id[i];
+          const T w = weights_data != nullptr ? weights_data[i] : T(1);
+          const T factor = w * scales[s];
+          const T* g = grad_data + segments[s].segment * dim;
+          if (k == occurrence_start[u]) {
+            for (int64 d = 0; d < dim; ++d) out[d] = factor * g[d];
+          } else {
+            for (int64 d = 0; d < dim; ++d) out[d] += factor * g[d];
+          }
+        }
+      }
+    };
+    const int64 ids_per_unique = std::max<int64>(1, num_ids / num_unique);
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_unique,
+          ids_per_unique * dim * 2, work);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+#define REGISTER_KERNELS(type, index_type)                                   \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparse")                 \
+                              .Device(DEVICE_CPU)                            \
+                              .TypeConstraint<type>("T")                     \
+                              .TypeConstraint<index_type>("Tidx"),           \
+                          FusedEmbeddingLookupSparseOp<type, index_type>);   \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparseGrad")             \
+                              .Device(DEVICE_CPU)                            \
+                              .TypeConstraint<type>("T")                     \
+                              .TypeConstraint<index_type>("Tidx"),           \
+                          FusedEmbeddingLookupSparseGradOp<type, index_type>);
+
+#define REGISTER_CPU_KERNELS(type)                                           \
+  REGISTER_KERNELS(type, int32);                                             \
+  REGISTER_KERNELS(type, int64);
+
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,175 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedEmbeddingLookupSparseOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op, const string& combiner) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", op)
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("combiner", combiner)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Adds a [4, 2] embedding matrix whose row i is {i, 10 * i}.
+  void AddParams() {
+    AddInputFromArray<float>(TensorShape({4, 2}), {0, 0, 1, 10, 2, 20, 3, 30});
+  }
+};
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, Sum) {
+  MakeOp("FusedEmbeddingLookupSparse", "sum");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({4}), {1, 3, 2, 1});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 2, 2});
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 0.5, 4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Row 1 has no ids and is zero.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {7, 70, 0, 0, 5, 50});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, Mean) {
+  MakeOp("FusedEmbeddingLookupSparse", "mean");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({3}), {1, 3, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  AddInputFromArray<float>(TensorShape({3}), {1, 3, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {2.5, 25, 2, 20});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, SqrtNUnweighted) {
+  MakeOp("FusedEmbeddingLookupSparse", "sqrtn");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({4}), {0, 1, 2, 3});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 0, 0});
+  AddInputFromArray<float>(TensorShape({0}), {});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2}));
+  test::FillValues<float>(&expected, {3, 30});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, InvalidInputs) {
+  MakeOp("FusedEmbeddingLookupSparse", "sum");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({2}), {1, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  AddInputFromArray<float>(TensorShape({0}), {});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("is not in [0, 4)")) << s;
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, UnsortedSegments) {
+  MakeOp("FusedEmbeddingLookupSparse", "sum");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  AddInputFromArray<float>(TensorShape({0}), {});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString()).contains("not increasing")) << s;
+}
+
+TEST_F(FusedEmbeddingLookupSparseOpTest, Grad) {
+  MakeOp("FusedEmbeddingLookupSparseGrad", "mean");
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 10, 20});
+  AddInputFromArray<int64>(TensorShape({4}), {3, 1, 3, 0});
+  AddInputFromArray<int32>(TensorShape({4}), {0, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({4}), {1, 3, 2, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Id 3 gets 1/4 of the gradient of row 0 and 1/2 of that of row 1.
+  Tensor expected_values(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected_values, {5.25, 10.5, 0.75, 1.5, 5, 10});
+  test::ExpectTensorNear<float>(expected_values, *GetOutput(0), 1e-5);
+  Tensor expected_ids(allocator(), DT_INT64, TensorShape({3}));
+  test::FillValues<int64>(&expected_ids, {3, 1, 0});
+  test::ExpectTensorEqual<int64>(expected_ids, *GetOutput(1));
+}
+
+static Graph* EmbeddingLookupSparse(int vocab, int dim, int batch,
+                                    int ids_per_example) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor params(DT_FLOAT, TensorShape({vocab, dim}));
+  params.flat<float>().setRandom();
+  const int num_ids = batch * ids_per_example;
+  Tensor ids(DT_INT64, TensorShape({num_ids}));
+  Tensor segment_ids(DT_INT32, TensorShape({num_ids}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_ids; ++i) {
+    ids.vec<int64>()(i) = rnd.Uniform(vocab);
+    segment_ids.vec<int32>()(i) = i / ids_per_example;
+  }
+  Tensor weights(DT_FLOAT, TensorShape({num_ids}));
+  weights.flat<float>().setRandom();
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "FusedEmbeddingLookupSparse")
+                  .Input(test::graph::Constant(g, params))
+                  .Input(test::graph::Constant(g, ids))
+                  .Input(test::graph::Constant(g, segment_ids))
+                  .Input(test::graph::Constant(g, weights))
+                  .Attr("combiner", "mean")
+                  .Finalize(g, &node));
+  return g;
+}
+
+#define BM_EMBEDDING_LOOKUP_SPARSE(VOCAB, DIM, BATCH, IDS)                   \
+  static void BM_EmbeddingLookupSparse_##VOCAB##_##DIM##_##BATCH##_##IDS(    \
+      int iters) {                                                           \
+    testing::ItemsProcessed(static_cast<int64>(iters) * BATCH * IDS);        \
+    testing::BytesProcessed(static_cast<int64>(iters) * BATCH * IDS * DIM *  \
+                            sizeof(float));                                  \
+    test::Benchmark("cpu", EmbeddingLookupSparse(VOCAB, DIM, BATCH, IDS))    \
+        .Run(iters);                                                         \
+  }                                                                          \
+  BENCHMARK(BM_EmbeddingLookupSparse_##VOCAB##_##DIM##_##BATCH##_##IDS);
+
+BM_EMBEDDING_LOOKUP_SPARSE(100000, 16, 512, 20);
+BM_EMBEDDING_LOOKUP_SPARSE(100000, 64, 512, 20);
+BM_EMBEDDING_LOOKUP_SPARSE(100000, 256, 512, 20);
+BM_EMBEDDING_LOOKUP_SPARSE(1000000, 64, 1024, 50);
+
+}  // namespace
+}  // namespace tensorflow
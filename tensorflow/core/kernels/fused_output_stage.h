@@ -0,0 +1,161 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_OUTPUT_STAGE_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_OUTPUT_STAGE_H_
+
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// The elementwise tail of the fused contraction kernels (_FusedConv2D and
+// _FusedMatMul). The contraction writes its result to the output tensor, and
+// the stage then adds a per-channel bias, or applies an inference-mode batch
+// normalization, and an optional Relu or Relu6 in a single pass over it.
+//
+// The stage is configured from the "fused_ops", "num_args" and "epsilon"
+// attrs. The supported "fused_ops" values are:
+//   ["BiasAdd"]                  args: bias
+//   ["FusedBatchNorm"]           args: scale, offset, mean, variance
+// each optionally followed by "Relu" or "Relu6". All args are vectors with
+// one element per output channel, i.e. per element of the innermost output
+// dimension.
+class FusedOutputStage {
+ public:
+  enum Activation { kNone, kRelu, kRelu6 };
+
+  Status Init(OpKernelConstruction* ctx) {
+    std::vector<string> fused_ops;
+    TF_RETURN_IF_ERROR(ctx->GetAttr("fused_ops", &fused_ops));
+    TF_RETURN_IF_ERROR(ctx->GetAttr("num_args", &num_args_));
+    TF_RETURN_IF_ERROR(ctx->GetAttr("epsilon", &epsilon_));
+
+    bool valid = !fused_ops.empty() && fused_ops.size() <= 2;
+    if (valid) {
+      if (fused_ops[0] == "BiasAdd") {
+        batch_norm_ = false;
+      } else if (fused_ops[0] == "FusedBatchNorm") {
+        batch_norm_ = true;
+      } else {
+        valid = false;
+      }
+    }
+    activation_ = kNone;
+    if (valid && fused_ops.size() == 2) {
+      if (fused_ops[1] == "Relu") {
+        activation_ = kRelu;
+      } else if (fused_ops[1] == "Relu6") {
+        activation_ = kRelu6;
+      } else {
+        valid = false;
+      }
+    }
+    if (!valid) {
+      return errors::Unimplemented("Unsupported fusion: [",
+                                   str_util::Join(fused_ops, ","), "]");
+    }
+    const int expected_args = batch_norm_ ? 4 : 1;
+    if (num_args_ != expected_args) {
+      return errors::InvalidArgument("Fusion [", str_util::Join(fused_ops, ","),
+                                     "] expects ", expected_args,
+                                     " args, got ", num_args_);
+    }
+    return Status::OK();
+  }
+
+  // Applies the stage in place to 'output', whose innermost dimension holds
+  // the channels. The args are the op inputs starting at 'first_arg'.
+  template <typename T>
+  void Apply(OpKernelContext* ctx, int first_arg, Tensor* output) const {
+    OP_REQUIRES(ctx, output->dims() >= 1,
+                errors::InvalidArgument("Fused output must have rank >= 1"));
+    const int64 channels = output->dim_size(output->dims() - 1);
+    for (int i = first_arg; i < first_arg + num_args_; ++i) {
+      const Tensor& arg = ctx->input(i);
+      OP_REQUIRES(ctx,
+                  TensorShapeUtils::IsVector(arg.shape()) &&
+                      arg.NumElements() == channels,
+                  errors::InvalidArgument(
+                      "Fused arg ", i - first_arg, " must be a vector of ",
+                      channels, " elements, got shape ",
+                      arg.shape().DebugString()));
+    }
+    if (output->NumElements() == 0) return;
+
+    typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+    typedef Eigen::Map<const Array> ConstArrayMap;
+    Array scale;
+    Array offset;
+    if (batch_norm_) {
+      // Fold the normalization into a per-channel multiply-add:
+      //   (x - mean) * rsqrt(variance + epsilon) * scale + offset
+      //   = x * scale' + (offset - mean * scale')
+      ConstArrayMap bn_scale(ctx->input(first_arg).flat<T>().data(), channels);
+      ConstArrayMap bn_offset(ctx->input(first_arg + 1).flat<T>().data(),
+                              channels);
+      ConstArrayMap mean(ctx->input(first_arg + 2).flat<T>().data(), channels);
+      ConstArrayMap variance(ctx->input(first_arg + 3).flat<T>().data(),
+                             channels);
+      scale = bn_scale * (variance + static_cast<T>(epsilon_)).rsqrt();
+      offset = bn_offset - mean * scale;
+    } else {
+      offset = ConstArrayMap(ctx->input(first_arg).flat<T>().data(), channels);
+    }
+
+    T* data = output->flat<T>().data();
+    const bool batch_norm = batch_norm_;
+    const Activation activation = activation_;
+    auto work = [data, channels, batch_norm, activation, &scale, &offset](
+                    int64 begin, int64 end) {
+      for (int64 r = begin; r < end; ++r) {
+        Eigen::Map<Array> row(data + r * channels, channels);
+        // Each row fits in L1, so the activation re-reads cached data.
+        if (batch_norm) {
+          row = row * scale + offset;
+        } else {
+          row += offset;
+        }
+        if (activation == kRelu) {
+          row = row.max(static_cast<T>(0));
+        } else if (activation == kRelu6) {
+          row = row.max(static_cast<T>(0)).min(static_cast<T>(6));
+        }
+      }
+    };
+    const int64 rows = output->NumElements() / channels;
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, rows,
+          channels * (batch_norm_ ? 3 : 2), work);
+  }
+
+ private:
+  int num_args_ = 0;
+  float epsilon_ = 0;
+  bool batch_norm_ = false;
+  Activation activation_ = kNone;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_OUTPUT_STAGE_H_
@@ -31,76 +31,171 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 
 namespace functor {
 
-// Helper method to copy using memcpy.
-template <typename T, typename Index, typename SliceIndex,
-          SliceIndex static_slice_elems>
+// Gathered rows larger than this are copied in chunks of at most this many
+// bytes, so that a few very large rows are still spread over all threads.
+constexpr int64 kGatherChunkBytes = 64 << 10;
+
+// The gather loop prefetches the row this many bytes ahead of the one it is
+// copying, counted in whole rows and limited to kGatherMaxPrefetchRows rows.
+constexpr int64 kGatherPrefetchBytes = 4 << 10;
+constexpr int64 kGatherMaxPrefetchRows = 16;
+
+// Rows up to this size are prefetched in full. Only the start of larger rows
+// is prefetched; the hardware prefetcher follows the rest of the copy.
+constexpr int64 kGatherMaxPrefetchRowBytes = 256;
+constexpr int64 kGatherCacheLineBytes = 64;
+
+// The estimated cost of finding and checking one row, in addition to one
+// unit of cost per byte copied.
+constexpr int64 kGatherRowCost = 64;
+
+// Gathers rows of `slice_bytes` bytes for types that can be copied with
+// memcpy. The loop does not depend on the element type, so it is only
+// instantiated once per index type and static row size. If
+// `static_slice_bytes` is non-negative it must equal `slice_bytes`, which
+// lets the compiler emit a fixed-size copy.
+//
+// Returns the position in `indices` of an index that is out of range, or -1
+// if all indices are valid.
+template <typename Index, int64 static_slice_bytes>
+int64 HandleCopiesBytes(OpKernelContext* ctx, const char* params_base,
+                        int64 batch_size, int64 limit,
+                        typename TTypes<Index>::ConstFlat indices,
+                        int64 slice_bytes, char* out_base) {
+  if (static_slice_bytes >= 0) {
+    // Give compiler static knowledge of the number of bytes
+    slice_bytes = static_slice_bytes;
+  }
+  const int64 indices_size = indices.dimension(0);
+  const int64 num_rows = batch_size * indices_size;
+  const Index* indices_data = indices.data();
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  mutex mu;
+  // Store the value of invalidate index for printing error information, it's
+  // a shared variable.
+  int64 result = -1;
+
+  if (slice_bytes > kGatherChunkBytes) {
+    // Large rows are streamed by memcpy and need no prefetching, but are
+    // split into chunks so that work is balanced by bytes.
+    const int64 chunks_per_row =
+        (slice_bytes + kGatherChunkBytes - 1) / kGatherChunkBytes;
+    const int64 chunk_bytes =
+        (slice_bytes + chunks_per_row - 1) / chunks_per_row;
+    auto work = [&](int64 start, int64 end) {
+      for (int64 unit = start; unit < end; ++unit) {
+        const int64 row = unit / chunks_per_row;
+        const int64 offset = (unit % chunks_per_row) * chunk_bytes;
+        const int64 batch_idx = row / indices_size;
+        const int64 indices_idx = row % indices_size;
+        const Index index =
+            internal::SubtleMustCopy(indices_data[indices_idx]);
+        if (!FastBoundsCheck(index, limit)) {
+          mutex_lock l(mu);
+          result = indices_idx;
+          return;
+        }
+        memcpy(out_base + row * slice_bytes + offset,
+               params_base + (batch_idx * limit + index) * slice_bytes + offset,
+               std::min(chunk_bytes, slice_bytes - offset));
+      }
+    };
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_rows * chunks_per_row, kGatherRowCost + chunk_bytes, work);
+    return result;
+  }
+
+  const int64 prefetch_rows = std::max<int64>(
+      1, std::min(kGatherMaxPrefetchRows,
+                  kGatherPrefetchBytes / std::max<int64>(slice_bytes, 1)));
+  const int64 prefetch_bytes =
+      std::min(slice_bytes, kGatherMaxPrefetchRowBytes);
+  auto work = [&](int64 start, int64 end) {
+    int64 batch_idx = start / indices_size;
+    int64 indices_idx = start % indices_size;
+    // The row `prefetch_rows` ahead of the current one.
+    int64 ahead_batch_idx = batch_idx;
+    int64 ahead_indices_idx = indices_idx;
+    int64 ahead_row = std::min(start + prefetch_rows, end);
+    for (int64 i = start; i < ahead_row; ++i) {
+      if (++ahead_indices_idx == indices_size) {
+        ahead_indices_idx = 0;
+        ++ahead_batch_idx;
+      }
+    }
+
+    for (int64 row = start; row < end; ++row) {
+      if (ahead_row < end) {
+        const Index ahead_index = indices_data[ahead_indices_idx];
+        if (FastBoundsCheck(ahead_index, limit)) {
+          const char* ahead = params_base + (ahead_batch_idx * limit +
+                                             ahead_index) * slice_bytes;
+          for (int64 b = 0; b < prefetch_bytes; b += kGatherCacheLineBytes) {
+            port::prefetch<port::PREFETCH_HINT_T0>(ahead + b);
+          }
+        }
+        ++ahead_row;
+        if (++ahead_indices_idx == indices_size) {
+          ahead_indices_idx = 0;
+          ++ahead_batch_idx;
+        }
+      }
+
+      const Index index = internal::SubtleMustCopy(indices_data[indices_idx]);
+      if (!FastBoundsCheck(index, limit)) {
+        mutex_lock l(mu);
+        result = indices_idx;
+        return;
+      }
+      memcpy(out_base + row * slice_bytes,
+             params_base + (batch_idx * limit + index) * slice_bytes,
+             slice_bytes);
+      if (++indices_idx == indices_size) {
+        indices_idx = 0;
+        ++batch_idx;
+      }
+    }
+  };
+
+  Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+        kGatherRowCost + slice_bytes, work);
+  return result;
+}
+
+// Helper method to copy types that cannot be copied with memcpy (e.g.
+// strings), using an Eigen loop.
+template <typename T, typename Index, typename SliceIndex>
 SliceIndex HandleCopies(OpKernelContext* ctx,
                         typename TTypes<T, 3>::ConstTensor params,
                         typename TTypes<Index>::ConstFlat indices,
-                        SliceIndex slice_elems,
                         typename TTypes<T, 3>::Tensor out) {
   const SliceIndex indices_size = static_cast<SliceIndex>(indices.dimension(0));
   const SliceIndex batch_size = static_cast<SliceIndex>(params.dimension(0));
   const Index limit = static_cast<Index>(params.dimension(1));
-  T* out_base = &out(0, 0, 0);
-  const T* params_base = &params(0, 0, 0);
-  if (static_slice_elems >= 0) {
-    // Give compiler static knowledge of the number of elements/bytes
-    slice_elems = static_slice_elems;
-  }
-  // Compute slice_bytes here so that static knowledge is available
-  const size_t slice_bytes = slice_elems * sizeof(T);
+  const SliceIndex slice_elems = static_cast<SliceIndex>(out.dimension(2));
   auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
   mutex mu;
-  // Store the value of invalidate index for printing error information, it's a shared variable.
+  // Store the value of invalidate index for printing error information, it's
+  // a shared variable.
   SliceIndex result = -1;
-  auto work = [&] (int64 start, int64 end) {
-    SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
-    SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
-    SliceIndex batch_idx_end = static_cast<SliceIndex>(end / indices_size);
-    SliceIndex indices_idx_end = static_cast<SliceIndex>(end % indices_size);
-
-    while ((batch_idx < batch_idx_end) ||
-            (batch_idx == batch_idx_end && indices_idx < indices_idx_end)) {
-      SliceIndex i_next = indices_idx + 1;
-      SliceIndex b_next = batch_idx + 1;
-      if ((batch_idx == batch_idx_end && i_next < indices_idx_end) ||
-              (i_next < indices_size)) {
-        port::prefetch<port::PREFETCH_HINT_T0>(&params(batch_idx, indices(i_next), 0));
-        port::prefetch<port::PREFETCH_HINT_T0>(&out(batch_idx, i_next, 0));
-        b_next = batch_idx;
-      } else if (b_next <= batch_idx_end) {
-        port::prefetch<port::PREFETCH_HINT_T0>(&params(b_next, indices(0), 0));
-        port::prefetch<port::PREFETCH_HINT_T0>(&out(b_next, 0, 0));
-        i_next = 0;
-      }
+  auto work = [&](int64 start, int64 end) {
+    for (int64 row = start; row < end; ++row) {
+      const SliceIndex batch_idx = static_cast<SliceIndex>(row / indices_size);
+      const SliceIndex indices_idx =
+          static_cast<SliceIndex>(row % indices_size);
       const Index index = internal::SubtleMustCopy(indices(indices_idx));
       if (!FastBoundsCheck(index, limit)) {
         mutex_lock l(mu);
         result = indices_idx;
         return;
       }
-      // Copy using memcpy if possible, otherwise an Eigen loop
-      // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
-      // ahead-of-time compilation binary size).
-      if (is_simple_type<T>::value) {
-        // Avoid auto-promotion to Index from SliceIndex by casting.
-        memcpy(out_base + (batch_idx * indices_size + indices_idx) * slice_elems,
-               params_base + (batch_idx * static_cast<SliceIndex>(limit) +
-                              static_cast<SliceIndex>(index)) *
-                             slice_elems,
-               slice_bytes);
-      } else {
-        // For non-"simple" types (e.g. strings).
-        out.template chip<1>(indices_idx) = params.template chip<1>(index);
-      }
-      indices_idx = i_next;
-      batch_idx = b_next;
+      out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
+          params.template chip<0>(batch_idx).template chip<0>(index);
     }
   };
 
-  Shard(worker_threads->num_threads, worker_threads->workers, batch_size*indices_size,
-        slice_elems * sizeof(T), work);
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        batch_size * indices_size, slice_elems * sizeof(T), work);
   return result;
 }
 
@@ -112,32 +207,45 @@ struct GatherFunctorCPU {
                    typename TTypes<T, 3>::Tensor out) {
     const int64 N = indices.size();
     const int64 slice_size = out.dimension(2);
-    int64 bad_i;
-
-    bool use_large = (slice_size > std::numeric_limits<int32>::max() ||
-                      params.size() > std::numeric_limits<int32>::max() ||
-                      N > std::numeric_limits<int32>::max());
-#define CALL(elems)                                                        \
-  do {                                                                     \
-    if (use_large) {                                                       \
-      bad_i = HandleCopies<T, Index, int64, elems>(ctx, params, indices,   \
-                                                   slice_size, out);       \
-    } else {                                                               \
-      const int32 small_slice = static_cast<int32>(slice_size);            \
-      bad_i = HandleCopies<T, Index, int32, elems>(ctx, params, indices,   \
-                                                   small_slice, out);      \
-    }                                                                      \
-  } while (0)
-
-    if (slice_size == 10)
-      CALL(10);
-    else if (slice_size == 20)
-      CALL(20);
-    else
-      CALL(-1);
-#undef CALL
 
-    return bad_i;
+    if (!is_simple_type<T>::value) {
+      const bool use_large =
+          (slice_size > std::numeric_limits<int32>::max() ||
+           params.size() > std::numeric_limits<int32>::max() ||
+           N > std::numeric_limits<int32>::max());
+      if (use_large) {
+        return HandleCopies<T, Index, int64>(ctx, params, indices, out);
+      } else {
+        return HandleCopies<T, Index, int32>(ctx, params, indices, out);
+      }
+    }
+
+    // Simple types are gathered as raw bytes, with fixed-size copy loops for
+    // common power-of-two row sizes.
+    const char* params_base = reinterpret_cast<const char*>(params.data());
+    char* out_base = reinterpret_cast<char*>(out.data());
+    const int64 batch_size = params.dimension(0);
+    const int64 limit = params.dimension(1);
+    const int64 slice_bytes = slice_size * sizeof(T);
+#define CALL(bytes)                                                       \
+  case bytes:                                                             \
+    return HandleCopiesBytes<Index, bytes>(ctx, params_base, batch_size,  \
+                                           limit, indices, slice_bytes,   \
+                                           out_base);
+    switch (slice_bytes) {
+      CALL(4);
+      CALL(8);
+      CALL(16);
+      CALL(32);
+      CALL(64);
+      CALL(128);
+      CALL(256);
+      default:
+        return HandleCopiesBytes<Index, -1>(ctx, params_base, batch_size,
+                                            limit, indices, slice_bytes,
+                                            out_base);
+    }
+#undef CALL
   }
 };
 
@@ -161,6 +161,52 @@ TEST_F(GatherOpTest, HighRank) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(GatherOpTest, String_Axis1) {
+  MakeOp(DT_STRING, DT_INT32);
+
+  // Feed and run
+  AddInputFromArray<string>(TensorShape({2, 3}),
+                            {"a", "b", "c", "d", "e", "f"});
+  AddInputFromArray<int32>(TensorShape({4}), {2, 0, 2, 1});
+  AddInputFromArray<int32>(TensorShape({}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Check the output.
+  Tensor expected(allocator(), DT_STRING, TensorShape({2, 4}));
+  test::FillValues<string>(&expected, {"c", "a", "c", "b", "f", "d", "f", "e"});
+  test::ExpectTensorEqual<string>(expected, *GetOutput(0));
+}
+
+// Row sizes with fixed-size copy loops, with the generic loop, and rows large
+// enough to be copied in chunks.
+TEST_F(GatherOpTest, RowSizes) {
+  for (int row_size : {1, 2, 3, 16, 64, 100, 20000}) {
+    inputs_.clear();
+    MakeOp(DT_FLOAT, DT_INT32);
+
+    // Feed and run
+    const int num_rows = 3;
+    std::vector<float> params(num_rows * row_size);
+    for (int i = 0; i < params.size(); ++i) {
+      params[i] = i;
+    }
+    AddInputFromArray<float>(TensorShape({num_rows, row_size}), params);
+    AddInputFromArray<int32>(TensorShape({5}), {2, 0, 1, 2, 2});
+    AddInputFromArray<int32>(TensorShape({}), {0});
+    TF_ASSERT_OK(RunOpKernel());
+
+    // Check the output.
+    Tensor expected(allocator(), DT_FLOAT, TensorShape({5, row_size}));
+    int out = 0;
+    for (int index : {2, 0, 1, 2, 2}) {
+      for (int j = 0; j < row_size; ++j) {
+        expected.flat<float>()(out++) = params[index * row_size + j];
+      }
+    }
+    test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+  }
+}
+
 TEST_F(GatherOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT, DT_INT32);
 
@@ -178,7 +224,7 @@ TEST_F(GatherOpTest, Error_IndexOutOfRange) {
 constexpr int kLookups = 2000;
 
 template <typename Index>
-static Graph* Gather(int dim) {
+static Graph* Gather(int dim, int num_lookups = kLookups) {
   Graph* g = new Graph(OpRegistry::Global());
   // Always use a 512MB buffer.
   const int kRows = ((512 << 20) / sizeof(float)) / dim;
@@ -188,11 +234,11 @@ static Graph* Gather(int dim) {
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   std::vector<Index> indices_vec;
-  indices_vec.reserve(kLookups);
-  for (int i = 0; i < kLookups; i++) {
+  indices_vec.reserve(num_lookups);
+  for (int i = 0; i < num_lookups; i++) {
     indices_vec.push_back(rnd.Uniform(kRows));
   }
-  Tensor indices(DataTypeToEnum<Index>::value, TensorShape({kLookups}));
+  Tensor indices(DataTypeToEnum<Index>::value, TensorShape({num_lookups}));
   for (int i = 0; i < indices_vec.size(); i++) {
     indices.flat<Index>()(i) = indices_vec[i];
   }
@@ -216,8 +262,10 @@ static Graph* Gather(int dim) {
   }                                                               \
   BENCHMARK(BM_##DEVICE##_gather_##INDEX)                         \
       ->Arg(1)                                                    \
+      ->Arg(8)                                                    \
       ->Arg(10)                                                   \
       ->Arg(20)                                                   \
+      ->Arg(32)                                                   \
       ->Arg(64)                                                   \
       ->Arg(100)                                                  \
       ->Arg(200)                                                  \
@@ -228,5 +276,20 @@ BM_GATHER(gpu, int32);
 BM_GATHER(cpu, int64);
 BM_GATHER(gpu, int64);
 
+// Few lookups of rows from 64KB to 4MB, which are split across threads.
+constexpr int kLargeRowLookups = 16;
+
+static void BM_cpu_gather_large_rows(int iters, int dim) {
+  const int64 tot = static_cast<int64>(iters) * kLargeRowLookups * dim;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * sizeof(float));
+  testing::UseRealTime();
+  test::Benchmark("cpu", Gather<int32>(dim, kLargeRowLookups)).Run(iters);
+}
+BENCHMARK(BM_cpu_gather_large_rows)
+    ->Arg(16 << 10)
+    ->Arg(256 << 10)
+    ->Arg(1 << 20);
+
 }  // namespace
 }  // namespace tensorflow
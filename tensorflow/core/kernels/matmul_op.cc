@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/fused_output_stage.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
 #include "cuda/include/cuda.h"
@@ -505,6 +506,26 @@ class MatMulOp : public OpKernel {
   bool transpose_b_;
 };
 
+// MatMul followed by the bias or batch norm and activation that the grappler
+// remapper folded into it.
+template <typename T>
+class FusedMatMulOp : public MatMulOp<CPUDevice, T, false> {
+ public:
+  explicit FusedMatMulOp(OpKernelConstruction* ctx)
+      : MatMulOp<CPUDevice, T, false>(ctx) {
+    OP_REQUIRES_OK(ctx, output_stage_.Init(ctx));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    MatMulOp<CPUDevice, T, false>::Compute(ctx);
+    if (!ctx->status().ok()) return;
+    output_stage_.Apply<T>(ctx, 2, ctx->mutable_output(0));
+  }
+
+ private:
+  FusedOutputStage output_stage_;
+};
+
 namespace functor {
 
 // Partial specialization MatMulFunctor<Device=CPUDevice, T>.
@@ -569,6 +590,14 @@ TF_CALL_complex64(REGISTER_CPU);
 TF_CALL_complex128(REGISTER_CPU);
 #endif
 
+#define REGISTER_FUSED_CPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedMatMulOp<T>)
+
+TF_CALL_float(REGISTER_FUSED_CPU);
+TF_CALL_double(REGISTER_FUSED_CPU);
+
 #if GOOGLE_CUDA
 TF_CALL_float(REGISTER_GPU);
 TF_CALL_double(REGISTER_GPU);
@@ -23,6 +23,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -36,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -132,6 +137,341 @@ class ReductionHelper {
   gtl::InlinedVector<int64, 4> out_reshape_;   // Reshape output for reduction.
 };
 
+namespace functor {
+
+// MatrixReducer<Reducer> describes the reducers that have the specialized CPU
+// kernels of MatrixReduction below. Partial results are merged with Combine()
+// for single values and CombineRow() for whole rows of an accumulator, and a
+// row is reduced to one value by Redux(). Finalize() turns the combination of
+// `count` elements into the result of the reduction.
+template <typename Reducer>
+struct MatrixReducer {
+  static constexpr bool kSupported = false;
+};
+
+template <typename T>
+struct IsMatrixReducerType {
+  static constexpr bool value =
+      std::is_same<T, float>::value || std::is_same<T, double>::value ||
+      std::is_same<T, int32>::value || std::is_same<T, int64>::value;
+};
+
+template <typename T>
+struct MatrixReducer<Eigen::internal::SumReducer<T>> {
+  static constexpr bool kSupported = IsMatrixReducerType<T>::value;
+  static T Combine(T a, T b) { return a + b; }
+  template <typename Acc, typename Row>
+  static void CombineRow(Acc* acc, const Row& row) {
+    *acc += row;
+  }
+  template <typename Row>
+  static T Redux(const Row& row) {
+    return row.sum();
+  }
+  static T Finalize(T a, int64 count) { return a; }
+};
+
+template <typename T>
+struct MatrixReducer<Eigen::internal::MeanReducer<T>>
+    : MatrixReducer<Eigen::internal::SumReducer<T>> {
+  static T Finalize(T a, int64 count) { return a / static_cast<T>(count); }
+};
+
+template <typename T>
+struct MatrixReducer<Eigen::internal::MaxReducer<T>> {
+  static constexpr bool kSupported = IsMatrixReducerType<T>::value;
+  static T Combine(T a, T b) { return a < b ? b : a; }
+  template <typename Acc, typename Row>
+  static void CombineRow(Acc* acc, const Row& row) {
+    *acc = acc->max(row);
+  }
+  template <typename Row>
+  static T Redux(const Row& row) {
+    return row.maxCoeff();
+  }
+  static T Finalize(T a, int64 count) { return a; }
+};
+
+template <typename T>
+struct MatrixReducer<Eigen::internal::MinReducer<T>> {
+  static constexpr bool kSupported = IsMatrixReducerType<T>::value;
+  static T Combine(T a, T b) { return b < a ? b : a; }
+  template <typename Acc, typename Row>
+  static void CombineRow(Acc* acc, const Row& row) {
+    *acc = acc->min(row);
+  }
+  template <typename Row>
+  static T Redux(const Row& row) {
+    return row.minCoeff();
+  }
+  static T Finalize(T a, int64 count) { return a; }
+};
+
+namespace matrix_reduction {
+
+// Accumulators of reductions along the outer dimension are at least this wide:
+// narrower matrices are reduced several rows at a time, so that they are also
+// processed with full vectors.
+constexpr int64 kFoldWidth = 256;
+
+// Columns per shard when the columns of a wide matrix are split across
+// threads.
+constexpr int64 kColumnBlock = 1024;
+
+// Minimum number of input elements per shard.
+constexpr int64 kMinShardElements = 32 * 1024;
+
+// Sets out[i] to the combination of row i of the row-major [rows, kCols]
+// matrix `in`, for i in [begin, end).
+template <typename Traits, int kCols, typename T>
+void ReduceRowsFixed(const T* in, int64 begin, int64 end, T* out) {
+  for (int64 i = begin; i < end; ++i) {
+    const T* row = in + i * kCols;
+    T acc = row[0];
+    for (int j = 1; j < kCols; ++j) acc = Traits::Combine(acc, row[j]);
+    out[i] = acc;
+  }
+}
+
+// Sets out[i] to the combination of row i of the row-major [rows, cols]
+// matrix `in`, for i in [begin, end). Short rows use unrolled loops, longer
+// ones Eigen's vectorized reductions.
+template <typename Traits, typename T>
+void ReduceRows(const T* in, int64 cols, int64 begin, int64 end, T* out) {
+  switch (cols) {
+    case 1:
+      return ReduceRowsFixed<Traits, 1>(in, begin, end, out);
+    case 2:
+      return ReduceRowsFixed<Traits, 2>(in, begin, end, out);
+    case 3:
+      return ReduceRowsFixed<Traits, 3>(in, begin, end, out);
+    case 4:
+      return ReduceRowsFixed<Traits, 4>(in, begin, end, out);
+    case 5:
+      return ReduceRowsFixed<Traits, 5>(in, begin, end, out);
+    case 6:
+      return ReduceRowsFixed<Traits, 6>(in, begin, end, out);
+    case 7:
+      return ReduceRowsFixed<Traits, 7>(in, begin, end, out);
+    case 8:
+      return ReduceRowsFixed<Traits, 8>(in, begin, end, out);
+  }
+  typedef Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> ConstRow;
+  for (int64 i = begin; i < end; ++i) {
+    out[i] = Traits::Redux(ConstRow(in + i * cols, cols));
+  }
+}
+
+// Sets out[j] to the combination of column j of the [rows, cols] matrix whose
+// rows start `stride` elements apart in `in`, for j in [0, cols).
+template <typename Traits, typename T>
+void ReduceColumns(const T* in, int64 rows, int64 cols, int64 stride,
+                   T* out) {
+  typedef Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> ConstRow;
+  typedef Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>> Row;
+  // When the rows are contiguous and narrow, combine `fold` rows at a time
+  // into a wider accumulator, and reduce it to `cols` values at the end.
+  int64 fold = 1;
+  if (stride == cols && cols < kFoldWidth && rows >= 2 * kFoldWidth / cols) {
+    fold = kFoldWidth / cols;
+  }
+  const int64 width = fold * cols;
+  const int64 groups = rows / fold;
+  std::vector<T> buffer(fold > 1 ? width : 0);
+  T* acc_data = fold > 1 ? buffer.data() : out;
+  Row acc(acc_data, width);
+  acc = ConstRow(in, width);
+  for (int64 g = 1; g < groups; ++g) {
+    Traits::CombineRow(&acc, ConstRow(in + g * fold * stride, width));
+  }
+  if (fold > 1) {
+    for (int64 j = 0; j < cols; ++j) {
+      T value = acc_data[j];
+      for (int64 k = 1; k < fold; ++k) {
+        value = Traits::Combine(value, acc_data[k * cols + j]);
+      }
+      for (int64 i = groups * fold; i < rows; ++i) {
+        value = Traits::Combine(value, in[i * stride + j]);
+      }
+      out[j] = value;
+    }
+  }
+}
+
+// Reduces the row-major [rows, cols] matrix `in` along its second dimension.
+template <typename Traits, typename T>
+void ReduceInner(OpKernelContext* ctx, const T* in, int64 rows, int64 cols,
+                 T* out) {
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, rows, cols,
+        [in, cols, out](int64 begin, int64 end) {
+          ReduceRows<Traits>(in, cols, begin, end, out);
+        });
+}
+
+// Reduces the row-major [rows, cols] matrix `in` along its first dimension.
+// Wide matrices are split by columns. Otherwise every shard reduces a range of
+// rows to a partial result, and the partial results are combined at the end.
+template <typename Traits, typename T>
+void ReduceOuter(OpKernelContext* ctx, const T* in, int64 rows, int64 cols,
+                 T* out) {
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  const int64 num_threads = worker_threads->num_threads;
+  const int64 column_blocks = (cols + kColumnBlock - 1) / kColumnBlock;
+  if (column_blocks >= num_threads) {
+    Shard(num_threads, worker_threads->workers, column_blocks,
+          rows * kColumnBlock, [=](int64 begin, int64 end) {
+            const int64 first = begin * kColumnBlock;
+            const int64 last = std::min(cols, end * kColumnBlock);
+            ReduceColumns<Traits>(in + first, rows, last - first, cols,
+                                  out + first);
+          });
+    return;
+  }
+
+  const int64 max_blocks = std::min(num_threads, rows);
+  const int64 num_blocks = std::max<int64>(
+      1, std::min(max_blocks, rows * cols / kMinShardElements));
+  const int64 rows_per_block = (rows + num_blocks - 1) / num_blocks;
+  std::vector<T> partials((num_blocks - 1) * cols);
+  auto work = [&](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      const int64 first = b * rows_per_block;
+      const int64 last = std::min(rows, first + rows_per_block);
+      if (first >= last) continue;
+      T* block_out = b == 0 ? out : partials.data() + (b - 1) * cols;
+      ReduceColumns<Traits>(in + first * cols, last - first, cols, cols,
+                            block_out);
+    }
+  };
+  // Every block is large enough to be a shard of its own.
+  Shard(num_threads, worker_threads->workers, num_blocks,
+        rows_per_block * cols, work);
+  typedef Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> ConstRow;
+  Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>> result(out, cols);
+  for (int64 b = 1; b < num_blocks; ++b) {
+    if (b * rows_per_block >= rows) break;
+    Traits::CombineRow(&result, ConstRow(partials.data() + (b - 1) * cols,
+                                         cols));
+  }
+}
+
+template <typename Traits, typename T>
+void Finalize(T* out, int64 size, int64 count) {
+  for (int64 i = 0; i < size; ++i) out[i] = Traits::Finalize(out[i], count);
+}
+
+}  // namespace matrix_reduction
+
+// Specialized CPU kernels for reductions of a row-major tensor along its
+// innermost or outermost dimensions, which generic Eigen reductions are far
+// from memory bandwidth on when the reduced or the kept dimension is small.
+// Each method returns false without doing anything if there is no kernel for
+// the device, type and reducer, and the caller should use ReduceFunctor.
+template <typename Device, typename T, typename Reducer, typename Enable = void>
+struct MatrixReduction {
+  // [rows, cols] -> [rows]
+  static bool ReduceInner(OpKernelContext* ctx,
+                          typename TTypes<T, 2>::ConstTensor in,
+                          typename TTypes<T, 1>::Tensor out) {
+    return false;
+  }
+  // [rows, cols] -> [cols]
+  static bool ReduceOuter(OpKernelContext* ctx,
+                          typename TTypes<T, 2>::ConstTensor in,
+                          typename TTypes<T, 1>::Tensor out) {
+    return false;
+  }
+  // [d0, d1, d2] -> [d0, d2]
+  static bool ReduceMiddle(OpKernelContext* ctx,
+                           typename TTypes<T, 3>::ConstTensor in,
+                           typename TTypes<T, 2>::Tensor out) {
+    return false;
+  }
+  // [d0, d1, d2] -> [d1]
+  static bool ReduceOuterAndInner(OpKernelContext* ctx,
+                                  typename TTypes<T, 3>::ConstTensor in,
+                                  typename TTypes<T, 1>::Tensor out) {
+    return false;
+  }
+};
+
+template <typename T, typename Reducer>
+struct MatrixReduction<
+    CPUDevice, T, Reducer,
+    typename std::enable_if<MatrixReducer<Reducer>::kSupported>::type> {
+  typedef MatrixReducer<Reducer> Traits;
+
+  static bool ReduceInner(OpKernelContext* ctx,
+                          typename TTypes<T, 2>::ConstTensor in,
+                          typename TTypes<T, 1>::Tensor out) {
+    const int64 rows = in.dimension(0);
+    const int64 cols = in.dimension(1);
+    matrix_reduction::ReduceInner<Traits>(ctx, in.data(), rows, cols,
+                                          out.data());
+    matrix_reduction::Finalize<Traits>(out.data(), rows, cols);
+    return true;
+  }
+
+  static bool ReduceOuter(OpKernelContext* ctx,
+                          typename TTypes<T, 2>::ConstTensor in,
+                          typename TTypes<T, 1>::Tensor out) {
+    const int64 rows = in.dimension(0);
+    const int64 cols = in.dimension(1);
+    matrix_reduction::ReduceOuter<Traits>(ctx, in.data(), rows, cols,
+                                          out.data());
+    matrix_reduction::Finalize<Traits>(out.data(), cols, rows);
+    return true;
+  }
+
+  static bool ReduceMiddle(OpKernelContext* ctx,
+                           typename TTypes<T, 3>::ConstTensor in,
+                           typename TTypes<T, 2>::Tensor out) {
+    const int64 d0 = in.dimension(0);
+    const int64 d1 = in.dimension(1);
+    const int64 d2 = in.dimension(2);
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    if (d0 >= worker_threads->num_threads) {
+      // Enough independent slices to keep every thread busy.
+      const T* in_data = in.data();
+      T* out_data = out.data();
+      Shard(worker_threads->num_threads, worker_threads->workers, d0, d1 * d2,
+            [=](int64 begin, int64 end) {
+              for (int64 i = begin; i < end; ++i) {
+                matrix_reduction::ReduceColumns<Traits>(
+                    in_data + i * d1 * d2, d1, d2, d2, out_data + i * d2);
+              }
+            });
+    } else {
+      for (int64 i = 0; i < d0; ++i) {
+        matrix_reduction::ReduceOuter<Traits>(ctx, in.data() + i * d1 * d2, d1,
+                                              d2, out.data() + i * d2);
+      }
+    }
+    matrix_reduction::Finalize<Traits>(out.data(), d0 * d2, d1);
+    return true;
+  }
+
+  static bool ReduceOuterAndInner(OpKernelContext* ctx,
+                                  typename TTypes<T, 3>::ConstTensor in,
+                                  typename TTypes<T, 1>::Tensor out) {
+    const int64 d0 = in.dimension(0);
+    const int64 d1 = in.dimension(1);
+    const int64 d2 = in.dimension(2);
+    // Reduce the innermost dimension into a [d0, d1] buffer first, then
+    // reduce that along its outer dimension.
+    std::vector<T> buffer(d0 * d1);
+    matrix_reduction::ReduceInner<Traits>(ctx, in.data(), d0 * d1, d2,
+                                          buffer.data());
+    matrix_reduction::ReduceOuter<Traits>(ctx, buffer.data(), d0, d1,
+                                          out.data());
+    matrix_reduction::Finalize<Traits>(out.data(), d1, d0 * d2);
+    return true;
+  }
+};
+
+}  // namespace functor
+
 // For operations where the output is a reduction function along some
 // dimensions of the input.
 template <typename Device, class T, typename Tperm, typename Reducer>
@@ -180,6 +520,7 @@ class ReductionOp : public OpKernel {
                                 helper.out_reshape(), &tmp_out, alloc_attr));
 
     typedef functor::ReduceFunctor<Device, Reducer> Functor;
+    typedef functor::MatrixReduction<Device, T, Reducer> MatrixReduction;
     Constants<Device> constants;
     const Device& d = ctx->eigen_device<Device>();
     Reducer reducer;
@@ -198,21 +539,33 @@ class ReductionOp : public OpKernel {
                       constants.kZero, reducer);
     } else if ((helper.ndims() == 2) && helper.reduce_first_axis()) {
       // Can be viewed as a reduction of a matrix along 1st dimension.
-      Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out), helper.in<T, 2>(data),
-                      constants.kZero, reducer);
+      if (!MatrixReduction::ReduceOuter(ctx, helper.in<T, 2>(data),
+                                        helper.out<T, 1>(&tmp_out))) {
+        Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out),
+                        helper.in<T, 2>(data), constants.kZero, reducer);
+      }
     } else if ((helper.ndims() == 2) && !helper.reduce_first_axis()) {
       // Can be viewed as a reduction of a matrix along 2nd dimension.
-      Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out), helper.in<T, 2>(data),
-                      constants.kOne, reducer);
+      if (!MatrixReduction::ReduceInner(ctx, helper.in<T, 2>(data),
+                                        helper.out<T, 1>(&tmp_out))) {
+        Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out),
+                        helper.in<T, 2>(data), constants.kOne, reducer);
+      }
     } else if ((helper.ndims() == 3) && helper.reduce_first_axis()) {
       // Can be viewed as a reduction of a 3D tensor along 1st and 3rd
       // dimensions.
-      Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out), helper.in<T, 3>(data),
-                      constants.kZeroTwo, reducer);
+      if (!MatrixReduction::ReduceOuterAndInner(ctx, helper.in<T, 3>(data),
+                                                helper.out<T, 1>(&tmp_out))) {
+        Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out),
+                        helper.in<T, 3>(data), constants.kZeroTwo, reducer);
+      }
     } else if ((helper.ndims() == 3) && !helper.reduce_first_axis()) {
       // Can be viewed as a reduction of a 3D tensor along 2nd dimension.
-      Functor::Reduce(ctx, helper.out<T, 2>(&tmp_out), helper.in<T, 3>(data),
-                      constants.kOne, reducer);
+      if (!MatrixReduction::ReduceMiddle(ctx, helper.in<T, 3>(data),
+                                         helper.out<T, 2>(&tmp_out))) {
+        Functor::Reduce(ctx, helper.out<T, 2>(&tmp_out),
+                        helper.in<T, 3>(data), constants.kOne, reducer);
+      }
     } else {
       // If we don't hit one of the cases above, transpose the data so that
       // all reduced dimensions are last and reuse the 2-D -> 1-D case.
@@ -227,9 +580,13 @@ class ReductionOp : public OpKernel {
       const int64 unreduced = tmp_out.NumElements();
       const int64 reduced = shuffled.NumElements() / unreduced;
       const Tensor& const_shuffled = shuffled;
-      Functor::Reduce(ctx, tmp_out.flat<T>(),
-                      const_shuffled.shaped<T, 2>({unreduced, reduced}),
-                      constants.kOne, reducer);
+      if (!MatrixReduction::ReduceInner(
+              ctx, const_shuffled.shaped<T, 2>({unreduced, reduced}),
+              tmp_out.flat<T>())) {
+        Functor::Reduce(ctx, tmp_out.flat<T>(),
+                        const_shuffled.shaped<T, 2>({unreduced, reduced}),
+                        constants.kOne, reducer);
+      }
     }
 
     // Set the real output using the contents of the reduction but the
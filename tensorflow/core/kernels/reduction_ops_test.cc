@@ -13,14 +13,126 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class ReductionOpTest : public OpsTestBase {
+ protected:
+  // Runs `op` on a [d0, d1, d2] tensor of small integers, reducing `axes`,
+  // and compares the result with a straightforward reduction.
+  template <typename T>
+  void Check(const string& op, int d0, int d1, int d2,
+             const std::vector<int32>& axes) {
+    inputs_.clear();
+    tensors_.clear();
+    TF_ASSERT_OK(NodeDefBuilder("reduce", op)
+                     .Input(FakeInput(DataTypeToEnum<T>::value))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("keep_dims", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    const int dims[] = {d0, d1, d2};
+    std::vector<T> data(d0 * d1 * d2);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<T>(static_cast<int64>(i * 37 + 11) % 101 - 50);
+    }
+    AddInputFromArray<T>(TensorShape({d0, d1, d2}), data);
+    AddInputFromArray<int32>(TensorShape({static_cast<int64>(axes.size())}),
+                             axes);
+    TF_ASSERT_OK(RunOpKernel());
+
+    bool reduced[3] = {false, false, false};
+    for (int32 axis : axes) reduced[axis] = true;
+    int out_dims[3];
+    int count = 1;
+    for (int k = 0; k < 3; ++k) {
+      out_dims[k] = reduced[k] ? 1 : dims[k];
+      if (reduced[k]) count *= dims[k];
+    }
+    std::vector<T> result(out_dims[0] * out_dims[1] * out_dims[2]);
+    std::vector<bool> seen(result.size(), false);
+    for (int i = 0; i < d0; ++i) {
+      for (int j = 0; j < d1; ++j) {
+        for (int k = 0; k < d2; ++k) {
+          const T value = data[(i * d1 + j) * d2 + k];
+          const int o = ((reduced[0] ? 0 : i) * out_dims[1] +
+                         (reduced[1] ? 0 : j)) *
+                            out_dims[2] +
+                        (reduced[2] ? 0 : k);
+          if (!seen[o]) {
+            result[o] = value;
+          } else if (op == "Max") {
+            result[o] = std::max(result[o], value);
+          } else if (op == "Min") {
+            result[o] = std::min(result[o], value);
+          } else {
+            result[o] += value;
+          }
+          seen[o] = true;
+        }
+      }
+    }
+    if (op == "Mean") {
+      for (T& value : result) value /= static_cast<T>(count);
+    }
+    Tensor expected(allocator(), DataTypeToEnum<T>::value,
+                    TensorShape({out_dims[0], out_dims[1], out_dims[2]}));
+    test::FillValues<T>(&expected, result);
+    ExpectResult<T>(expected, *GetOutput(0),
+                    std::is_floating_point<T>());
+  }
+
+ private:
+  template <typename T>
+  static void ExpectResult(const Tensor& expected, const Tensor& output,
+                           std::true_type /* is_floating_point */) {
+    test::ExpectTensorNear<T>(expected, output, 1e-3);
+  }
+  template <typename T>
+  static void ExpectResult(const Tensor& expected, const Tensor& output,
+                           std::false_type /* is_floating_point */) {
+    test::ExpectTensorEqual<T>(expected, output);
+  }
+};
+
+// Covers the specialized CPU kernels for reductions along the innermost and
+// outermost dimensions, and the generic path for types they do not handle.
+TEST_F(ReductionOpTest, MatrixReductions) {
+  for (const string op : {"Sum", "Mean", "Max", "Min"}) {
+    for (int inner : {1, 2, 3, 4, 7, 8, 9, 64, 300}) {
+      for (int outer : {1, 5, 600}) {
+        // [outer, inner] -> [outer]
+        Check<float>(op, 1, outer, inner, {2});
+        // [outer, inner] -> [inner]
+        Check<float>(op, outer, inner, 1, {0});
+        // [2, outer, inner] -> [2, inner]
+        Check<double>(op, 2, outer, inner, {1});
+        // [outer, 3, inner] -> [3]
+        Check<float>(op, outer, 3, inner, {0, 2});
+      }
+    }
+    // Reductions of a non-trailing set of axes are transposed first.
+    Check<float>(op, 4, 5, 6, {0, 1});
+    Check<int32>(op, 30, 7, 9, {1});
+    Check<int64>(op, 30, 7, 9, {0});
+    Check<int16>(op, 30, 7, 9, {2});
+  }
+}
+
 // Creates a Graph which "reduce"s a 3D float tensor of "num" elements
 // into a scalar.
 template <typename T>
@@ -124,6 +236,45 @@ static void Do3DXZReduce(int iters, const string& device, const string& reduce,
   test::Benchmark(device, ThreeDXZReduce(reduce, num_x, num_y)).Run(iters);
 }
 
+// Benchmarks of CPU reductions of a [num_x, num_y] matrix along one dimension,
+// for reduced or kept dimensions from very small to large.
+#define BM_REDUCE_CPU(OP)                                                    \
+  static void BM_##OP##2DRowReduceCPU(int iters, int num_x, int num_y) {     \
+    DoRowReduce(iters, "cpu", #OP, num_x, num_y);                            \
+  }                                                                          \
+  BENCHMARK(BM_##OP##2DRowReduceCPU)                                         \
+      ->ArgPair(1 << 20, 2)                                                  \
+      ->ArgPair(1 << 20, 4)                                                  \
+      ->ArgPair(1 << 18, 16)                                                 \
+      ->ArgPair(1 << 16, 64)                                                 \
+      ->ArgPair(4096, 1024)                                                  \
+      ->ArgPair(64, 1 << 16);                                                \
+  static void BM_##OP##2DColumnReduceCPU(int iters, int num_x, int num_y) {  \
+    DoColReduce(iters, "cpu", #OP, num_x, num_y);                            \
+  }                                                                          \
+  BENCHMARK(BM_##OP##2DColumnReduceCPU)                                      \
+      ->ArgPair(1 << 20, 2)                                                  \
+      ->ArgPair(1 << 20, 4)                                                  \
+      ->ArgPair(1 << 18, 16)                                                 \
+      ->ArgPair(1 << 16, 64)                                                 \
+      ->ArgPair(4096, 1024)                                                  \
+      ->ArgPair(64, 1 << 16);
+
+BM_REDUCE_CPU(Sum);
+BM_REDUCE_CPU(Mean);
+BM_REDUCE_CPU(Max);
+BM_REDUCE_CPU(Min);
+
+static void BM_Sum3DYReduceCPU(int iters, int num_x, int num_y) {
+  Do3DYReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum3DYReduceCPU)->RangePair(64, 4096, 4, 4096);
+
+static void BM_Sum3DXZReduceCPU(int iters, int num_x, int num_y) {
+  Do3DXZReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum3DXZReduceCPU)->RangePair(64, 4096, 4, 4096);
+
 static void BM_Sum2DToScalarGPU(int iters, int num_x, int num_y) {
   ReduceToScalar<float>(iters, "gpu", "Sum", num_x, num_y);
 }
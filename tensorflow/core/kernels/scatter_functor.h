@@ -16,11 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -119,6 +123,71 @@ struct AssignSYCL<scatter_op::UpdateOp::DIV> {
 };
 #endif // TENSORFLOW_USE_SYCL
 
+// CPU scatters that update at least this many elements are split across the
+// intra-op threads by ParallelScatter.
+constexpr int64 kParallelScatterMinElements = 64 * 1024;
+
+// Returns true if a CPU scatter of `num_updates` slices of `slice_size`
+// elements into a variable with `num_rows` rows should use ParallelScatter.
+inline bool UseParallelScatter(OpKernelContext* c, int64 num_updates,
+                               int64 num_rows, int64 slice_size) {
+  return num_updates > 1 && num_rows > 1 &&
+         num_updates * slice_size >= kParallelScatterMinElements &&
+         c->device()->tensorflow_cpu_worker_threads()->num_threads > 1;
+}
+
+// Calls `update(i, indices(i))` for every update `i`, in parallel.
+//
+// The rows of the variable are split into one contiguous range per thread,
+// and the updates are bucketed by destination range with a stable counting
+// sort. Every row is therefore written by a single thread, which applies the
+// updates for it in their original order, so the result is the same as that
+// of a serial loop even when `indices` has duplicates.
+//
+// Unlike the serial loops, no update is applied if an index is out of range.
+// Returns the position of the first such index, or -1.
+template <typename Index, typename UpdateFn>
+Index ParallelScatter(OpKernelContext* c, Index limit,
+                      typename TTypes<Index>::ConstFlat indices,
+                      int64 update_cost, UpdateFn update) {
+  const Index N = static_cast<Index>(indices.size());
+  auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+  const int64 num_ranges =
+      std::min<int64>(worker_threads->num_threads, limit);
+  const int64 rows_per_range = (limit + num_ranges - 1) / num_ranges;
+
+  // Grab every index once, so that the bounds check and the update use the
+  // same value, and count the updates that go to each range.
+  std::vector<Index> index_copy(N);
+  std::vector<int64> range_start(num_ranges + 1, 0);
+  for (Index i = 0; i < N; i++) {
+    const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, limit)) return i;
+    index_copy[i] = index;
+    ++range_start[index / rows_per_range + 1];
+  }
+  for (int64 r = 0; r < num_ranges; ++r) {
+    range_start[r + 1] += range_start[r];
+  }
+  std::vector<Index> order(N);
+  {
+    std::vector<int64> next(range_start.begin(), range_start.end() - 1);
+    for (Index i = 0; i < N; i++) {
+      order[next[index_copy[i] / rows_per_range]++] = i;
+    }
+  }
+
+  auto work = [&](int64 start, int64 end) {
+    for (int64 k = range_start[start]; k < range_start[end]; ++k) {
+      const Index i = order[k];
+      update(i, index_copy[i]);
+    }
+  };
+  Shard(worker_threads->num_threads, worker_threads->workers, num_ranges,
+        update_cost * (N / num_ranges + 1), work);
+  return -1;
+}
+
 }  // namespace internal
 }  // namespace scatter_op
 
@@ -179,6 +248,38 @@ struct ScatterFunctorBase <SYCLDevice, T, Index, op> {
 };
 #endif // TENSORFLOW_USE_SYCL
 
+template <typename T, typename Index, scatter_op::UpdateOp op>
+struct ScatterFunctorBase<CPUDevice, T, Index, op> {
+  Index operator()(OpKernelContext* c, const CPUDevice& d,
+                   typename TTypes<T>::Matrix params,
+                   typename TTypes<T>::ConstMatrix updates,
+                   typename TTypes<Index>::ConstFlat indices) {
+    // indices and params sizes were validated in DoCompute().
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    if (scatter_op::internal::UseParallelScatter(c, N, limit,
+                                                 updates.dimension(1))) {
+      auto update = [&params, &updates](Index i, Index index) {
+        scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
+                                              updates.template chip<0>(i));
+      };
+      return scatter_op::internal::ParallelScatter(
+          c, limit, indices, updates.dimension(1) * 2, update);
+    }
+    for (Index i = 0; i < N; i++) {
+      // Grab the index and check its validity.  An earlier version of the
+      // code checked it and then grabbed it from memory a second time, which
+      // was a security risk since it could have changed in between.
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      // Copy last Ndim-1 dimensions of updates[i] to params[index]
+      scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
+                                            updates.template chip<0>(i));
+    }
+    return -1;
+  }
+};
+
 template <typename T, typename Index>
 struct ScatterFunctorBase<CPUDevice, T, Index, scatter_op::UpdateOp::ASSIGN> {
   Index operator()(OpKernelContext* c, const CPUDevice& d,
@@ -188,6 +289,21 @@ struct ScatterFunctorBase<CPUDevice, T, Index, scatter_op::UpdateOp::ASSIGN> {
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
+    if (scatter_op::internal::UseParallelScatter(c, N, limit,
+                                                 updates.dimension(1))) {
+      auto update = [&params, &updates](Index i, Index index) {
+        if (!std::is_same<T, string>::value) {
+          memmove(params.data() + index * params.dimension(1),
+                  updates.data() + i * updates.dimension(1),
+                  updates.dimension(1) * sizeof(T));
+        } else {
+          scatter_op::internal::Assign<scatter_op::UpdateOp::ASSIGN>::Run(
+              params.template chip<0>(index), updates.template chip<0>(i));
+        }
+      };
+      return scatter_op::internal::ParallelScatter(
+          c, limit, indices, updates.dimension(1) * sizeof(T), update);
+    }
     if (!std::is_same<T, string>::value) {
       for (Index i = 0; i < N; i++) {
         // Grab the index and check its validity.  An earlier version of the
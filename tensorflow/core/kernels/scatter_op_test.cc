@@ -37,14 +37,49 @@ namespace {
 
 class ScatterUpdateOpTest : public OpsTestBase {
  protected:
-  void MakeOp(DataType variable_ref_type, DataType index_type) {
-    TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterUpdate")
+  void MakeOp(DataType variable_ref_type, DataType index_type,
+              const string& op = "ScatterUpdate") {
+    TF_ASSERT_OK(NodeDefBuilder("myop", op)
                      .Input(FakeInput(variable_ref_type))
                      .Input(FakeInput(index_type))
                      .Input(FakeInput(RemoveRefType(variable_ref_type)))
                      .Finalize(node_def()));
     TF_ASSERT_OK(InitOp());
   }
+
+  // Scatters large enough to be split across threads must apply duplicate
+  // indices in order, like the serial loop.
+  void RunLargeScatter(const string& op) {
+    const int kRows = 1000;
+    const int kCols = 128;
+    const int kUpdates = 2000;
+    MakeOp(DT_FLOAT_REF, DT_INT32, op);
+    std::vector<float> params(kRows * kCols);
+    for (int i = 0; i < kRows * kCols; ++i) params[i] = i % 7 + 1;
+    random::PhiloxRandom philox(301, 17);
+    random::SimplePhilox rnd(&philox);
+    std::vector<int32> indices(kUpdates);
+    std::vector<float> updates(kUpdates * kCols);
+    for (int i = 0; i < kUpdates; ++i) {
+      indices[i] = rnd.Uniform(kRows / 10) * 10;
+      for (int j = 0; j < kCols; ++j) updates[i * kCols + j] = i % 5 + j % 3;
+    }
+    AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+    AddInputFromArray<int32>(TensorShape({kUpdates}), indices);
+    AddInputFromArray<float>(TensorShape({kUpdates, kCols}), updates);
+    TF_ASSERT_OK(RunOpKernel());
+
+    for (int i = 0; i < kUpdates; ++i) {
+      for (int j = 0; j < kCols; ++j) {
+        float& p = params[indices[i] * kCols + j];
+        const float u = updates[i * kCols + j];
+        p = op == "ScatterUpdate" ? u : p - u;
+      }
+    }
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>(params, {kRows, kCols}),
+        *mutable_input(0).tensor);
+  }
 };
 
 TEST_F(ScatterUpdateOpTest, Simple_StringType) {
@@ -174,6 +209,14 @@ TEST_F(ScatterUpdateOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(ScatterUpdateOpTest, LargeWithDuplicates) {
+  RunLargeScatter("ScatterUpdate");
+}
+
+TEST_F(ScatterUpdateOpTest, LargeSubWithDuplicates) {
+  RunLargeScatter("ScatterSub");
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
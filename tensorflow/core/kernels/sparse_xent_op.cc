@@ -18,6 +18,10 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/kernels/sparse_xent_op.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -110,6 +114,64 @@ struct SparseXentFunctor<CPUDevice, T, Index> {
                                                       scratch, loss, backprop);
   }
 };
+
+// Fused CPU implementation for float and double: each row is reduced to its
+// max in a first pass, the exponentiated logits are written to backprop and
+// summed in a second one, and scaled into probabilities in a third pass over
+// data that is still cached. Rows are sharded over the device's threads.
+//
+// backprop may share its buffer with logits, so the logit of the label is
+// read before the row is overwritten. The labels have been checked to be in
+// range by the op.
+template <typename T, typename Index>
+struct SparseXentFunctorCPU {
+  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<Index>::ConstVec labels,
+                  typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Matrix backprop) {
+    typedef Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> ConstArray;
+    typedef Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>> Array;
+    const int64 batch_size = logits.dimension(0);
+    const int64 num_classes = logits.dimension(1);
+    const T* logits_data = logits.data();
+    const Index* labels_data = labels.data();
+    T* loss_data = loss.data();
+    T* backprop_data = backprop.data();
+    auto compute_rows = [=](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const T* x = logits_data + i * num_classes;
+        T* b = backprop_data + i * num_classes;
+        const Index label = labels_data[i];
+        const T max_logit = ConstArray(x, num_classes).maxCoeff();
+        const T label_logit = x[label];
+        Array row(b, num_classes);
+        row = (ConstArray(x, num_classes) - max_logit).exp();
+        const T sum_exp = row.sum();
+        // log(sum(exp(logits - max_logits))) - (logits - max_logits)[label].
+        loss_data[i] = std::log(sum_exp) - (label_logit - max_logit);
+        // backprop: prob - 1{j == label}.
+        row *= T(1) / sum_exp;
+        b[label] -= T(1);
+      }
+    };
+    const double bytes = num_classes * sizeof(T);
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/bytes, /*bytes_stored=*/bytes,
+        /*compute_cycles=*/num_classes *
+            (Eigen::internal::functor_traits<
+                 Eigen::internal::scalar_exp_op<T>>::Cost +
+             3 * Eigen::TensorOpCost::AddCost<T>()));
+    d.parallelFor(batch_size, cost, std::move(compute_rows));
+  }
+};
+
+template <typename Index>
+struct SparseXentFunctor<CPUDevice, float, Index>
+    : SparseXentFunctorCPU<float, Index> {};
+
+template <typename Index>
+struct SparseXentFunctor<CPUDevice, double, Index>
+    : SparseXentFunctorCPU<double, Index> {};
 }  // namespace functor
 
 #define REGISTER(Dev, T, Index)                   \
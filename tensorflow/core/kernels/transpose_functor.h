@@ -75,6 +75,8 @@ typedef gtl::InlinedVector<int32, 8> TransposePermsVec;
 // The function outputs the combined shape and new permutation.
 // Example: Tensor shape {2, 3, 4, 5, 120} and permutation {0, 4, 1, 2, 3} will
 // produce new shape {2, 60, 120} and new permutation {0, 2, 1}.
+// Like |perm|, the new permutation maps each output dimension to the input
+// dimension it is taken from, and the new shape is that of the input.
 inline void ReduceTransposeDimensions(const TensorShape& shape,
                                       gtl::ArraySlice<int32> perm,
                                       TransposePermsVec* new_perm,
@@ -84,6 +86,7 @@ inline void ReduceTransposeDimensions(const TensorShape& shape,
     // If input dimension is already 1, no need to reduce dimension.
     new_perm->resize(1);
     (*new_perm)[0] = perm[0];
+    new_dims->resize(1);
     (*new_dims)[0] = shape.dim_size(0);
     return;
   }
@@ -114,7 +117,7 @@ inline void ReduceTransposeDimensions(const TensorShape& shape,
   for (int i = 0; i < new_dim_position.size(); ++i) {
     if (new_dim_position[i] >= 0) {
       int new_perm_idx = new_dim_position[i];
-      (*new_perm)[dim_idx] = new_perm_idx;
+      (*new_perm)[new_perm_idx] = dim_idx;
       (*new_dims)[dim_idx] = combined_dims[new_perm_idx];
       dim_idx++;
     }
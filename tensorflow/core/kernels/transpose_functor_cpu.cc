@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -65,12 +67,217 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Tiles of the blocked transpose are kTransposeTile x kTransposeTile
+// elements, small enough for the source and destination of a tile to stay in
+// L1 or L2 cache, and wide enough for every row of a tile to span whole cache
+// lines.
+constexpr int64 kTransposeTile = 64;
+
+// Sets dst[i * dst_stride + j] = src[j * src_stride + i] for i in [0, cols)
+// and j in [0, rows).
+template <typename T>
+void TransposeBlockScalar(const T* src, int64 src_stride, int64 rows,
+                          int64 cols, T* dst, int64 dst_stride) {
+  for (int64 i = 0; i < cols; ++i) {
+    T* d = dst + i * dst_stride;
+    const T* s = src + i;
+    for (int64 j = 0; j < rows; ++j) d[j] = s[j * src_stride];
+  }
+}
+
+template <typename T>
+struct TransposeBlock {
+  static void run(const T* src, int64 src_stride, int64 rows, int64 cols,
+                  T* dst, int64 dst_stride) {
+    TransposeBlockScalar(src, src_stride, rows, cols, dst, dst_stride);
+  }
+};
+
+// 4- and 8-byte elements are moved through float and double packets, whose
+// loads and stores copy the bits unchanged, and are transposed in registers
+// kSize x kSize at a time.
+//
+// The packet types are vector types such as __m256, whose alignment attributes
+// GCC warns about dropping when they are used as template arguments. Eigen's
+// own packet code does the same, and nothing here depends on the alignment.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+template <typename T, typename Scalar>
+struct PacketTransposeBlock {
+  typedef typename Eigen::internal::packet_traits<Scalar>::type Packet;
+  static constexpr int kSize = Eigen::internal::unpacket_traits<Packet>::size;
+
+  static void run(const T* src, int64 src_stride, int64 rows, int64 cols,
+                  T* dst, int64 dst_stride) {
+    const Scalar* s = reinterpret_cast<const Scalar*>(src);
+    Scalar* d = reinterpret_cast<Scalar*>(dst);
+    const int64 full_rows = rows - rows % kSize;
+    const int64 full_cols = cols - cols % kSize;
+    for (int64 i = 0; i < full_cols; i += kSize) {
+      for (int64 j = 0; j < full_rows; j += kSize) {
+        Eigen::internal::PacketBlock<Packet, kSize> block;
+        for (int k = 0; k < kSize; ++k) {
+          block.packet[k] =
+              Eigen::internal::ploadu<Packet>(s + (j + k) * src_stride + i);
+        }
+        Eigen::internal::ptranspose(block);
+        for (int k = 0; k < kSize; ++k) {
+          Eigen::internal::pstoreu(d + (i + k) * dst_stride + j,
+                                   block.packet[k]);
+        }
+      }
+    }
+    // Leftover rows and columns.
+    TransposeBlockScalar(src + full_rows * src_stride, src_stride,
+                         rows - full_rows, full_cols, dst + full_rows,
+                         dst_stride);
+    TransposeBlockScalar(src + full_cols, src_stride, rows, cols - full_cols,
+                         dst + full_cols * dst_stride, dst_stride);
+  }
+};
+
+template <>
+struct TransposeBlock<uint32> : PacketTransposeBlock<uint32, float> {};
+
+template <>
+struct TransposeBlock<uint64> : PacketTransposeBlock<uint64, double> {};
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+// Transposes `in` into `out` a tile at a time, where the two dimensions of a
+// tile are the innermost dimension of the input and the input dimension that
+// becomes the innermost one of the output. Both the reads and the writes of a
+// tile are then contiguous runs of kTransposeTile elements, where a plain
+// loop over the output strides through the input with at least one cache miss
+// per element. Tiles are distributed over the device's threads.
+//
+// Returns false without doing anything if the innermost dimension stays in
+// place, which Eigen's shuffle handles with contiguous copies already.
+template <typename T>
+bool TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  // Merge the dimensions that stay adjacent, so that the innermost input and
+  // output dimensions are as large as possible.
+  internal::TransposePermsVec new_perm;
+  internal::TransposeDimsVec dims(in.dims());
+  internal::ReduceTransposeDimensions(in.shape(), perm, &new_perm, &dims);
+  const int ndims = dims.size();
+  // The tile dimensions: `a` is contiguous in the input and `b` in the output.
+  const int a = ndims - 1;
+  const int b = new_perm[ndims - 1];
+  if (a == b) return false;
+
+  // Strides of every input dimension in the input and in the output.
+  gtl::InlinedVector<int64, 8> in_strides(ndims);
+  gtl::InlinedVector<int64, 8> out_strides(ndims);
+  int64 stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    in_strides[i] = stride;
+    stride *= dims[i];
+  }
+  stride = 1;
+  for (int i = ndims - 1; i >= 0; --i) {
+    out_strides[new_perm[i]] = stride;
+    stride *= dims[new_perm[i]];
+  }
+
+  // The remaining dimensions, iterated over outside of the tiles.
+  gtl::InlinedVector<int64, 8> outer_dims;
+  gtl::InlinedVector<int64, 8> outer_in_strides;
+  gtl::InlinedVector<int64, 8> outer_out_strides;
+  int64 num_outer = 1;
+  for (int i = 0; i < ndims; ++i) {
+    if (i == a || i == b) continue;
+    outer_dims.push_back(dims[i]);
+    outer_in_strides.push_back(in_strides[i]);
+    outer_out_strides.push_back(out_strides[i]);
+    num_outer *= dims[i];
+  }
+  auto outer_offsets = [&outer_dims, &outer_in_strides, &outer_out_strides](
+                           int64 index, int64* in_offset, int64* out_offset) {
+    *in_offset = 0;
+    *out_offset = 0;
+    for (int i = outer_dims.size() - 1; i >= 0; --i) {
+      const int64 k = index % outer_dims[i];
+      index /= outer_dims[i];
+      *in_offset += k * outer_in_strides[i];
+      *out_offset += k * outer_out_strides[i];
+    }
+  };
+
+  const T* src = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* dst = reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data()));
+  const int64 size_a = dims[a];
+  const int64 size_b = dims[b];
+  const int64 src_stride = in_strides[b];
+  const int64 dst_stride = out_strides[a];
+  const int64 tiles_a = (size_a + kTransposeTile - 1) / kTransposeTile;
+  const int64 tiles_b = (size_b + kTransposeTile - 1) / kTransposeTile;
+  auto transpose_tiles = [&, src, dst](int64 begin, int64 end) {
+    for (int64 tile = begin; tile < end; ++tile) {
+      const int64 tile_a = tile % tiles_a;
+      const int64 tile_b = (tile / tiles_a) % tiles_b;
+      int64 in_offset, out_offset;
+      outer_offsets(tile / (tiles_a * tiles_b), &in_offset, &out_offset);
+      const int64 a0 = tile_a * kTransposeTile;
+      const int64 b0 = tile_b * kTransposeTile;
+      TransposeBlock<T>::run(
+          src + in_offset + b0 * src_stride + a0, src_stride,
+          std::min(kTransposeTile, size_b - b0),
+          std::min(kTransposeTile, size_a - a0),
+          dst + out_offset + a0 * dst_stride + b0, dst_stride);
+    }
+  };
+  const int64 tile_bytes = kTransposeTile * kTransposeTile * sizeof(T);
+  Eigen::TensorOpCost cost(/*bytes_loaded=*/tile_bytes,
+                           /*bytes_stored=*/tile_bytes,
+                           /*compute_cycles=*/kTransposeTile * kTransposeTile);
+  device.parallelFor(num_outer * tiles_a * tiles_b, cost,
+                     std::move(transpose_tiles));
+  return true;
+}
+
+// Element types that are copied with the blocked transpose. Conjugation and
+// strings keep going through Eigen and TransposeSimple.
+template <typename T, bool conjugate>
+struct UseTiledTranspose {
+  static constexpr bool value =
+      !conjugate && (std::is_same<T, uint8>::value ||
+                     std::is_same<T, uint16>::value ||
+                     std::is_same<T, uint32>::value ||
+                     std::is_same<T, uint64>::value ||
+                     std::is_same<T, complex128>::value);
+};
+
+template <typename T>
+bool MaybeTransposeTiled(const CPUDevice& device, const Tensor& in,
+                         const gtl::ArraySlice<int32> perm, Tensor* out,
+                         std::true_type) {
+  return TransposeTiled<T>(device, in, perm, out);
+}
+
+template <typename T>
+bool MaybeTransposeTiled(const CPUDevice& device, const Tensor& in,
+                         const gtl::ArraySlice<int32> perm, Tensor* out,
+                         std::false_type) {
+  return false;
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (MaybeTransposeTiled<T>(
+            d, in, perm, out,
+            std::integral_constant<bool,
+                                   UseTiledTranspose<T, conjugate>::value>())) {
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,13 +13,21 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
 class TransposeUtilTest : public ::testing::Test {
  protected:
   void TestDimensionReduction(const TensorShape& shape,
@@ -70,6 +78,15 @@ TEST_F(TransposeUtilTest, NormalDimensionReduction) {
 
   TestDimensionReduction({2, 3, 4}, {1, 2, 0}, {1, 0}, {2, 12});
 
+  TestDimensionReduction({2, 3, 4, 5}, {2, 0, 3, 1}, {2, 0, 3, 1},
+                         {2, 3, 4, 5});
+
+  TestDimensionReduction({2, 3, 4, 5}, {1, 3, 0, 2}, {1, 3, 0, 2},
+                         {2, 3, 4, 5});
+
+  TestDimensionReduction({2, 3, 4, 5, 6}, {1, 2, 4, 0, 3}, {1, 3, 0, 2},
+                         {2, 12, 5, 6});
+
   TestDimensionReduction({2, 3, 4, 5}, {2, 3, 0, 1}, {1, 0}, {6, 20});
 
   TestDimensionReduction({2, 3, 4, 5}, {1, 2, 3, 0}, {1, 0}, {2, 60});
@@ -130,4 +147,103 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+// Transposes a tensor of consecutive values with DoTranspose and compares the
+// result with an element by element transpose.
+template <typename T>
+void TestTranspose(const CPUDevice& device, const TensorShape& shape,
+                   const gtl::ArraySlice<int32>& perm) {
+  Tensor in(DataTypeToEnum<T>::value, shape);
+  auto in_flat = in.flat<T>();
+  for (int64 i = 0; i < in.NumElements(); ++i) {
+    in_flat(i) = static_cast<T>(i % 251);
+  }
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+  Tensor out(DataTypeToEnum<T>::value, out_shape);
+  TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+
+  Tensor expected(DataTypeToEnum<T>::value, out_shape);
+  auto expected_flat = expected.flat<T>();
+  const int ndims = shape.dims();
+  for (int64 o = 0; o < out.NumElements(); ++o) {
+    int64 in_index = 0;
+    int64 rest = o;
+    int64 out_stride = out.NumElements();
+    for (int d = 0; d < ndims; ++d) {
+      out_stride /= out_shape.dim_size(d);
+      const int64 k = rest / out_stride;
+      rest -= k * out_stride;
+      int64 in_stride = 1;
+      for (int e = perm[d] + 1; e < ndims; ++e) in_stride *= shape.dim_size(e);
+      in_index += k * in_stride;
+    }
+    expected_flat(o) = in_flat(in_index);
+  }
+  test::ExpectTensorEqual<T>(expected, out);
+}
+
+TEST(TransposeFunctorTest, Transpose) {
+  Eigen::ThreadPool pool(4);
+  CPUDevice device(&pool, 4);
+  const std::vector<std::vector<int32>> perms3 = {
+      {0, 2, 1}, {1, 0, 2}, {2, 1, 0}, {1, 2, 0}, {2, 0, 1}};
+  // Shapes with dimensions smaller than, equal to and larger than a tile.
+  for (const TensorShape& shape :
+       {TensorShape({3, 5, 7}), TensorShape({1, 65, 129}),
+        TensorShape({40, 9, 100}), TensorShape({2, 64, 3})}) {
+    for (const auto& perm : perms3) {
+      TestTranspose<uint8>(device, shape, perm);
+      TestTranspose<int16>(device, shape, perm);
+      TestTranspose<float>(device, shape, perm);
+      TestTranspose<double>(device, shape, perm);
+      TestTranspose<complex128>(device, shape, perm);
+    }
+  }
+  // NHWC <-> NCHW, and a rank that Eigen is not used for.
+  TestTranspose<float>(device, TensorShape({3, 17, 33, 5}), {0, 3, 1, 2});
+  TestTranspose<float>(device, TensorShape({3, 5, 17, 33}), {0, 2, 3, 1});
+  // Permutations that are not their own inverse.
+  for (const auto& perm : std::vector<std::vector<int32>>{
+           {2, 0, 3, 1}, {1, 3, 0, 2}, {3, 0, 2, 1}}) {
+    TestTranspose<uint8>(device, TensorShape({3, 4, 5, 6}), perm);
+    TestTranspose<float>(device, TensorShape({3, 70, 5, 67}), perm);
+    TestTranspose<complex128>(device, TensorShape({3, 4, 5, 6}), perm);
+  }
+  TestTranspose<int64>(device, TensorShape({2, 3, 4, 5, 6, 7}),
+                       {5, 1, 0, 3, 2, 4});
+}
+
+static void BM_Transpose(int iters, const TensorShape& shape,
+                         const gtl::ArraySlice<int32>& perm) {
+  testing::StopTiming();
+  Eigen::ThreadPool pool(port::NumSchedulableCPUs());
+  CPUDevice device(&pool, port::NumSchedulableCPUs());
+  Tensor in(DT_FLOAT, shape);
+  in.flat<float>().setRandom();
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(shape.dim_size(d));
+  Tensor out(DT_FLOAT, out_shape);
+  testing::BytesProcessed(static_cast<int64>(iters) * 2 * in.TotalBytes());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(DoTranspose(device, in, perm, &out));
+  }
+}
+
+static void BM_NHWCToNCHW(int iters, int channels) {
+  BM_Transpose(iters, TensorShape({32, 56, 56, channels}), {0, 3, 1, 2});
+}
+BENCHMARK(BM_NHWCToNCHW)->Arg(3)->Arg(64)->Arg(256);
+
+static void BM_NCHWToNHWC(int iters, int channels) {
+  BM_Transpose(iters, TensorShape({32, channels, 56, 56}), {0, 2, 3, 1});
+}
+BENCHMARK(BM_NCHWToNHWC)->Arg(3)->Arg(64)->Arg(256);
+
+// [batch, length, heads, depth] -> [batch, heads, depth, length].
+static void BM_AttentionHeadsTranspose(int iters, int length) {
+  BM_Transpose(iters, TensorShape({16, length, 16, 64}), {0, 2, 3, 1});
+}
+BENCHMARK(BM_AttentionHeadsTranspose)->Arg(128)->Arg(512);
+
 }  // namespace tensorflow
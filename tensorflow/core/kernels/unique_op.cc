@@ -13,9 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -23,12 +24,165 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// 1-D inputs with at least this many elements are processed by
+// ParallelUnique when more than one thread is available.
+const int64 kParallelUniqueMinSize = 256 * 1024;
+
+// Upper bound on the number of hash partitions used by ParallelUnique.
+const int kMaxUniquePartitions = 64;
+
+// Number of input elements per block in the order-restoring passes of
+// ParallelUnique.
+const int64 kUniqueBlockSize = 64 * 1024;
+
+// Hash tables are pre-sized for at most this many unique elements; larger
+// tables grow as needed instead of allocating for a worst case that inputs
+// with many repeated ids never reach.
+const int64 kUniqueMaxInitialSize = 64 * 1024;
+
+// Finalizes a hash value so that all of its bits depend on all bits of the
+// key. std::hash is the identity for integers, and FlatMap picks buckets from
+// the high bits of the hash, so consecutive ids would otherwise share buckets.
+inline uint64 MixUniqueHash(uint64 h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <typename T>
+struct UniqueHash {
+  size_t operator()(const T& t) const {
+    return static_cast<size_t>(MixUniqueHash(hash<T>()(t)));
+  }
+};
+
+// Finds the unique elements of `input` like the single-threaded loop in
+// UniqueOp::Compute: sets `idx(i)` to the index of `input(i)` among the unique
+// elements in order of first occurrence, and appends the position of the
+// first occurrence of each unique element to `first_pos`.
+//
+// The keys are split into hash partitions, and the positions of each partition
+// are bucketed with a stable counting sort. Each partition is inserted into its
+// own table by one shard, which only visits the positions in its bucket. The
+// partition-local indices are then renumbered in order of first occurrence by
+// two passes over blocks of the input.
+template <typename T, typename TIndex>
+void ParallelUnique(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    typename TTypes<T>::ConstFlat input,
+                    typename TTypes<TIndex>::Vec idx,
+                    std::vector<int64>* first_pos) {
+  const int64 n = input.size();
+  const int num_partitions =
+      std::min(worker_threads.num_threads, kMaxUniquePartitions);
+  const UniqueHash<T> hasher;
+
+  std::vector<uint8> partition(n);
+  auto assign_partitions = [&](int64 start, int64 end) {
+    for (int64 i = start; i < end; ++i) {
+      partition[i] = (MixUniqueHash(hasher(input(i))) >> 32) % num_partitions;
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, n, 20,
+        assign_partitions);
+
+  // The positions of partition p are order[partition_start[p]] to
+  // order[partition_start[p + 1] - 1], in increasing order.
+  std::vector<int64> partition_start(num_partitions + 1, 0);
+  for (int64 i = 0; i < n; ++i) ++partition_start[partition[i] + 1];
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_start[p + 1] += partition_start[p];
+  }
+  std::vector<int64> order(n);
+  {
+    std::vector<int64> next(partition_start.begin(), partition_start.end() - 1);
+    for (int64 i = 0; i < n; ++i) order[next[partition[i]]++] = i;
+  }
+
+  // For each partition, the positions of the first occurrences of its keys.
+  std::vector<std::vector<int64>> partition_first_pos(num_partitions);
+  std::vector<uint8> is_first(n, 0);
+  auto insert_partitions = [&](int64 start, int64 end) {
+    for (int64 p = start; p < end; ++p) {
+      const int64 begin = partition_start[p];
+      const int64 limit = partition_start[p + 1];
+      gtl::FlatMap<T, TIndex, UniqueHash<T>> uniq(
+          std::min(limit - begin, kUniqueMaxInitialSize));
+      std::vector<int64>& firsts = partition_first_pos[p];
+      for (int64 k = begin; k < limit; ++k) {
+        const int64 i = order[k];
+        auto it = uniq.insert(
+            std::make_pair(input(i), static_cast<TIndex>(firsts.size())));
+        if (it.second) {
+          firsts.push_back(i);
+          is_first[i] = 1;
+        }
+        idx(i) = it.first->second;
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+        n / num_partitions * 20, insert_partitions);
+
+  // Number the first occurrences in input order. block_start[b] is the number
+  // of first occurrences before block b.
+  const int64 num_blocks = (n + kUniqueBlockSize - 1) / kUniqueBlockSize;
+  std::vector<int64> block_start(num_blocks + 1, 0);
+  auto count_firsts = [&](int64 start, int64 end) {
+    for (int64 b = start; b < end; ++b) {
+      const int64 limit = std::min(n, (b + 1) * kUniqueBlockSize);
+      int64 count = 0;
+      for (int64 i = b * kUniqueBlockSize; i < limit; ++i) count += is_first[i];
+      block_start[b + 1] = count;
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        kUniqueBlockSize, count_firsts);
+  for (int64 b = 0; b < num_blocks; ++b) block_start[b + 1] += block_start[b];
+
+  std::vector<std::vector<TIndex>> global_index(num_partitions);
+  for (int p = 0; p < num_partitions; ++p) {
+    global_index[p].resize(partition_first_pos[p].size());
+  }
+  first_pos->resize(block_start[num_blocks]);
+  auto number_firsts = [&](int64 start, int64 end) {
+    for (int64 b = start; b < end; ++b) {
+      const int64 limit = std::min(n, (b + 1) * kUniqueBlockSize);
+      int64 next = block_start[b];
+      for (int64 i = b * kUniqueBlockSize; i < limit; ++i) {
+        if (!is_first[i]) continue;
+        global_index[partition[i]][idx(i)] = next;
+        (*first_pos)[next++] = i;
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        kUniqueBlockSize * 2, number_firsts);
+
+  auto renumber = [&](int64 start, int64 end) {
+    for (int64 b = start; b < end; ++b) {
+      const int64 limit = std::min(n, (b + 1) * kUniqueBlockSize);
+      for (int64 i = b * kUniqueBlockSize; i < limit; ++i) {
+        idx(i) = global_index[partition[i]][idx(i)];
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+        kUniqueBlockSize * 2, renumber);
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -105,17 +259,26 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
-      std::unordered_map<T, TIndex> uniq;
-      uniq.reserve(2 * N);
-      for (int64 i = 0, j = 0; i < N; ++i) {
-        auto it = uniq.insert(std::make_pair(Tin(i), j));
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
+      // Position of the first occurrence of each unique element.
+      std::vector<int64> first_pos;
+      const DeviceBase::CpuWorkerThreads& worker_threads =
+          *context->device()->tensorflow_cpu_worker_threads();
+      if (N >= kParallelUniqueMinSize && worker_threads.num_threads > 1) {
+        ParallelUnique<T, TIndex>(worker_threads, Tin, idx_vec, &first_pos);
+      } else {
+        gtl::FlatMap<T, TIndex, UniqueHash<T>> uniq(
+            std::min(N, kUniqueMaxInitialSize));
+        for (int64 i = 0; i < N; ++i) {
+          auto it = uniq.insert(
+              std::make_pair(Tin(i), static_cast<TIndex>(first_pos.size())));
+          idx_vec(i) = it.first->second;
+          if (it.second) {
+            first_pos.push_back(i);
+          }
         }
       }
 
-      uniq_size = static_cast<int64>(uniq.size());
+      uniq_size = static_cast<int64>(first_pos.size());
       TensorShape output_shape(input.shape());
       output_shape.set_dim(axis, uniq_size);
       Tensor* output = nullptr;
@@ -123,21 +286,21 @@ class UniqueOp : public OpKernel {
                      context->allocate_output(0, output_shape, &output));
       auto Tout = output->flat<T>();
 
-      for (auto it : uniq) {
-        Tout(it.second) = it.first;
+      for (int64 j = 0; j < uniq_size; ++j) {
+        Tout(j) = Tin(first_pos[j]);
       }
     } else {
       // General implementation when unique is run over multiple elements.
       auto Tin = input.shaped<T, 3>(new_sizes);
 
       auto hash_fn = [&Tin](const int64& key) {
-        size_t h = 0;
+        uint64 h = 0;
         for (int64 i = 0; i < Tin.dimension(0); i++) {
           for (int64 j = 0; j < Tin.dimension(2); j++) {
             h = Hash64Combine(h, hash<T>{}(Tin(i, key, j)));
           }
         }
-        return h;
+        return static_cast<size_t>(MixUniqueHash(h));
       };
 
       auto equal_to_fn = [&Tin](const int64& lhs, const int64& rhs) {
@@ -151,10 +314,9 @@ class UniqueOp : public OpKernel {
         return true;
       };
 
-      std::unordered_map<int64, int64, decltype(hash_fn), decltype(equal_to_fn)>
-          uniq(0, hash_fn, equal_to_fn);
-
-      uniq.reserve(2 * Tin.dimension(1));
+      gtl::FlatMap<int64, int64, decltype(hash_fn), decltype(equal_to_fn)> uniq(
+          std::min<int64>(Tin.dimension(1), kUniqueMaxInitialSize), hash_fn,
+          equal_to_fn);
 
       for (int64 i = 0, j = 0; i < Tin.dimension(1); ++i) {
         auto it = uniq.insert(std::make_pair(i, j));
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -35,6 +40,76 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op, DataType type) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", op)
+                     .Input(FakeInput(type))
+                     .Attr("out_idx", DT_INT32)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(UniqueOpTest, Simple) {
+  MakeOp("Unique", DT_INT64);
+  AddInputFromArray<int64>(TensorShape({8}), {7, 2, 7, -1, 2, 2, 9, 7});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_y(allocator(), DT_INT64, TensorShape({4}));
+  test::FillValues<int64>(&expected_y, {7, 2, -1, 9});
+  test::ExpectTensorEqual<int64>(expected_y, *GetOutput(0));
+  Tensor expected_idx(allocator(), DT_INT32, TensorShape({8}));
+  test::FillValues<int32>(&expected_idx, {0, 1, 0, 2, 1, 1, 3, 0});
+  test::ExpectTensorEqual<int32>(expected_idx, *GetOutput(1));
+}
+
+TEST_F(UniqueOpTest, WithCounts) {
+  MakeOp("UniqueWithCounts", DT_STRING);
+  AddInputFromArray<string>(TensorShape({5}), {"b", "a", "b", "c", "b"});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_y(allocator(), DT_STRING, TensorShape({3}));
+  test::FillValues<string>(&expected_y, {"b", "a", "c"});
+  test::ExpectTensorEqual<string>(expected_y, *GetOutput(0));
+  Tensor expected_idx(allocator(), DT_INT32, TensorShape({5}));
+  test::FillValues<int32>(&expected_idx, {0, 1, 0, 2, 0});
+  test::ExpectTensorEqual<int32>(expected_idx, *GetOutput(1));
+  Tensor expected_count(allocator(), DT_INT32, TensorShape({3}));
+  test::FillValues<int32>(&expected_count, {3, 1, 1});
+  test::ExpectTensorEqual<int32>(expected_count, *GetOutput(2));
+}
+
+// Large enough to be split into hash partitions when the test runs with
+// several threads. The result must not depend on how it is computed.
+TEST_F(UniqueOpTest, Large) {
+  MakeOp("Unique", DT_INT64);
+  const int n = 1 << 20;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int64> x(n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = rnd.Uniform64(100000);
+  }
+  AddInputFromArray<int64>(TensorShape({n}), x);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unordered_map<int64, int32> index;
+  std::vector<int64> expected_y;
+  std::vector<int32> expected_idx(n);
+  for (int i = 0; i < n; ++i) {
+    auto it = index.insert({x[i], static_cast<int32>(expected_y.size())});
+    if (it.second) expected_y.push_back(x[i]);
+    expected_idx[i] = it.first->second;
+  }
+  test::ExpectTensorEqual<int64>(
+      test::AsTensor<int64>(expected_y,
+                            {static_cast<int64>(expected_y.size())}),
+      *GetOutput(0));
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>(expected_idx, {n}),
+                                 *GetOutput(1));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
@@ -18,6 +18,10 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/kernels/xent_op.h"
+
+#include <algorithm>
+#include <cmath>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -92,6 +96,82 @@ struct XentFunctorBase {
 template <typename T>
 struct XentFunctor<CPUDevice, T> : XentFunctorBase<CPUDevice, T> {};
 
+// Rows are processed this many classes at a time, so that the several
+// vectorized sweeps over a chunk all read from L1 cache.
+static constexpr int64 kXentChunkSize = 2048;
+
+// Fused CPU implementation for float and double: each row is reduced to its
+// max in a first pass, and the loss and backprop are computed from the
+// exponentiated logits, which are kept in the backprop output, in two more
+// passes that reuse cached data. Rows are sharded over the device's threads.
+//
+// backprop may share its buffer with logits, so every chunk of logits is read
+// before the same chunk of backprop is written.
+template <typename T>
+struct XentFunctorCPU {
+  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
+                  typename TTypes<T>::ConstMatrix labels,
+                  typename TTypes<T>::Matrix scratch,
+                  typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Matrix backprop) {
+    typedef Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>> ConstArray;
+    typedef Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>> Array;
+    const int64 batch_size = logits.dimension(0);
+    const int64 num_classes = logits.dimension(1);
+    if (num_classes == 0) {
+      loss.setZero();
+      return;
+    }
+    const T* logits_data = logits.data();
+    const T* labels_data = labels.data();
+    T* loss_data = loss.data();
+    T* backprop_data = backprop.data();
+    auto compute_rows = [=](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const T* x = logits_data + i * num_classes;
+        const T* y = labels_data + i * num_classes;
+        T* b = backprop_data + i * num_classes;
+        const T max_logit = ConstArray(x, num_classes).maxCoeff();
+        // sum(exp(logits - max_logits)), sum(labels) and
+        // sum(labels * (logits - max_logits)).
+        T sum_exp = T(0);
+        T sum_labels = T(0);
+        T dot = T(0);
+        for (int64 j = 0; j < num_classes; j += kXentChunkSize) {
+          const int64 size = std::min(kXentChunkSize, num_classes - j);
+          ConstArray x_chunk(x + j, size);
+          ConstArray y_chunk(y + j, size);
+          dot += (y_chunk * (x_chunk - max_logit)).sum();
+          sum_labels += y_chunk.sum();
+          Array b_chunk(b + j, size);
+          b_chunk = (x_chunk - max_logit).exp();
+          sum_exp += b_chunk.sum();
+        }
+        // sum(labels * (log(sum_exp) - (logits - max_logits))).
+        loss_data[i] = sum_labels * std::log(sum_exp) - dot;
+        // backprop: prob - labels.
+        const T inv_sum_exp = T(1) / sum_exp;
+        Array(b, num_classes) =
+            Array(b, num_classes) * inv_sum_exp - ConstArray(y, num_classes);
+      }
+    };
+    const double bytes = num_classes * sizeof(T);
+    const Eigen::TensorOpCost cost(
+        /*bytes_loaded=*/2 * bytes, /*bytes_stored=*/bytes,
+        /*compute_cycles=*/num_classes *
+            (Eigen::internal::functor_traits<
+                 Eigen::internal::scalar_exp_op<T>>::Cost +
+             6 * Eigen::TensorOpCost::AddCost<T>()));
+    d.parallelFor(batch_size, cost, std::move(compute_rows));
+  }
+};
+
+template <>
+struct XentFunctor<CPUDevice, float> : XentFunctorCPU<float> {};
+
+template <>
+struct XentFunctor<CPUDevice, double> : XentFunctorCPU<double> {};
+
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T>
 struct XentFunctor<SYCLDevice, T> : XentFunctorBase<SYCLDevice, T> {};
@@ -20,12 +20,16 @@ limitations under the License.
 
 #include <stdint.h>
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 namespace crc32c {
 
 extern bool CanAccelerate();
 extern uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size);
+extern bool CanAccelerateMultiStream();
+extern uint32_t AcceleratedExtendMultiStream(uint32_t crc, const char *buf,
+                                             size_t size);
 
 static const uint32 table0_[256] = {
     0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
@@ -211,6 +215,13 @@ static inline uint32_t LE_LOAD32(const uint8_t *p) {
 
 uint32 Extend(uint32 crc, const char *buf, size_t size) {
   static bool can_accelerate = CanAccelerate();
+  static bool can_accelerate_multi_stream =
+      CanAccelerateMultiStream() &&
+      port::TestCPUFeature(port::CPUFeature::SSE4_2) &&
+      port::TestCPUFeature(port::CPUFeature::PCLMULQDQ);
+  if (can_accelerate_multi_stream) {
+    return AcceleratedExtendMultiStream(crc, buf, size);
+  }
   if (can_accelerate) {
     return AcceleratedExtend(crc, buf, size);
   }
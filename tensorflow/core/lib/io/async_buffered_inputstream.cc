@@ -0,0 +1,188 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/async_buffered_inputstream.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+AsyncBufferedInputStream::AsyncBufferedInputStream(RandomAccessFile* file,
+                                                   size_t buffer_bytes)
+    : file_(file), size_(buffer_bytes) {
+  thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "async_buffered_input_stream", [this] {
+        PrefetchLoop();
+      }));
+  mutex_lock l(mu_);
+  StartPrefetchLocked();
+}
+
+AsyncBufferedInputStream::~AsyncBufferedInputStream() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+  cond_var_.notify_all();
+  // Joins the background thread.
+  thread_.reset();
+}
+
+void AsyncBufferedInputStream::PrefetchLoop() {
+  while (true) {
+    Buffer* buffer;
+    uint64 offset;
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && (prefetch_buffer_ == nullptr || prefetch_done_)) {
+        cond_var_.wait(l);
+      }
+      if (cancelled_) return;
+      buffer = prefetch_buffer_;
+      offset = prefetch_offset_;
+    }
+
+    // The buffer keeps its size between full reads, so this only clears
+    // memory after a short read.
+    buffer->data.resize(size_);
+    StringPiece data;
+    buffer->status = file_->Read(offset, size_, &data, &buffer->data[0]);
+    if (data.data() != buffer->data.data()) {
+      // RandomAccessFile placed the data in some other location.
+      memmove(&buffer->data[0], data.data(), data.size());
+    }
+    buffer->data.resize(data.size());
+
+    {
+      mutex_lock l(mu_);
+      prefetch_offset_ += data.size();
+      prefetch_done_ = true;
+    }
+    cond_var_.notify_all();
+  }
+}
+
+void AsyncBufferedInputStream::StartPrefetchLocked() {
+  prefetch_buffer_ = &buffers_[1 - current_];
+  prefetch_done_ = false;
+  cond_var_.notify_all();
+}
+
+Status AsyncBufferedInputStream::SwapBuffers() {
+  if (!file_status_.ok()) {
+    return file_status_;
+  }
+  mutex_lock l(mu_);
+  while (!prefetch_done_) {
+    cond_var_.wait(l);
+  }
+  prefetch_buffer_ = nullptr;
+  current_ = 1 - current_;
+  pos_ = 0;
+  const Buffer& buffer = buffers_[current_];
+  if (!buffer.status.ok()) {
+    // The end of the file or an error; stop prefetching, and report the
+    // status once the remaining data has been consumed.
+    file_status_ = buffer.status;
+    return buffer.data.empty() ? file_status_ : Status::OK();
+  }
+  StartPrefetchLocked();
+  return Status::OK();
+}
+
+Status AsyncBufferedInputStream::ReadNBytes(int64 bytes_to_read,
+                                            string* result) {
+  result->clear();
+  return AppendNBytes(bytes_to_read, result);
+}
+
+Status AsyncBufferedInputStream::AppendNBytes(int64 bytes_to_read,
+                                              string* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->reserve(result->size() + bytes_to_read);
+  Status s;
+  while (bytes_to_read > 0) {
+    const string& data = buffers_[current_].data;
+    if (pos_ == data.size()) {
+      s = SwapBuffers();
+      if (pos_ == buffers_[current_].data.size()) {
+        DCHECK(!s.ok());
+        break;
+      }
+      continue;
+    }
+    const size_t bytes_to_copy =
+        std::min<int64>(data.size() - pos_, bytes_to_read);
+    result->append(data, pos_, bytes_to_copy);
+    pos_ += bytes_to_copy;
+    position_ += bytes_to_copy;
+    bytes_to_read -= bytes_to_copy;
+  }
+  // Reaching the end of the file only matters if it cut the read short.
+  return bytes_to_read > 0 ? s : Status::OK();
+}
+
+Status AsyncBufferedInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  Status s;
+  while (bytes_to_skip > 0) {
+    const size_t available = buffers_[current_].data.size() - pos_;
+    if (available == 0) {
+      s = SwapBuffers();
+      if (pos_ == buffers_[current_].data.size()) {
+        DCHECK(!s.ok());
+        break;
+      }
+      continue;
+    }
+    const size_t bytes_skipped = std::min<int64>(available, bytes_to_skip);
+    pos_ += bytes_skipped;
+    position_ += bytes_skipped;
+    bytes_to_skip -= bytes_skipped;
+  }
+  return bytes_to_skip > 0 ? s : Status::OK();
+}
+
+int64 AsyncBufferedInputStream::Tell() const { return position_; }
+
+Status AsyncBufferedInputStream::Reset() {
+  mutex_lock l(mu_);
+  // Let an outstanding read finish before its buffer is reused.
+  while (prefetch_buffer_ != nullptr && !prefetch_done_) {
+    cond_var_.wait(l);
+  }
+  buffers_[0].data.clear();
+  buffers_[1].data.clear();
+  current_ = 0;
+  pos_ = 0;
+  position_ = 0;
+  file_status_ = Status::OK();
+  prefetch_offset_ = 0;
+  StartPrefetchLocked();
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
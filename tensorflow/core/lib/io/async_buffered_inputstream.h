@@ -0,0 +1,101 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_ASYNC_BUFFERED_INPUTSTREAM_H_
+#define TENSORFLOW_LIB_IO_ASYNC_BUFFERED_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace io {
+
+// Reads a file sequentially through two buffers of `buffer_bytes` each.
+// While the caller consumes one buffer, a background thread reads the
+// following bytes of the file into the other one, so that reading from the
+// file overlaps with processing the data that was already read.
+//
+// A single instance of AsyncBufferedInputStream is NOT safe for concurrent use
+// by multiple threads.
+class AsyncBufferedInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of file. file must outlive *this.
+  AsyncBufferedInputStream(RandomAccessFile* file, size_t buffer_bytes);
+
+  ~AsyncBufferedInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  // Like ReadNBytes(), but appends the bytes to *result instead of replacing
+  // its contents.
+  Status AppendNBytes(int64 bytes_to_read, string* result);
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct Buffer {
+    string data;
+    // The status of the read that filled `data`.
+    Status status;
+  };
+
+  // Body of the background thread.
+  void PrefetchLoop();
+
+  // Starts reading the next part of the file into the buffer that is not
+  // current.
+  void StartPrefetchLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Waits for the buffer that is being prefetched and makes it current.
+  Status SwapBuffers();
+
+  RandomAccessFile* const file_;  // not owned.
+  const size_t size_;             // buffer size.
+
+  // Only the consumer accesses these, and the buffer that is not current is
+  // owned by the background thread while `prefetch_buffer_` is set.
+  Buffer buffers_[2];
+  int current_ = 0;
+  size_t pos_ = 0;       // current position in buffers_[current_].data.
+  int64 position_ = 0;   // offset of the current position in the file.
+  // Once the end of the file or an error is reached, the status to return
+  // when the current buffer runs out.
+  Status file_status_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  Buffer* prefetch_buffer_ GUARDED_BY(mu_) = nullptr;
+  bool prefetch_done_ GUARDED_BY(mu_) = false;
+  uint64 prefetch_offset_ GUARDED_BY(mu_) = 0;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncBufferedInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_ASYNC_BUFFERED_INPUTSTREAM_H_
@@ -0,0 +1,195 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/async_buffered_inputstream.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() {
+  return {1,  2,  3,  4,  5,  6,  7,  8,  9,  10,   11,
+          12, 13, 14, 15, 16, 17, 18, 19, 20, 65536};
+}
+
+TEST(AsyncBufferedInputStream, ReadNBytes) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/async_buffered_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    string read;
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(0, &read));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "3456");
+    EXPECT_EQ(7, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "789");
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(10, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(0, &read));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST(AsyncBufferedInputStream, AppendNBytes) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/async_buffered_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    string read = "x";
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    TF_ASSERT_OK(in.AppendNBytes(3, &read));
+    EXPECT_EQ(read, "x012");
+    TF_ASSERT_OK(in.AppendNBytes(4, &read));
+    EXPECT_EQ(read, "x0123456");
+    EXPECT_TRUE(errors::IsOutOfRange(in.AppendNBytes(5, &read)));
+    EXPECT_EQ(read, "x0123456789");
+  }
+}
+
+TEST(AsyncBufferedInputStream, SkipNBytes) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/async_buffered_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    string read;
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.SkipNBytes(3));
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.SkipNBytes(0));
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "34");
+    EXPECT_EQ(5, in.Tell());
+    TF_ASSERT_OK(in.SkipNBytes(2));
+    EXPECT_EQ(7, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(1, &read));
+    EXPECT_EQ(read, "7");
+    EXPECT_EQ(8, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST(AsyncBufferedInputStream, Reset) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/async_buffered_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    string read;
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "0123");
+    TF_ASSERT_OK(in.Reset());
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "0123");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(10, &read)));
+    TF_ASSERT_OK(in.Reset());
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(read, "0123456789");
+  }
+}
+
+TEST(AsyncBufferedInputStream, LargeFile) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/async_buffered_inputstream_test";
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  string contents(1 << 20, '\0');
+  for (char& c : contents) {
+    c = static_cast<char>(rnd.Uniform(256));
+  }
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (int buf_size : {4096, 65536, 1 << 20, 2 << 20}) {
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    string read;
+    string all;
+    while (all.size() < contents.size()) {
+      const int64 bytes_to_read = rnd.Uniform(3 * buf_size);
+      const size_t expected_size =
+          std::min<size_t>(contents.size() - all.size(), bytes_to_read);
+      Status s = in.ReadNBytes(bytes_to_read, &read);
+      EXPECT_TRUE(s.ok() || errors::IsOutOfRange(s));
+      ASSERT_EQ(expected_size, read.size());
+      all.append(read);
+    }
+    EXPECT_EQ(contents, all);
+  }
+}
+
+void BM_AsyncBufferedReaderReadNBytes(int iters, int buff_size,
+                                      int read_size) {
+  testing::StopTiming();
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/async_buffered_inputstream_test";
+  const int file_size = 16 << 20;
+  TF_CHECK_OK(WriteStringToFile(env, fname, string(file_size, 'x')));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  string read;
+  testing::BytesProcessed(static_cast<int64>(iters) * file_size);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    AsyncBufferedInputStream in(file.get(), buff_size);
+    while (in.ReadNBytes(read_size, &read).ok()) {
+    }
+  }
+}
+BENCHMARK(BM_AsyncBufferedReaderReadNBytes)
+    ->ArgPair(256 << 10, 1 << 10)
+    ->ArgPair(256 << 10, 64 << 10)
+    ->ArgPair(1 << 20, 64 << 10);
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -15,11 +15,23 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 
+#include <string.h>
+
 #include "tensorflow/core/lib/io/random_inputstream.h"
 
 namespace tensorflow {
 namespace io {
 
+void AppendWithoutCarriageReturns(const char* begin, const char* end,
+                                  string* result) {
+  while (begin != end) {
+    const char* cr = static_cast<const char*>(memchr(begin, '\r', end - begin));
+    const char* chunk_end = cr != nullptr ? cr : end;
+    result->append(begin, chunk_end - begin);
+    begin = cr != nullptr ? cr + 1 : end;
+  }
+}
+
 BufferedInputStream::BufferedInputStream(InputStreamInterface* input_stream,
                                          size_t buffer_size,
                                          bool owns_input_stream)
@@ -67,17 +79,22 @@ Status BufferedInputStream::ReadLineHelper(string* result, bool include_eol) {
         break;
       }
     }
-    char c = buf_[pos_++];
-    if (c == '\n') {
+    // Scan the whole buffered span for the end of the line at once, rather
+    // than one character at a time; memchr is vectorized by the C library.
+    const char* start = buf_.data() + pos_;
+    const char* end = buf_.data() + limit_;
+    const char* newline =
+        static_cast<const char*>(memchr(start, '\n', end - start));
+    const char* line_end = newline != nullptr ? newline : end;
+    AppendWithoutCarriageReturns(start, line_end, result);
+    pos_ = line_end - buf_.data();
+    if (newline != nullptr) {
+      ++pos_;
       if (include_eol) {
-        *result += c;
+        result->push_back('\n');
       }
       return Status::OK();
     }
-    // We don't append '\r' to *result
-    if (c != '\r') {
-      *result += c;
-    }
   }
   if (errors::IsOutOfRange(s) && !result->empty()) {
     return Status::OK();
@@ -101,6 +101,11 @@ class BufferedInputStream : public InputStreamInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(BufferedInputStream);
 };
 
+// Appends [begin, end) to *result, dropping every '\r', as
+// `BufferedInputStream::ReadLine()` does.
+void AppendWithoutCarriageReturns(const char* begin, const char* end,
+                                  string* result);
+
 }  // namespace io
 }  // namespace tensorflow
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -153,6 +154,50 @@ TEST(BufferedInputStream, ReadLine_CRLF) {
   }
 }
 
+TEST(BufferedInputStream, ReadLine_LongLinesAndCarriageReturns) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/buffered_inputstream_test";
+  const string long_line(1000, 'x');
+  TF_ASSERT_OK(WriteStringToFile(
+      env, fname, strings::StrCat(long_line, "\na\rb\r\rc\n", long_line,
+                                  "\r\n\r")));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file.get()));
+    BufferedInputStream in(input_stream.get(), buf_size);
+    string line;
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, long_line);
+    // Carriage returns are dropped anywhere in a line.
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "abc");
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, long_line);
+    // A final line made only of carriage returns is not a line.
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+  }
+}
+
+TEST(BufferedInputStream, ReadLineAsString) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/buffered_inputstream_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "line one\r\nline two"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file.get()));
+    BufferedInputStream in(input_stream.get(), buf_size);
+    EXPECT_EQ("line one\n", in.ReadLineAsString());
+    EXPECT_EQ("line two", in.ReadLineAsString());
+    EXPECT_EQ("", in.ReadLineAsString());
+  }
+}
+
 TEST(BufferedInputStream, ReadNBytes) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/buffer_test";
@@ -402,6 +447,35 @@ BENCHMARK(BM_BufferedReaderSmallReads)
     ->ArgPair(1024 * 1024, 1024 * 1024)
     ->ArgPair(256 * 1024 * 1024, 1024);
 
+void BM_BufferedReaderReadLine(const int iters, const int line_length) {
+  testing::StopTiming();
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/buffered_inputstream_test";
+
+  const int64 file_size = 64 << 20;
+  const string file_line = strings::StrCat(string(line_length - 1, 'x'), "\n");
+  std::unique_ptr<WritableFile> write_file;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &write_file));
+  for (int64 i = 0; i < file_size / line_length; ++i) {
+    TF_ASSERT_OK(write_file->Append(file_line));
+  }
+  TF_ASSERT_OK(write_file->Close());
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  string line;
+  testing::BytesProcessed(static_cast<int64>(iters) * file_size);
+  testing::StartTiming();
+
+  for (int itr = 0; itr < iters; ++itr) {
+    BufferedInputStream in(file.get(), 256 << 10);
+    while (in.ReadLine(&line).ok()) {
+    }
+  }
+}
+BENCHMARK(BM_BufferedReaderReadLine)->Arg(16)->Arg(128)->Arg(4096);
+
 }  // anonymous namespace
 }  // namespace io
 }  // namespace tensorflow
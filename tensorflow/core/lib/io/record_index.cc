@@ -0,0 +1,135 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace io {
+
+string RecordIndex::IndexFilename(const string& filename) {
+  return strings::StrCat(filename, ".index");
+}
+
+void RecordIndex::AddRecord(uint64 offset) {
+  DCHECK_GT(interval_, 0);
+  if (num_records_ % interval_ == 0) {
+    offsets_.push_back(offset);
+  }
+  ++num_records_;
+}
+
+Status RecordIndex::Lookup(int64 record, uint64* offset,
+                           int64* records_to_skip) const {
+  if (record < 0 || record >= num_records_) {
+    return errors::OutOfRange("Record ", record, " is not in [0, ",
+                              num_records_, ")");
+  }
+  *offset = offsets_[record / interval_];
+  *records_to_skip = record % interval_;
+  return Status::OK();
+}
+
+void RecordIndex::ShardRange(int64 num_shards, int64 index, int64* begin,
+                             int64* end) const {
+  DCHECK_GT(num_shards, 0);
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, num_shards);
+  const int64 shard_size = num_records_ / num_shards;
+  const int64 remainder = num_records_ % num_shards;
+  // The first `remainder` shards read one extra record.
+  *begin = index * shard_size + std::min(index, remainder);
+  *end = *begin + shard_size + (index < remainder ? 1 : 0);
+}
+
+void RecordIndex::Encode(string* output) const {
+  output->clear();
+  core::PutVarint64(output, interval_);
+  core::PutVarint64(output, num_records_);
+  core::PutVarint64(output, offsets_.size());
+  uint64 previous = 0;
+  for (uint64 offset : offsets_) {
+    core::PutVarint64(output, offset - previous);
+    previous = offset;
+  }
+  core::PutFixed32(output,
+                   crc32c::Mask(crc32c::Value(output->data(), output->size())));
+}
+
+Status RecordIndex::Decode(StringPiece input, RecordIndex* index) {
+  if (input.size() < sizeof(uint32)) {
+    return errors::DataLoss("Truncated record index");
+  }
+  StringPiece body(input.data(), input.size() - sizeof(uint32));
+  const uint32 masked_crc = core::DecodeFixed32(body.data() + body.size());
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(body.data(), body.size())) {
+    return errors::DataLoss("Corrupted record index");
+  }
+
+  uint64 interval;
+  uint64 num_records;
+  uint64 num_offsets;
+  if (!core::GetVarint64(&body, &interval) ||
+      !core::GetVarint64(&body, &num_records) ||
+      !core::GetVarint64(&body, &num_offsets)) {
+    return errors::DataLoss("Truncated record index");
+  }
+  if (interval == 0 ||
+      num_offsets != (num_records + interval - 1) / interval) {
+    return errors::DataLoss("Invalid record index: interval ", interval,
+                            ", ", num_records, " records and ", num_offsets,
+                            " offsets");
+  }
+  index->interval_ = interval;
+  index->num_records_ = num_records;
+  index->offsets_.clear();
+  index->offsets_.reserve(num_offsets);
+  uint64 offset = 0;
+  for (uint64 i = 0; i < num_offsets; ++i) {
+    uint64 delta;
+    if (!core::GetVarint64(&body, &delta)) {
+      return errors::DataLoss("Truncated record index");
+    }
+    offset += delta;
+    index->offsets_.push_back(offset);
+  }
+  if (!body.empty()) {
+    return errors::DataLoss("Invalid record index: ", body.size(),
+                            " trailing bytes");
+  }
+  return Status::OK();
+}
+
+Status RecordIndex::ReadFromFile(Env* env, const string& fname,
+                                 RecordIndex* index) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, fname, &contents));
+  Status s = Decode(contents, index);
+  if (!s.ok()) {
+    return errors::DataLoss(s.error_message(), " in ", fname);
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
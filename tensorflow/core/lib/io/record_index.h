@@ -0,0 +1,92 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_LIB_IO_RECORD_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+
+namespace io {
+
+// A sparse index of an uncompressed TFRecord file, which is usually stored
+// next to the file as `IndexFilename(filename)`.
+//
+// The index holds the offset of every `interval()`-th record, so a reader can
+// position itself at any record after reading at most `interval() - 1` other
+// records. This makes it cheap to read a range of records (e.g. to split a
+// file between workers), or to read records in a shuffled order.
+//
+// Index file format:
+//   varint64  interval
+//   varint64  number of records
+//   varint64  number of offsets
+//   varint64  offset deltas, one for each indexed record
+//   uint32    masked crc of the preceding bytes
+class RecordIndex {
+ public:
+  RecordIndex() = default;
+  explicit RecordIndex(int64 interval) : interval_(interval) {}
+
+  // Returns the name of the index file for the TFRecord file `filename`.
+  static string IndexFilename(const string& filename);
+
+  // Records that the next record of the file starts at `offset`.
+  void AddRecord(uint64 offset);
+
+  // The number of records between two indexed records.
+  int64 interval() const { return interval_; }
+
+  // The number of records in the file.
+  int64 num_records() const { return num_records_; }
+
+  // Sets `*offset` to the offset of the last indexed record at or before
+  // record number `record`, and `*records_to_skip` to the number of records
+  // between the two. Returns OUT_OF_RANGE if the file has no such record.
+  Status Lookup(int64 record, uint64* offset, int64* records_to_skip) const;
+
+  // Sets `[*begin, *end)` to the range of records read by shard `index` of
+  // `num_shards`. The ranges are contiguous, cover every record, and differ
+  // in size by at most one record.
+  void ShardRange(int64 num_shards, int64 index, int64* begin,
+                  int64* end) const;
+
+  // Serializes the index to `*output`, in the index file format.
+  void Encode(string* output) const;
+
+  // Parses an index from `input`. Returns DATA_LOSS if `input` is not a valid
+  // index.
+  static Status Decode(StringPiece input, RecordIndex* index);
+
+  // Reads the index from the file `fname`.
+  static Status ReadFromFile(Env* env, const string& fname, RecordIndex* index);
+
+ private:
+  int64 interval_ = 0;
+  int64 num_records_ = 0;
+  std::vector<uint64> offsets_;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_RECORD_INDEX_H_
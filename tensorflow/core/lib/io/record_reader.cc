@@ -16,10 +16,12 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 
 #include <limits.h>
+#include <algorithm>
 
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/async_buffered_inputstream.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -28,6 +30,17 @@ limitations under the License.
 namespace tensorflow {
 namespace io {
 
+namespace {
+
+// The buffer size for asynchronous reads if none is given.
+constexpr size_t kDefaultAsyncBufferSize = 256 << 10;
+
+// The size of the pieces in which records are read and checksummed when
+// reading asynchronously. A piece should fit in the L2 cache.
+constexpr size_t kChecksumPieceSize = 64 << 10;
+
+}  // namespace
+
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
@@ -57,7 +70,11 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
     : src_(file), options_(options) {
-  if (options.buffer_size > 0) {
+  if (options.async_io) {
+    input_stream_.reset(new AsyncBufferedInputStream(
+        file, options.buffer_size > 0 ? options.buffer_size
+                                      : kDefaultAsyncBufferSize));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(file, options.buffer_size));
   } else {
     input_stream_.reset(new RandomAccessInputStream(file));
@@ -72,7 +89,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
         options.zlib_options.output_buffer_size, options.zlib_options));
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
-    // Nothing to do.
+    if (options.async_io) {
+      async_input_stream_ =
+          static_cast<AsyncBufferedInputStream*>(input_stream_.get());
+    }
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
@@ -86,6 +106,9 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
   if (n >= SIZE_MAX - sizeof(uint32)) {
     return errors::DataLoss("record size too large");
   }
+  if (async_input_stream_ != nullptr) {
+    return ReadChecksummedIncrementally(offset, n, result, storage);
+  }
 
   const size_t expected = n + sizeof(uint32);
   storage->resize(expected);
@@ -163,6 +186,42 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
   return Status::OK();
 }
 
+// Reads the n bytes in pieces, and extends the checksum right after each
+// piece has been copied out of the stream, while the piece is still in the
+// cache and the stream's background thread reads the data that follows.
+Status RecordReader::ReadChecksummedIncrementally(uint64 offset, size_t n,
+                                                  StringPiece* result,
+                                                  string* storage) {
+  storage->clear();
+  uint32 crc = 0;
+  Status s;
+  for (size_t remaining = n; remaining > 0 && s.ok();) {
+    const size_t piece_size = std::min(remaining, kChecksumPieceSize);
+    const size_t start = storage->size();
+    s = async_input_stream_->AppendNBytes(piece_size, storage);
+    crc = crc32c::Extend(crc, storage->data() + start, storage->size() - start);
+    remaining -= piece_size;
+  }
+  if (s.ok()) {
+    s = async_input_stream_->AppendNBytes(sizeof(uint32), storage);
+  }
+  if (errors::IsOutOfRange(s)) {
+    if (storage->empty()) {
+      return errors::OutOfRange("eof");
+    } else {
+      return errors::DataLoss("truncated record at ", offset);
+    }
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  const uint32 masked_crc = core::DecodeFixed32(storage->data() + n);
+  if (crc32c::Unmask(masked_crc) != crc) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  *result = StringPiece(storage->data(), n);
+  return Status::OK();
+}
+
 Status RecordReader::ReadRecord(uint64* offset, string* record) {
   static const size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
   static const size_t kFooterSize = sizeof(uint32);
@@ -202,7 +261,7 @@ Status RecordReader::SkipNBytes(uint64 offset) {
     TF_RETURN_IF_ERROR(zlib_input_stream_->SkipNBytes(offset));
   } else {
 #endif
-    if (options_.buffer_size > 0) {
+    if (options_.buffer_size > 0 || options_.async_io) {
       TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(offset));
     }
   }
@@ -213,5 +272,25 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status SequentialRecordReader::SeekToRecord(const RecordIndex& index,
+                                            int64 record) {
+  uint64 offset;
+  int64 records_to_skip;
+  TF_RETURN_IF_ERROR(index.Lookup(record, &offset, &records_to_skip));
+  if (record_number_ >= 0 && record_number_ <= record &&
+      record - record_number_ <= records_to_skip) {
+    // Reading forward is no slower than seeking to the indexed record.
+    records_to_skip = record - record_number_;
+  } else {
+    TF_RETURN_IF_ERROR(SeekOffset(offset));
+    record_number_ = record - records_to_skip;
+  }
+  string skipped;
+  for (int64 i = 0; i < records_to_skip; ++i) {
+    TF_RETURN_IF_ERROR(ReadRecord(&skipped));
+  }
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
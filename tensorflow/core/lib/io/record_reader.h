@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -32,6 +33,8 @@ class RandomAccessFile;
 
 namespace io {
 
+class AsyncBufferedInputStream;
+
 class RecordReaderOptions {
  public:
   enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
@@ -42,6 +45,13 @@ class RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If true, the file is read sequentially by a background thread, which
+  // reads the next `buffer_size` bytes (or 256KB if `buffer_size` is 0) while
+  // records are parsed from the current ones. Checksums of large records are
+  // verified piece by piece as the records are read, instead of in a separate
+  // pass over each record. The same restrictions as for buffering apply.
+  bool async_io = false;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -70,8 +80,8 @@ class RecordReader {
   // point to the offset of the next record.  Returns OK on success,
   // OUT_OF_RANGE for end of file, or something else for an error.
   //
-  // Note: if buffering is used (with or without compression), access must be
-  // sequential.
+  // Note: if buffering or asynchronous reads are used (with or without
+  // compression), access must be sequential.
   Status ReadRecord(uint64* offset, string* record);
 
   // Skip the records till "offset". Returns OK on success,
@@ -82,9 +92,17 @@ class RecordReader {
   Status ReadChecksummed(uint64 offset, size_t n, StringPiece* result,
                          string* storage);
 
+  // Like ReadChecksummed(), but reads from `async_input_stream_` and updates
+  // the checksum after each piece of the record.
+  Status ReadChecksummedIncrementally(uint64 offset, size_t n,
+                                      StringPiece* result, string* storage);
+
   RandomAccessFile* src_;
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
+  // Points to `input_stream_` if it reads asynchronously and records are not
+  // compressed.
+  AsyncBufferedInputStream* async_input_stream_ = nullptr;
 #if !defined(IS_SLIM_BUILD)
   std::unique_ptr<ZlibInputStream> zlib_input_stream_;
 #endif  // IS_SLIM_BUILD
@@ -108,7 +126,11 @@ class SequentialRecordReader {
   // Reads the next record in the file into *record. Returns OK on success,
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(string* record) {
-    return underlying_.ReadRecord(&offset_, record);
+    Status s = underlying_.ReadRecord(&offset_, record);
+    if (s.ok() && record_number_ >= 0) {
+      ++record_number_;
+    }
+    return s;
   }
 
   // Returns the current offset in the file.
@@ -122,13 +144,27 @@ class SequentialRecordReader {
           "Trying to seek offset: ", offset,
           " which is less than the current offset: ", offset_);
     TF_RETURN_IF_ERROR(underlying_.SkipNBytes(offset - offset_));
+    if (offset != offset_) {
+      record_number_ = -1;
+    }
     offset_ = offset;
     return Status::OK();
   }
 
+  // Seeks to record number `record` of the file, using the file's `index` to
+  // skip over all but at most `index.interval() - 1` of the preceding
+  // records, or over none of them if the reader is already at most that far
+  // before the record. As with SeekOffset(), seeking backward is an error.
+  //
+  // To read records in an arbitrary order, use RecordIndex::Lookup() with an
+  // unbuffered RecordReader instead.
+  Status SeekToRecord(const RecordIndex& index, int64 record);
+
  private:
   RecordReader underlying_;
   uint64 offset_ = 0;
+  // The number of the record at `offset_`, or -1 after seeking to an offset.
+  int64 record_number_ = 0;
 };
 
 }  // namespace io
@@ -67,6 +67,137 @@ TEST(RecordReaderWriterTest, TestBasics) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestAsyncIO) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_async_test";
+  // The last record is larger than the pieces in which checksums are
+  // computed.
+  std::vector<string> records = {"abc", "", "defg", string(200000, 'x')};
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.async_io = true;
+    options.buffer_size = buf_size;
+    io::SequentialRecordReader reader(read_file.get(), options);
+    string record;
+    for (const string& expected : records) {
+      TF_CHECK_OK(reader.ReadRecord(&record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+  }
+
+  // Flip a bit in the large record.
+  string contents;
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  contents[contents.size() - 1000] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReaderOptions options;
+  options.async_io = true;
+  io::SequentialRecordReader reader(read_file.get(), options);
+  string record;
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(reader.ReadRecord(&record));
+  }
+  EXPECT_TRUE(errors::IsDataLoss(reader.ReadRecord(&record)));
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  const int kNumRecords = 23;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options;
+    options.index_interval = 4;
+    io::RecordWriter writer(file.get(), options);
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(io::RecordIndex::IndexFilename(fname),
+                                     &index_file));
+    TF_CHECK_OK(writer.WriteIndex(index_file.get()));
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  io::RecordIndex index;
+  TF_CHECK_OK(io::RecordIndex::ReadFromFile(
+      env, io::RecordIndex::IndexFilename(fname), &index));
+  EXPECT_EQ(4, index.interval());
+  EXPECT_EQ(kNumRecords, index.num_records());
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  // Random access through the index.
+  {
+    io::RecordReader reader(read_file.get());
+    for (int i : {22, 0, 9, 8, 13}) {
+      uint64 offset;
+      int64 records_to_skip;
+      TF_CHECK_OK(index.Lookup(i, &offset, &records_to_skip));
+      EXPECT_EQ(i % 4, records_to_skip);
+      string record;
+      for (int j = 0; j <= records_to_skip; ++j) {
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      }
+      EXPECT_EQ(strings::StrCat("record", i), record);
+    }
+    uint64 offset;
+    int64 records_to_skip;
+    EXPECT_TRUE(errors::IsOutOfRange(
+        index.Lookup(kNumRecords, &offset, &records_to_skip)));
+  }
+
+  // Sequential reads of record ranges.
+  for (auto buf_size : BufferSizes()) {
+    io::RecordReaderOptions options;
+    options.buffer_size = buf_size;
+    io::SequentialRecordReader reader(read_file.get(), options);
+    string record;
+    for (int i : {1, 2, 6, 7, 21}) {
+      TF_CHECK_OK(reader.SeekToRecord(index, i));
+      TF_CHECK_OK(reader.ReadRecord(&record));
+      EXPECT_EQ(strings::StrCat("record", i), record);
+    }
+    EXPECT_TRUE(errors::IsInvalidArgument(reader.SeekToRecord(index, 3)));
+  }
+
+  // Shards cover every record exactly once.
+  int64 expected_begin = 0;
+  for (int shard = 0; shard < 5; ++shard) {
+    int64 begin, end;
+    index.ShardRange(5, shard, &begin, &end);
+    EXPECT_EQ(expected_begin, begin);
+    EXPECT_GE(end - begin, kNumRecords / 5);
+    EXPECT_LE(end - begin, kNumRecords / 5 + 1);
+    expected_begin = end;
+  }
+  EXPECT_EQ(kNumRecords, expected_begin);
+
+  // A corrupted index is rejected.
+  string encoded;
+  index.Encode(&encoded);
+  encoded[1] ^= 1;
+  io::RecordIndex corrupted;
+  EXPECT_TRUE(errors::IsDataLoss(io::RecordIndex::Decode(encoded, &corrupted)));
+}
+
 TEST(RecordReaderWriterTest, TestZlib) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_zlib_test";
@@ -105,4 +236,68 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestIndexWhenAppending) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_append_test";
+  env->DeleteFile(fname).IgnoreError();
+  io::RecordWriterOptions options;
+  options.index_interval = 1;
+  std::unique_ptr<WritableFile> index_file;
+
+  // Appending to a new file builds the index as usual.
+  uint64 second_offset;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewAppendableFile(fname, &file));
+    io::RecordWriter writer(file.get(), options);
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(env->GetFileSize(fname, &second_offset));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(env->NewWritableFile(io::RecordIndex::IndexFilename(fname),
+                                     &index_file));
+    TF_CHECK_OK(writer.WriteIndex(index_file.get()));
+    TF_CHECK_OK(index_file->Close());
+  }
+  io::RecordIndex index;
+  TF_CHECK_OK(io::RecordIndex::ReadFromFile(
+      env, io::RecordIndex::IndexFilename(fname), &index));
+  EXPECT_EQ(2, index.num_records());
+  uint64 offset;
+  int64 records_to_skip;
+  TF_CHECK_OK(index.Lookup(0, &offset, &records_to_skip));
+  EXPECT_EQ(0, offset);
+  TF_CHECK_OK(index.Lookup(1, &offset, &records_to_skip));
+  EXPECT_EQ(second_offset, offset);
+  EXPECT_EQ(0, records_to_skip);
+
+  // An index of only the records appended to a non-empty file would number
+  // them from 0, so none is built.
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewAppendableFile(fname, &file));
+    io::RecordWriter writer(file.get(), options);
+    TF_EXPECT_OK(writer.WriteRecord("hij"));
+    TF_EXPECT_OK(writer.WriteRecord("klmn"));
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(env->NewWritableFile(io::RecordIndex::IndexFilename(fname),
+                                     &index_file));
+    EXPECT_TRUE(
+        errors::IsFailedPrecondition(writer.WriteIndex(index_file.get())));
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  // The file holds all four records.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::SequentialRecordReader reader(read_file.get());
+  string record;
+  for (const char* expected : {"abc", "defg", "hij", "klmn"}) {
+    TF_CHECK_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(expected, record);
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
 }  // namespace tensorflow
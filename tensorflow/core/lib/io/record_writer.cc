@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
@@ -56,7 +57,12 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
-    : dest_(dest), options_(options) {
+    : dest_(dest), options_(options), index_(options.index_interval) {
+  if (options.index_interval > 0 && IsZlibCompressed(options)) {
+    LOG(ERROR) << "Record indexes are not supported for compressed files."
+               << " No index will be built.";
+    options_.index_interval = 0;
+  }
   if (IsZlibCompressed(options)) {
 // We don't have zlib available on all embedded platforms, so fail.
 #if defined(IS_SLIM_BUILD)
@@ -77,6 +83,22 @@ RecordWriter::RecordWriter(WritableFile* dest,
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
+  if (options_.index_interval > 0) {
+    // The index numbers records from the start of the file, so it can only
+    // be built when the file starts out empty.
+    int64 position;
+    Status s = dest_->Tell(&position);
+    if (s.ok() && position > 0) {
+      LOG(ERROR) << "Record indexes are not supported when appending to a "
+                 << "non-empty file. No index will be built.";
+      options_.index_interval = 0;
+    } else if (!s.ok() && !errors::IsUnimplemented(s)) {
+      LOG(ERROR) << "Could not determine the write position: " << s
+                 << ". No index will be built.";
+      options_.index_interval = 0;
+    }
+    // Otherwise `dest` is assumed to be a new file.
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -107,7 +129,23 @@ Status RecordWriter::WriteRecord(StringPiece data) {
 
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (options_.index_interval > 0) {
+    index_.AddRecord(offset_);
+  }
+  offset_ += sizeof(header) + data.size() + sizeof(footer);
+  return Status::OK();
+}
+
+Status RecordWriter::WriteIndex(WritableFile* dest) {
+  if (options_.index_interval <= 0) {
+    return errors::FailedPrecondition(
+        "Writing an index requires an uncompressed file and a positive "
+        "index_interval");
+  }
+  string encoded;
+  index_.Encode(&encoded);
+  return dest->Append(encoded);
 }
 
 Status RecordWriter::Close() {
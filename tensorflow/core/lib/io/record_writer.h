@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
@@ -39,6 +40,12 @@ class RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If positive, the writer builds a RecordIndex that holds the offset of
+  // every `index_interval`-th record. Indexes are only supported for
+  // uncompressed files that start out empty: no index is built when
+  // `WritableFile::Tell()` reports that `dest` already holds data.
+  int64 index_interval = 0;
+
 // Options specific to zlib compression.
 #if !defined(IS_SLIM_BUILD)
   ZlibCompressionOptions zlib_options;
@@ -72,9 +79,17 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Writes the index of the records written so far to "*dest", which is
+  // usually the file named `RecordIndex::IndexFilename()` of this writer's
+  // file. Requires `options.index_interval > 0`.
+  Status WriteIndex(WritableFile* dest);
+
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // The offset of the next record in the file.
+  uint64 offset_ = 0;
+  RecordIndex index_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordWriter);
 };
@@ -716,6 +716,28 @@ REGISTER_OP("MatMul")
     .Attr("T: {half, bfloat16, float, double, int32, complex64, complex128}")
     .SetShapeFn(shape_inference::MatMulShape);
 
+REGISTER_OP("_FusedMatMul")
+    .Input("a: T")
+    .Input("b: T")
+    .Input("args: num_args * T")
+    .Output("product: T")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string) = []")
+    .Attr("epsilon: float = 0.0001")
+    .SetShapeFn(shape_inference::MatMulShape)
+    .Doc(R"doc(
+Performs a MatMul followed by the ops listed in `fused_ops`.
+
+The supported fusions are the same as for `_FusedConv2D`: `BiasAdd` or
+inference-mode `FusedBatchNorm`, each optionally followed by `Relu` or `Relu6`.
+
+NOTE Do not invoke this operator directly in Python. The grappler remapper is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("SparseMatMul")
     .Input("a: Ta")
     .Input("b: Tb")
@@ -1145,6 +1167,39 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tidx: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+REGISTER_OP("FusedEmbeddingLookupSparse")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("segment_ids: int32")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      return SparseSegmentReductionShapeFn(c);
+    });
+
+REGISTER_OP("FusedEmbeddingLookupSparseGrad")
+    .Input("grad: T")
+    .Input("ids: Tidx")
+    .Input("segment_ids: int32")
+    .Input("weights: T")
+    .Output("values: T")
+    .Output("unique_ids: Tidx")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      TF_RETURN_IF_ERROR(SparseSegmentReductionShapeFn(c));
+      c->set_output(1, c->Vector(InferenceContext::kUnknownDim));
+      return Status::OK();
+    });
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
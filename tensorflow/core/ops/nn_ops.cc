@@ -274,6 +274,34 @@ REGISTER_OP("Conv2D")
     .Attr("dilations: list(int) = [1, 1, 1, 1]")
     .SetShapeFn(shape_inference::Conv2DShape);
 
+REGISTER_OP("_FusedConv2D")
+    .Input("input: T")
+    .Input("filter: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("num_args: int >= 0")
+    .Attr("strides: list(int)")
+    .Attr("use_cudnn_on_gpu: bool = true")
+    .Attr(GetPaddingAttrString())
+    .Attr(GetConvnetDataFormatAttrString())
+    .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .Attr("fused_ops: list(string) = []")
+    .Attr("epsilon: float = 0.0001")
+    .SetShapeFn(shape_inference::Conv2DShape)
+    .Doc(R"doc(
+Performs a Conv2D followed by the ops listed in `fused_ops`.
+
+The supported fusions are `BiasAdd` (args: bias) and `FusedBatchNorm` in
+inference mode (args: scale, offset, mean, variance), each optionally followed
+by `Relu` or `Relu6`. The bias or normalization and the activation are applied
+by the convolution kernel itself, without materializing the intermediate
+tensors.
+
+NOTE Do not invoke this operator directly in Python. The grappler remapper is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("Conv2DBackpropInput")
     .Input("input_sizes: int32")
     .Input("filter: T")
@@ -283,6 +283,16 @@ class WritableFile {
   /// be properly saved.
   virtual Status Sync() = 0;
 
+  /// \brief Retrieves the current write position in the file, or -1 on
+  /// error.
+  ///
+  /// For a file opened for appending, this includes the data that the file
+  /// held before it was opened.
+  virtual Status Tell(int64* position) {
+    *position = -1;
+    return errors::Unimplemented("This WritableFile does not support Tell()");
+  }
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(WritableFile);
 };
@@ -0,0 +1,235 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/csv_parser.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+
+namespace tensorflow {
+
+const char* FindFirstOf(const char* begin, const char* end, char a, char b,
+                        char c, char d) {
+#ifdef __SSE2__
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  const __m128i vc = _mm_set1_epi8(c);
+  const __m128i vd = _mm_set1_epi8(d);
+  while (end - begin >= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const __m128i matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+    const int mask = _mm_movemask_epi8(matches);
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 16;
+  }
+#endif  // __SSE2__
+  for (; begin != end; ++begin) {
+    const char x = *begin;
+    if (x == a || x == b || x == c || x == d) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+Status CsvParser::SplitRecord(StringPiece record,
+                              std::vector<StringPiece>* fields) {
+  fields->clear();
+  unescaped_.clear();
+  if (record.empty()) {
+    return Status::OK();
+  }
+  const char* p = record.data();
+  const char* const end = p + record.size();
+  // Only searched for in unquoted fields, where it is an error.
+  const char quote = use_quote_delim_ ? '"' : delim_;
+  while (p != end) {
+    if (*p == '\n' || *p == '\r') {
+      ++p;
+      continue;
+    }
+
+    if (!use_quote_delim_ || *p != '"') {
+      const char* field_end = FindFirstOf(p, end, delim_, quote, '\n', '\r');
+      if (field_end != end && *field_end != delim_) {
+        return errors::InvalidArgument(
+            "Unquoted fields cannot have quotes/CRLFs inside");
+      }
+      fields->emplace_back(p, field_end - p);
+      if (field_end == end) break;
+      p = field_end + 1;
+      continue;
+    }
+
+    // A quoted field ends with a quote that is followed by `delim_` or the
+    // end of the record. Other quotes must be escaped by another quote.
+    const char* q = p + 1;
+    string* unescaped = nullptr;
+    while (true) {
+      const char* r = static_cast<const char*>(memchr(q, '"', end - q));
+      if (r == nullptr) {
+        return errors::InvalidArgument(
+            "Quoted field has to end with quote followed by delim or end");
+      }
+      if (r + 1 == end || r[1] == delim_) {
+        if (unescaped == nullptr) {
+          fields->emplace_back(q, r - q);
+        } else {
+          unescaped->append(q, r - q);
+          fields->emplace_back(*unescaped);
+        }
+        p = r + 1;
+        break;
+      }
+      if (r[1] != '"') {
+        return errors::InvalidArgument(
+            "Quote inside a string has to be escaped by another quote");
+      }
+      if (unescaped == nullptr) {
+        unescaped_.emplace_back();
+        unescaped = &unescaped_.back();
+      }
+      unescaped->append(q, r + 1 - q);
+      q = r + 2;
+    }
+    if (p == end) break;
+    // Skip the delimiter.
+    ++p;
+  }
+
+  // Check if the last field is missing.
+  if (end[-1] == delim_) fields->emplace_back();
+  return Status::OK();
+}
+
+bool CsvParser::FindRecord(StringPiece input, bool at_end, size_t* length,
+                           size_t* consumed) const {
+  const char* const begin = input.data();
+  const char* const end = begin + input.size();
+  const char quote = use_quote_delim_ ? '"' : '\n';
+  bool in_quotes = false;
+  const char* p = begin;
+  while (true) {
+    p = FindFirstOf(p, end, '\n', quote, '\n', '\n');
+    if (p == end) break;
+    if (*p == '\n' && !in_quotes) {
+      *consumed = p + 1 - begin;
+      *length = (p != begin && p[-1] == '\r') ? p - 1 - begin : p - begin;
+      return true;
+    }
+    if (*p == '"') {
+      in_quotes = !in_quotes;
+    }
+    ++p;
+  }
+  if (!at_end || input.empty()) {
+    return false;
+  }
+  *consumed = input.size();
+  *length = input.size();
+  return true;
+}
+
+namespace {
+
+// Powers of ten that are exactly representable as doubles.
+const double kPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                               1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                               1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Parses `field` if it is a plain decimal number ("-ddd.ddd") whose digits,
+// read as an integer, fit in the mantissa of T, and whose number of
+// fractional digits is at most `max_fraction_digits`. The integer and the
+// power of ten are then exact, so their quotient is correctly rounded, as
+// strtod() and strtof() would round it. Returns false for any other input.
+template <typename T>
+bool ParsePlainDecimal(StringPiece field, uint64 max_mantissa,
+                       int max_fraction_digits, T* value) {
+  const char* p = field.data();
+  const char* const end = p + field.size();
+  bool negative = false;
+  if (p != end && *p == '-') {
+    negative = true;
+    ++p;
+  }
+  uint64 mantissa = 0;
+  int num_digits = 0;
+  const char* const integer_begin = p;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+    if (++num_digits > 19) return false;
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  if (p == integer_begin) return false;
+  int fraction_digits = 0;
+  if (p != end && *p == '.') {
+    ++p;
+    const char* const fraction_begin = p;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+      if (++num_digits > 19) return false;
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+    fraction_digits = p - fraction_begin;
+    if (fraction_digits == 0) return false;
+  }
+  if (p != end || mantissa > max_mantissa ||
+      fraction_digits > max_fraction_digits) {
+    return false;
+  }
+  const T result = static_cast<T>(mantissa) /
+                   static_cast<T>(kPowersOfTen[fraction_digits]);
+  *value = negative ? -result : result;
+  return true;
+}
+
+}  // namespace
+
+bool ParseCsvNumber(StringPiece field, int32* value) {
+  return strings::safe_strto32(field, value);
+}
+
+bool ParseCsvNumber(StringPiece field, int64* value) {
+  return strings::safe_strto64(field, value);
+}
+
+bool ParseCsvNumber(StringPiece field, float* value) {
+  // 10^10 is the largest power of ten that a float represents exactly.
+  if (ParsePlainDecimal(field, uint64{1} << 24, 10, value)) {
+    return true;
+  }
+  return strings::safe_strtof(string(field.data(), field.size()).c_str(),
+                              value);
+}
+
+bool ParseCsvNumber(StringPiece field, double* value) {
+  if (ParsePlainDecimal(field, uint64{1} << 53, 22, value)) {
+    return true;
+  }
+  return strings::safe_strtod(string(field.data(), field.size()).c_str(),
+                              value);
+}
+
+}  // namespace tensorflow
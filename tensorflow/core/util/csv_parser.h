@@ -0,0 +1,86 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_UTIL_CSV_PARSER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_UTIL_CSV_PARSER_H_
+
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Returns a pointer to the first byte in `[begin, end)` that is equal to one
+// of `a`, `b`, `c` or `d`, or `end` if there is none. Where SSE2 is
+// available, compares 16 bytes at a time.
+const char* FindFirstOf(const char* begin, const char* end, char a, char b,
+                        char c, char d);
+
+// Splits CSV records into fields.
+//
+// The fields are views of the record, except for quoted fields that contain
+// escaped quotes, which are unescaped into storage owned by the parser. All
+// fields are valid until the next call to `SplitRecord()`.
+//
+// The format is the one accepted by the DecodeCSV op:
+//  * Fields are separated by `delim`. A trailing `delim` adds an empty field.
+//  * If `use_quote_delim` is true, a field that starts with a quote ends with
+//    a quote followed by `delim` or the end of the record, and quotes inside
+//    it are escaped by doubling them. Unquoted fields cannot contain quotes.
+//  * Unquoted fields cannot contain '\n' or '\r'. These characters are
+//    skipped at the beginning of a field.
+class CsvParser {
+ public:
+  CsvParser(char delim, bool use_quote_delim)
+      : delim_(delim), use_quote_delim_(use_quote_delim) {}
+
+  // Splits `record` into `*fields`. Returns INVALID_ARGUMENT if the record is
+  // malformed.
+  Status SplitRecord(StringPiece record, std::vector<StringPiece>* fields);
+
+  // Returns the length of the first record in `input`, excluding the line
+  // terminator ('\n' or "\r\n"), and sets `*consumed` to the number of bytes
+  // of `input` that the record and its terminator occupy. Newlines inside
+  // quoted fields do not end a record.
+  //
+  // Returns false if `input` does not contain a complete record, i.e. if
+  // there is no line terminator outside quotes. If `at_end` is true, the
+  // rest of `input` is then returned as the last record, unless it is empty.
+  bool FindRecord(StringPiece input, bool at_end, size_t* length,
+                  size_t* consumed) const;
+
+ private:
+  const char delim_;
+  const bool use_quote_delim_;
+  // Storage for unescaped fields. A deque does not move its elements when it
+  // grows, so views of them stay valid.
+  std::deque<string> unescaped_;
+};
+
+// Parses a CSV field into `*value`. Accepts the same input as the
+// corresponding `strings::safe_strto*` function, and returns the same value.
+// Plain decimal numbers (such as "-12.375") are converted without copying the
+// field, and without locale-aware stream parsing.
+bool ParseCsvNumber(StringPiece field, int32* value);
+bool ParseCsvNumber(StringPiece field, int64* value);
+bool ParseCsvNumber(StringPiece field, float* value);
+bool ParseCsvNumber(StringPiece field, double* value);
+
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_UTIL_CSV_PARSER_H_
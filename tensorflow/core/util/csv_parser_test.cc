@@ -0,0 +1,159 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/csv_parser.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<string> Split(StringPiece record, bool use_quote_delim = true) {
+  CsvParser parser(',', use_quote_delim);
+  std::vector<StringPiece> fields;
+  TF_CHECK_OK(parser.SplitRecord(record, &fields));
+  std::vector<string> result;
+  for (StringPiece field : fields) {
+    result.push_back(field.ToString());
+  }
+  return result;
+}
+
+Status SplitError(StringPiece record) {
+  CsvParser parser(',', true);
+  std::vector<StringPiece> fields;
+  return parser.SplitRecord(record, &fields);
+}
+
+TEST(CsvParserTest, FindFirstOf) {
+  const string input = "abcdefghijklmnopqrstuvwxyz,abcdefghijklmnopqrstuvwxyz";
+  const char* begin = input.data();
+  const char* end = begin + input.size();
+  EXPECT_EQ(begin + 26, FindFirstOf(begin, end, ',', '"', '\n', '\r'));
+  EXPECT_EQ(begin + 27, FindFirstOf(begin + 27, end, 'a', 'z', 'z', 'z'));
+  EXPECT_EQ(begin + 52, FindFirstOf(begin + 27, end, 'z', 'z', 'z', 'z'));
+  EXPECT_EQ(end, FindFirstOf(begin, end, '1', '2', '3', '4'));
+  EXPECT_EQ(begin + 3, FindFirstOf(begin + 3, begin + 3, 'a', 'b', 'c', 'd'));
+}
+
+TEST(CsvParserTest, SplitRecord) {
+  EXPECT_EQ(std::vector<string>(), Split(""));
+  EXPECT_EQ(std::vector<string>({"a"}), Split("a"));
+  EXPECT_EQ(std::vector<string>({"a", "", "b"}), Split("a,,b"));
+  EXPECT_EQ(std::vector<string>({"a", ""}), Split("a,"));
+  EXPECT_EQ(std::vector<string>({"", "a"}), Split(",a"));
+  EXPECT_EQ(std::vector<string>({"a,b", "c"}), Split("\"a,b\",c"));
+  EXPECT_EQ(std::vector<string>({"a\"b", ""}), Split("\"a\"\"b\","));
+  EXPECT_EQ(std::vector<string>({"", "x"}), Split("\"\",x"));
+  EXPECT_EQ(std::vector<string>({"\"a\"", "b"}), Split("\"a\",b", false));
+  // Long fields take the vectorized path.
+  const string long_field(100, 'x');
+  EXPECT_EQ(std::vector<string>({long_field, long_field}),
+            Split(strings::StrCat(long_field, ",", long_field)));
+}
+
+TEST(CsvParserTest, SplitRecordErrors) {
+  EXPECT_TRUE(errors::IsInvalidArgument(SplitError("a\"b")));
+  EXPECT_TRUE(errors::IsInvalidArgument(SplitError("a\nb")));
+  EXPECT_TRUE(errors::IsInvalidArgument(SplitError("\"a\"b\"")));
+  EXPECT_TRUE(errors::IsInvalidArgument(SplitError("\"a")));
+  EXPECT_TRUE(errors::IsInvalidArgument(SplitError("\"a\"\"")));
+}
+
+TEST(CsvParserTest, FindRecord) {
+  CsvParser parser(',', true);
+  size_t length;
+  size_t consumed;
+  ASSERT_TRUE(parser.FindRecord("a,b\nc", false, &length, &consumed));
+  EXPECT_EQ(3, length);
+  EXPECT_EQ(4, consumed);
+  ASSERT_TRUE(parser.FindRecord("a,b\r\nc", false, &length, &consumed));
+  EXPECT_EQ(3, length);
+  EXPECT_EQ(5, consumed);
+  ASSERT_TRUE(parser.FindRecord("\"a\nb\",c\nd", false, &length, &consumed));
+  EXPECT_EQ(7, length);
+  EXPECT_FALSE(parser.FindRecord("a,b", false, &length, &consumed));
+  ASSERT_TRUE(parser.FindRecord("a,b", true, &length, &consumed));
+  EXPECT_EQ(3, length);
+  EXPECT_EQ(3, consumed);
+  EXPECT_FALSE(parser.FindRecord("", true, &length, &consumed));
+}
+
+TEST(CsvParserTest, ParseCsvNumber) {
+  int32 i32;
+  EXPECT_TRUE(ParseCsvNumber("-123", &i32));
+  EXPECT_EQ(-123, i32);
+  EXPECT_FALSE(ParseCsvNumber("1.5", &i32));
+  int64 i64;
+  EXPECT_TRUE(ParseCsvNumber("12345678901", &i64));
+  EXPECT_EQ(12345678901LL, i64);
+
+  // Every input must give the same result as safe_strtof and safe_strtod,
+  // whether or not it is handled by the fast path.
+  for (const char* input :
+       {"0", "-0", "1.5", "-12.375", "0.1", "3.14159265358979", "16777217",
+        "9007199254740993", "1.", ".5", " 7", "7 ", "1e10", "-inf", "nan",
+        "0x1A", "123456789012345678901234", "0.0000000000000000000001", "",
+        "-", "abc", "1.2.3"}) {
+    float f1 = 0, f2 = 0;
+    const bool fast_float = ParseCsvNumber(input, &f1);
+    EXPECT_EQ(strings::safe_strtof(input, &f2), fast_float) << input;
+    if (fast_float && f2 == f2) {
+      EXPECT_EQ(0, memcmp(&f1, &f2, sizeof(f1))) << input;
+    }
+    double d1 = 0, d2 = 0;
+    const bool fast_double = ParseCsvNumber(input, &d1);
+    EXPECT_EQ(strings::safe_strtod(input, &d2), fast_double) << input;
+    if (fast_double && d2 == d2) {
+      EXPECT_EQ(0, memcmp(&d1, &d2, sizeof(d1))) << input;
+    }
+  }
+}
+
+static void BM_SplitRecord(int iters, int num_fields) {
+  testing::StopTiming();
+  string record;
+  for (int i = 0; i < num_fields; ++i) {
+    strings::StrAppend(&record, i == 0 ? "" : ",", "12345.678");
+  }
+  CsvParser parser(',', true);
+  std::vector<StringPiece> fields;
+  testing::BytesProcessed(static_cast<int64>(iters) * record.size());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(parser.SplitRecord(record, &fields));
+  }
+}
+BENCHMARK(BM_SplitRecord)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_ParseCsvFloat(int iters) {
+  float value;
+  int64 sum = 0;
+  for (int i = 0; i < iters; ++i) {
+    ParseCsvNumber("12345.678", &value);
+    sum += value > 0;
+  }
+  testing::ItemsProcessed(iters);
+  CHECK_EQ(iters, sum);
+}
+BENCHMARK(BM_ParseCsvFloat);
+
+}  // namespace
+}  // namespace tensorflow
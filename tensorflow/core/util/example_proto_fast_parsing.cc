@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
@@ -862,6 +863,31 @@ void FillAndCopyVarLen(
   }
 }
 
+// Calculates the number of minibatches in which `serialized` is parsed.
+// In main regime make each minibatch around kMiniBatchSizeBytes bytes.
+// Apply 'special logic' below for small and big regimes.
+size_t NumMiniBatches(gtl::ArraySlice<string> serialized) {
+  // This parameter affects performance in a big and data-dependent way.
+  const size_t kMiniBatchSizeBytes = 50000;
+
+  size_t result = 0;
+  size_t minibatch_bytes = 0;
+  for (size_t i = 0; i < serialized.size(); i++) {
+    if (minibatch_bytes == 0) {  // start minibatch
+      result++;
+    }
+    minibatch_bytes += serialized[i].size() + 1;
+    if (minibatch_bytes > kMiniBatchSizeBytes) {
+      minibatch_bytes = 0;
+    }
+  }
+  // 'special logic'
+  const size_t min_minibatches = std::min<size_t>(8, serialized.size());
+  const size_t max_minibatches = 64;
+  return std::max<size_t>(min_minibatches,
+                          std::min<size_t>(max_minibatches, result));
+}
+
 }  // namespace
 
 Status FastParseExample(const Config& config,
@@ -915,30 +941,7 @@ Status FastParseExample(const Config& config,
     fixed_dense_values[d] = Tensor(config.dense[d].dtype, out_shape);
   }
 
-  // This parameter affects performance in a big and data-dependent way.
-  const size_t kMiniBatchSizeBytes = 50000;
-
-  // Calculate number of minibatches.
-  // In main regime make each minibatch around kMiniBatchSizeBytes bytes.
-  // Apply 'special logic' below for small and big regimes.
-  const size_t num_minibatches = [&] {
-    size_t result = 0;
-    size_t minibatch_bytes = 0;
-    for (size_t i = 0; i < serialized.size(); i++) {
-      if (minibatch_bytes == 0) {  // start minibatch
-        result++;
-      }
-      minibatch_bytes += serialized[i].size() + 1;
-      if (minibatch_bytes > kMiniBatchSizeBytes) {
-        minibatch_bytes = 0;
-      }
-    }
-    // 'special logic'
-    const size_t min_minibatches = std::min<size_t>(8, serialized.size());
-    const size_t max_minibatches = 64;
-    return std::max<size_t>(min_minibatches,
-                            std::min<size_t>(max_minibatches, result));
-  }();
+  const size_t num_minibatches = NumMiniBatches(serialized);
 
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
     return (serialized.size() * minibatch) / num_minibatches;
@@ -1455,5 +1458,724 @@ Status FastParseSingleExample(const Config& config, const string& serialized,
   return Status::OK();
 }
 
+// -----------------------------------------------------------------------------
+
+namespace {
+
+using SequenceConfig = FastParseSequenceExampleConfig;
+
+// A (feature list name, serialized FeatureList) pair.
+using FeatureListMapEntry = std::pair<StringPiece, StringPiece>;
+
+// A SequenceExample whose feature lists have not been split into steps yet.
+struct ParsedSequenceExample {
+  parsed::Example context;
+  std::vector<FeatureListMapEntry> feature_lists;
+};
+
+bool ParseFeatureLists(protobuf::io::CodedInputStream* stream,
+                       std::vector<FeatureListMapEntry>* feature_lists) {
+  DCHECK(stream != nullptr);
+  DCHECK(feature_lists != nullptr);
+  uint32 length;
+  if (!stream->ReadVarint32(&length)) return false;
+  auto limit = stream->PushLimit(length);
+  while (!stream->ExpectAtEnd()) {
+    if (!stream->ExpectTag(kDelimitedTag(1))) return false;
+    uint32 entry_length;
+    if (!stream->ReadVarint32(&entry_length)) return false;
+    auto entry_limit = stream->PushLimit(entry_length);
+    FeatureListMapEntry entry;
+    if (!stream->ExpectTag(kDelimitedTag(1))) return false;
+    if (!ParseString(stream, &entry.first)) return false;
+    if (!stream->ExpectTag(kDelimitedTag(2))) return false;
+    if (!ParseString(stream, &entry.second)) return false;
+    if (!stream->ExpectAtEnd()) return false;
+    stream->PopLimit(entry_limit);
+    feature_lists->push_back(entry);
+  }
+  stream->PopLimit(limit);
+  return true;
+}
+
+bool ParseSequenceExample(StringPiece serialized,
+                          ParsedSequenceExample* example) {
+  DCHECK(example != nullptr);
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  // As in ParseExample, concatenated serialized protos are merged.
+  while (!stream.ExpectAtEnd()) {
+    if (stream.ExpectTag(kDelimitedTag(1))) {
+      if (!ParseFeatures(&stream, &example->context)) return false;
+    } else if (stream.ExpectTag(kDelimitedTag(2))) {
+      if (!ParseFeatureLists(&stream, &example->feature_lists)) return false;
+    } else if (!SkipExtraneousTag(&stream)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Splits a serialized FeatureList into the features of its steps. The
+// features are not copied: they point into `serialized`.
+bool ParseFeatureListSteps(StringPiece serialized,
+                           std::vector<parsed::Feature>* steps) {
+  DCHECK(steps != nullptr);
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  while (!stream.ExpectAtEnd()) {
+    if (!stream.ExpectTag(kDelimitedTag(1))) {
+      if (!SkipExtraneousTag(&stream)) return false;
+      continue;
+    }
+    StringPiece feature;
+    if (!ParseString(&stream, &feature)) return false;
+    steps->emplace_back(feature);
+  }
+  return true;
+}
+
+// Returns the name of the Feature oneof field holding values of `dtype`.
+StringPiece FeatureKindName(DataType dtype) {
+  switch (dtype) {
+    case DT_INT64:
+      return "int64_list";
+    case DT_FLOAT:
+      return "float_list";
+    case DT_STRING:
+      return "bytes_list";
+    default:
+      return "empty";
+  }
+}
+
+// Appends the values of `feature`, whose data type has already been parsed,
+// to the list of `buffer` that corresponds to `dtype`.
+bool ParseFeatureIntoBuffer(DataType dtype, parsed::Feature* feature,
+                            SparseBuffer* buffer) {
+  switch (dtype) {
+    case DT_INT64:
+      return feature->ParseInt64List(&buffer->int64_list);
+    case DT_FLOAT:
+      return feature->ParseFloatList(&buffer->float_list);
+    case DT_STRING:
+      return feature->ParseBytesList(&buffer->bytes_list);
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+  return false;
+}
+
+size_t BufferSize(DataType dtype, const SparseBuffer& buffer) {
+  switch (dtype) {
+    case DT_INT64:
+      return buffer.int64_list.size();
+    case DT_FLOAT:
+      return buffer.float_list.size();
+    case DT_STRING:
+      return buffer.bytes_list.size();
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+  return 0;
+}
+
+// Parses the values of `feature`, whose data type has already been parsed,
+// directly into `out`, starting at flat index `offset`. At most
+// `num_elements` values are written; the number of values in the feature is
+// returned in `*num_values`.
+bool ParseFeatureIntoTensor(DataType dtype, parsed::Feature* feature,
+                            size_t offset, size_t num_elements, Tensor* out,
+                            int64* num_values) {
+  switch (dtype) {
+    case DT_INT64: {
+      LimitedArraySlice<int64> slice(out->flat<int64>().data() + offset,
+                                     num_elements);
+      if (!feature->ParseInt64List(&slice)) return false;
+      *num_values = static_cast<int64>(num_elements) - slice.EndDistance();
+      return true;
+    }
+    case DT_FLOAT: {
+      LimitedArraySlice<float> slice(out->flat<float>().data() + offset,
+                                     num_elements);
+      if (!feature->ParseFloatList(&slice)) return false;
+      *num_values = static_cast<int64>(num_elements) - slice.EndDistance();
+      return true;
+    }
+    case DT_STRING: {
+      LimitedArraySlice<string> slice(out->flat<string>().data() + offset,
+                                      num_elements);
+      if (!feature->ParseBytesList(&slice)) return false;
+      *num_values = static_cast<int64>(num_elements) - slice.EndDistance();
+      return true;
+    }
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+  return false;
+}
+
+template <typename T>
+void FillBlock(size_t begin, size_t end, const T& value, Tensor* out) {
+  auto data = out->flat<T>().data();
+  std::fill(data + begin, data + end, value);
+}
+
+// Sets the values of `out` in [begin, end) to zero or the empty string.
+void PadTensor(DataType dtype, size_t begin, size_t end, Tensor* out) {
+  switch (dtype) {
+    case DT_INT64:
+      FillBlock<int64>(begin, end, 0, out);
+      break;
+    case DT_FLOAT:
+      FillBlock<float>(begin, end, 0.0f, out);
+      break;
+    case DT_STRING:
+      FillBlock<string>(begin, end, string(), out);
+      break;
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+}
+
+// Copies all values of `in` into `out`, starting at flat index `offset`.
+void CopyDefaultValue(DataType dtype, const Tensor& in, size_t offset,
+                      Tensor* out) {
+  switch (dtype) {
+    case DT_INT64:
+      std::copy_n(in.flat<int64>().data(), in.NumElements(),
+                  out->flat<int64>().data() + offset);
+      break;
+    case DT_FLOAT:
+      std::copy_n(in.flat<float>().data(), in.NumElements(),
+                  out->flat<float>().data() + offset);
+      break;
+    case DT_STRING:
+      std::copy_n(in.flat<string>().data(), in.NumElements(),
+                  out->flat<string>().data() + offset);
+      break;
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+}
+
+// Moves the values in `buffer[begin, end)` into `out`, starting at flat index
+// `offset`.
+void MoveFromBuffer(DataType dtype, size_t begin, size_t end,
+                    SparseBuffer* buffer, size_t offset, Tensor* out) {
+  switch (dtype) {
+    case DT_INT64:
+      CopyOrMoveBlock(buffer->int64_list.begin() + begin,
+                      buffer->int64_list.begin() + end,
+                      out->flat<int64>().data() + offset);
+      break;
+    case DT_FLOAT:
+      CopyOrMoveBlock(buffer->float_list.begin() + begin,
+                      buffer->float_list.begin() + end,
+                      out->flat<float>().data() + offset);
+      break;
+    case DT_STRING:
+      CopyOrMoveBlock(buffer->bytes_list.begin() + begin,
+                      buffer->bytes_list.begin() + end,
+                      out->flat<string>().data() + offset);
+      break;
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+}
+
+Status ValueCountError(StringPiece name, StringPiece key, size_t index,
+                       DataType dtype, int64 num_values,
+                       const TensorShape& shape) {
+  const string kind = dtype == DT_STRING ? "bytes" : DataTypeString(dtype);
+  return errors::InvalidArgument(
+      "Name: ", name, ", Key: ", key, ", Index: ", index, ".  Number of ",
+      kind, " values != expected.  values size: ", num_values,
+      " but output shape: ", shape.DebugString());
+}
+
+// Maps a feature key to the dense and sparse features that read it. As in
+// the proto-based parser, the same key may be configured as both.
+using SequenceConfigIndex =
+    std::unordered_map<StringPiece,
+                       gtl::InlinedVector<std::pair<size_t, Type>, 1>,
+                       StringPieceHasher>;
+
+// The parts of a SequenceExample whose output sizes depend on the other
+// examples of the batch.
+struct SequenceExampleBuffers {
+  // Values of the context sparse features.
+  std::vector<SparseBuffer> context_sparse;
+  // Steps of the dense feature lists. The data type of each step has already
+  // been parsed and checked, but the values have not.
+  std::vector<std::vector<parsed::Feature>> feature_list_dense;
+  // Values of the sparse feature lists. `example_end_indices` holds the end
+  // of each step.
+  std::vector<SparseBuffer> feature_list_sparse;
+};
+
+// Parses `serialized`, the `example_index`-th SequenceExample of the batch.
+// Fixed-size context features are written directly into
+// `context_dense_values`, everything else into `buffers`.
+Status ParseSequenceExampleIntoBuffers(
+    const string& serialized, const string& name, size_t example_index,
+    const SequenceConfig& config, const SequenceConfigIndex& context_index,
+    const SequenceConfigIndex& feature_list_index,
+    std::vector<Tensor>* context_dense_values,
+    SequenceExampleBuffers* buffers) {
+  ParsedSequenceExample parsed_example;
+  if (!ParseSequenceExample(serialized, &parsed_example)) {
+    return errors::InvalidArgument("Could not parse example input, value: '",
+                                   serialized, "'");
+  }
+  const auto& context_config = config.context;
+  buffers->context_sparse.resize(context_config.sparse.size());
+  buffers->feature_list_dense.resize(config.feature_list_dense.size());
+  buffers->feature_list_sparse.resize(config.feature_list_sparse.size());
+
+  // Context ------------------------------------------------------------------
+  std::vector<bool> context_dense_seen(context_config.dense.size(), false);
+  std::vector<bool> context_sparse_seen(context_config.sparse.size(), false);
+  const size_t context_size = parsed_example.context.size();
+  for (size_t i = 0; i < context_size; ++i) {
+    // Last entry in the map overwrites all the previous ones.
+    parsed::FeatureMapEntry& name_and_feature =
+        parsed_example.context[context_size - i - 1];
+    const StringPiece key = name_and_feature.first;
+    const auto it = context_index.find(key);
+    if (it == context_index.end()) continue;
+    for (const auto& d_and_type : it->second) {
+      const size_t d = d_and_type.first;
+      const bool is_dense = d_and_type.second == Type::Dense;
+      std::vector<bool>& seen =
+          is_dense ? context_dense_seen : context_sparse_seen;
+      if (seen[d]) {
+        if (is_dense) {
+          LogDenseFeatureDataLoss(key);
+        } else {
+          LogSparseFeatureDataLoss(key);
+        }
+        continue;
+      }
+      seen[d] = true;
+
+      // Parsing consumes the feature, so each target parses its own copy.
+      parsed::Feature feature = name_and_feature.second;
+      DataType example_dtype;
+      TF_RETURN_IF_ERROR(feature.ParseDataType(&example_dtype));
+      const DataType dtype = is_dense ? context_config.dense[d].dtype
+                                      : context_config.sparse[d].dtype;
+      // A sparse feature without a value is treated as an empty list.
+      if (!is_dense && example_dtype == DT_INVALID) continue;
+      if (example_dtype != dtype) {
+        return errors::InvalidArgument(
+            "Name: ", name, ", Context feature: ", key,
+            ".  Data types don't match. Expected type: ", DataTypeString(dtype),
+            "  Feature is: ", FeatureKindName(example_dtype));
+      }
+      auto parse_error = [&name, key] {
+        return errors::InvalidArgument("Name: ", name, ", Key: ", key,
+                                       ".  Can't parse serialized Example.");
+      };
+
+      if (is_dense) {
+        const size_t num_elements = context_config.dense[d].elements_per_stride;
+        int64 num_values;
+        if (!ParseFeatureIntoTensor(dtype, &feature,
+                                    example_index * num_elements, num_elements,
+                                    &(*context_dense_values)[d], &num_values)) {
+          return parse_error();
+        }
+        if (num_values != static_cast<int64>(num_elements)) {
+          TensorShape shape;
+          context_config.dense[d].shape.AsTensorShape(&shape);
+          return ValueCountError(name, key, 0, dtype, num_values, shape);
+        }
+      } else {
+        if (!ParseFeatureIntoBuffer(dtype, &feature,
+                                    &buffers->context_sparse[d])) {
+          return parse_error();
+        }
+      }
+    }
+  }
+
+  for (size_t d = 0; d < context_config.dense.size(); ++d) {
+    if (context_dense_seen[d]) continue;
+    const auto& c = context_config.dense[d];
+    if (c.default_value.NumElements() == 0) {
+      return errors::InvalidArgument("Name: ", name, ", Context feature '",
+                                     c.feature_name,
+                                     "' is required but could not be found.");
+    }
+    CopyDefaultValue(c.dtype, c.default_value,
+                     example_index * c.elements_per_stride,
+                     &(*context_dense_values)[d]);
+  }
+
+  // Feature lists ------------------------------------------------------------
+  std::vector<bool> feature_list_dense_seen(config.feature_list_dense.size(),
+                                            false);
+  std::vector<bool> feature_list_sparse_seen(
+      config.feature_list_sparse.size(), false);
+  const size_t feature_lists_size = parsed_example.feature_lists.size();
+  for (size_t i = 0; i < feature_lists_size; ++i) {
+    const FeatureListMapEntry& entry =
+        parsed_example.feature_lists[feature_lists_size - i - 1];
+    const StringPiece key = entry.first;
+    const auto it = feature_list_index.find(key);
+    if (it == feature_list_index.end()) continue;
+    for (const auto& d_and_type : it->second) {
+      const size_t d = d_and_type.first;
+      const bool is_dense = d_and_type.second == Type::Dense;
+      std::vector<bool>& seen =
+          is_dense ? feature_list_dense_seen : feature_list_sparse_seen;
+      if (seen[d]) continue;
+      seen[d] = true;
+
+      const DataType dtype = is_dense ? config.feature_list_dense[d].dtype
+                                      : config.feature_list_sparse[d].dtype;
+      std::vector<parsed::Feature> local_steps;
+      std::vector<parsed::Feature>* steps =
+          is_dense ? &buffers->feature_list_dense[d] : &local_steps;
+      if (!ParseFeatureListSteps(entry.second, steps)) {
+        return errors::InvalidArgument("Name: ", name, ", Feature list: ", key,
+                                       ".  Can't parse serialized Example.");
+      }
+      SparseBuffer* out = is_dense ? nullptr : &buffers->feature_list_sparse[d];
+      for (size_t t = 0; t < steps->size(); ++t) {
+        parsed::Feature& feature = (*steps)[t];
+        DataType example_dtype;
+        TF_RETURN_IF_ERROR(feature.ParseDataType(&example_dtype));
+        // Steps of sparse feature lists may be empty.
+        if (!is_dense && example_dtype == DT_INVALID) {
+          out->example_end_indices.push_back(BufferSize(dtype, *out));
+          continue;
+        }
+        if (example_dtype != dtype) {
+          return errors::InvalidArgument(
+              "Name: ", name, ", Feature list: ", key, ", Index: ", t,
+              ".  Data types don't match. Expected type: ",
+              DataTypeString(dtype), "  Feature is: ",
+              FeatureKindName(example_dtype));
+        }
+        if (!is_dense) {
+          if (!ParseFeatureIntoBuffer(dtype, &feature, out)) {
+            return errors::InvalidArgument(
+                "Name: ", name, ", Feature list: ", key, ", Index: ", t,
+                ".  Can't parse serialized Example.");
+          }
+          out->example_end_indices.push_back(BufferSize(dtype, *out));
+        }
+      }
+    }
+  }
+
+  for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+    const auto& c = config.feature_list_dense[d];
+    if (!feature_list_dense_seen[d] && !c.missing_assumed_empty) {
+      return errors::InvalidArgument(
+          "Name: ", name, ", Feature list '", c.feature_list_name,
+          "' is required but could not be found.  Did you mean to include it "
+          "in feature_list_dense_missing_assumed_empty or "
+          "feature_list_dense_defaults?");
+    }
+  }
+  return Status::OK();
+}
+
+// Adds the `d`-th dense or sparse feature of a config to `index`.
+Status AddToSequenceConfigIndex(const string& feature_name, DataType dtype,
+                                size_t d, Type type,
+                                SequenceConfigIndex* index) {
+  TF_RETURN_IF_ERROR(CheckConfigDataType(dtype));
+  (*index)[feature_name].emplace_back(d, type);
+  return Status::OK();
+}
+
+}  // namespace
+
+Status FastParseSequenceExample(const SequenceConfig& config,
+                                gtl::ArraySlice<string> serialized,
+                                gtl::ArraySlice<string> example_names,
+                                thread::ThreadPool* thread_pool,
+                                SequenceResult* result) {
+  DCHECK(result != nullptr);
+  if (!example_names.empty() && example_names.size() != serialized.size()) {
+    return errors::InvalidArgument(
+        "Expected len(example_names) == len(serialized) but got: ",
+        example_names.size(), " vs. ", serialized.size());
+  }
+  const auto& context_config = config.context;
+  SequenceConfigIndex context_index;
+  for (size_t d = 0; d < context_config.dense.size(); ++d) {
+    const auto& c = context_config.dense[d];
+    TF_RETURN_IF_ERROR(AddToSequenceConfigIndex(c.feature_name, c.dtype, d,
+                                                Type::Dense, &context_index));
+  }
+  for (size_t d = 0; d < context_config.sparse.size(); ++d) {
+    const auto& c = context_config.sparse[d];
+    TF_RETURN_IF_ERROR(AddToSequenceConfigIndex(c.feature_name, c.dtype, d,
+                                                Type::Sparse, &context_index));
+  }
+  SequenceConfigIndex feature_list_index;
+  for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+    const auto& c = config.feature_list_dense[d];
+    TF_RETURN_IF_ERROR(AddToSequenceConfigIndex(
+        c.feature_list_name, c.dtype, d, Type::Dense, &feature_list_index));
+  }
+  for (size_t d = 0; d < config.feature_list_sparse.size(); ++d) {
+    const auto& c = config.feature_list_sparse[d];
+    TF_RETURN_IF_ERROR(AddToSequenceConfigIndex(
+        c.feature_list_name, c.dtype, d, Type::Sparse, &feature_list_index));
+  }
+  for (const auto& c : context_config.dense) {
+    if (c.variable_length) {
+      return errors::InvalidArgument(
+          "Variable-length context features are not supported: ",
+          c.feature_name);
+    }
+  }
+  const int64 batch_size = serialized.size();
+
+  // Allocate the context dense output, whose size is known upfront.
+  Result* context = &result->context;
+  for (const auto& c : context_config.dense) {
+    TensorShape out_shape;
+    out_shape.AddDim(batch_size);
+    for (const int64 dim : c.shape.dim_sizes()) {
+      out_shape.AddDim(dim);
+    }
+    context->dense_values.emplace_back(c.dtype, out_shape);
+  }
+
+  // Parse the examples in minibatches. Everything whose size depends on the
+  // other examples is buffered.
+  const size_t num_minibatches = NumMiniBatches(serialized);
+  auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
+    return (serialized.size() * minibatch) / num_minibatches;
+  };
+  std::vector<SequenceExampleBuffers> buffers(batch_size);
+  std::vector<Status> status_of_minibatch(num_minibatches);
+  static const string kUnknownName = "<unknown>";
+  auto example_name = [&](size_t e) -> const string& {
+    return example_names.empty() ? kUnknownName : example_names[e];
+  };
+  ParallelFor(
+      [&](size_t minibatch) {
+        const size_t end = first_example_of_minibatch(minibatch + 1);
+        for (size_t e = first_example_of_minibatch(minibatch); e < end; ++e) {
+          status_of_minibatch[minibatch] = ParseSequenceExampleIntoBuffers(
+              serialized[e], example_name(e), e, config, context_index,
+              feature_list_index, &context->dense_values, &buffers[e]);
+          if (!status_of_minibatch[minibatch].ok()) break;
+        }
+      },
+      num_minibatches, thread_pool);
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  // Allocate the remaining outputs. `*_offsets[d][e]` is the position of the
+  // first value of example `e` in the d-th output.
+  std::vector<std::vector<int64>> context_sparse_offsets(
+      context_config.sparse.size(), std::vector<int64>(batch_size));
+  for (size_t d = 0; d < context_config.sparse.size(); ++d) {
+    const DataType dtype = context_config.sparse[d].dtype;
+    int64 total = 0;
+    int64 max_num_values = 0;
+    for (int64 e = 0; e < batch_size; ++e) {
+      const int64 size = BufferSize(dtype, buffers[e].context_sparse[d]);
+      context_sparse_offsets[d][e] = total;
+      total += size;
+      max_num_values = std::max(max_num_values, size);
+    }
+    context->sparse_indices.emplace_back(DT_INT64, TensorShape({total, 2}));
+    context->sparse_values.emplace_back(dtype, TensorShape({total}));
+    context->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
+    auto shape_t = context->sparse_shapes.back().vec<int64>();
+    shape_t(0) = batch_size;
+    shape_t(1) = max_num_values;
+  }
+
+  Result* feature_lists = &result->feature_lists;
+  for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+    const auto& c = config.feature_list_dense[d];
+    result->feature_list_dense_lengths.emplace_back(DT_INT64,
+                                                    TensorShape({batch_size}));
+    auto lengths_t = result->feature_list_dense_lengths.back().vec<int64>();
+    int64 max_num_steps = 0;
+    for (int64 e = 0; e < batch_size; ++e) {
+      lengths_t(e) = buffers[e].feature_list_dense[d].size();
+      max_num_steps = std::max(max_num_steps, lengths_t(e));
+    }
+    TensorShape out_shape({batch_size, max_num_steps});
+    out_shape.AppendShape(c.shape);
+    feature_lists->dense_values.emplace_back(c.dtype, out_shape);
+  }
+
+  std::vector<std::vector<int64>> feature_list_sparse_offsets(
+      config.feature_list_sparse.size(), std::vector<int64>(batch_size));
+  for (size_t d = 0; d < config.feature_list_sparse.size(); ++d) {
+    const DataType dtype = config.feature_list_sparse[d].dtype;
+    int64 total = 0;
+    int64 max_num_steps = 0;
+    int64 max_num_values = 0;
+    for (int64 e = 0; e < batch_size; ++e) {
+      const SparseBuffer& buffer = buffers[e].feature_list_sparse[d];
+      feature_list_sparse_offsets[d][e] = total;
+      total += BufferSize(dtype, buffer);
+      const auto& ends = buffer.example_end_indices;
+      max_num_steps = std::max<int64>(max_num_steps, ends.size());
+      for (size_t t = 0; t < ends.size(); ++t) {
+        const int64 size = ends[t] - (t == 0 ? 0 : ends[t - 1]);
+        max_num_values = std::max(max_num_values, size);
+      }
+    }
+    feature_lists->sparse_indices.emplace_back(DT_INT64,
+                                               TensorShape({total, 3}));
+    feature_lists->sparse_values.emplace_back(dtype, TensorShape({total}));
+    feature_lists->sparse_shapes.emplace_back(DT_INT64, TensorShape({3}));
+    auto shape_t = feature_lists->sparse_shapes.back().vec<int64>();
+    shape_t(0) = batch_size;
+    shape_t(1) = max_num_steps;
+    shape_t(2) = max_num_values;
+  }
+
+  // Fill the outputs, again in minibatches. The values of the dense feature
+  // lists are parsed directly into the output.
+  auto fill_example = [&](size_t e) -> Status {
+    SequenceExampleBuffers& example_buffers = buffers[e];
+
+    for (size_t d = 0; d < context_config.sparse.size(); ++d) {
+      SparseBuffer* buffer = &example_buffers.context_sparse[d];
+      const DataType dtype = context_config.sparse[d].dtype;
+      const int64 offset = context_sparse_offsets[d][e];
+      const size_t size = BufferSize(dtype, *buffer);
+      auto indices_t = context->sparse_indices[d].matrix<int64>();
+      for (size_t i = 0; i < size; ++i) {
+        indices_t(offset + i, 0) = e;
+        indices_t(offset + i, 1) = i;
+      }
+      MoveFromBuffer(dtype, 0, size, buffer, offset,
+                     &context->sparse_values[d]);
+    }
+
+    for (size_t d = 0; d < config.feature_list_dense.size(); ++d) {
+      const auto& c = config.feature_list_dense[d];
+      std::vector<parsed::Feature>& steps =
+          example_buffers.feature_list_dense[d];
+      Tensor* out = &feature_lists->dense_values[d];
+      const size_t num_elements = c.shape.num_elements();
+      const size_t max_num_steps = out->dim_size(1);
+      const size_t offset = e * max_num_steps * num_elements;
+      for (size_t t = 0; t < steps.size(); ++t) {
+        int64 num_values;
+        if (!ParseFeatureIntoTensor(c.dtype, &steps[t],
+                                    offset + t * num_elements, num_elements,
+                                    out, &num_values)) {
+          return errors::InvalidArgument(
+              "Name: ", example_name(e), ", Feature list: ",
+              c.feature_list_name, ", Index: ", t,
+              ".  Can't parse serialized Example.");
+        }
+        if (num_values != static_cast<int64>(num_elements)) {
+          return ValueCountError(example_name(e), c.feature_list_name, t,
+                                 c.dtype, num_values, c.shape);
+        }
+      }
+      PadTensor(c.dtype, offset + steps.size() * num_elements,
+                offset + max_num_steps * num_elements, out);
+    }
+
+    for (size_t d = 0; d < config.feature_list_sparse.size(); ++d) {
+      SparseBuffer* buffer = &example_buffers.feature_list_sparse[d];
+      const DataType dtype = config.feature_list_sparse[d].dtype;
+      const int64 offset = feature_list_sparse_offsets[d][e];
+      auto indices_t = feature_lists->sparse_indices[d].matrix<int64>();
+      size_t begin = 0;
+      for (size_t t = 0; t < buffer->example_end_indices.size(); ++t) {
+        const size_t end = buffer->example_end_indices[t];
+        for (size_t i = begin; i < end; ++i) {
+          indices_t(offset + i, 0) = e;
+          indices_t(offset + i, 1) = t;
+          indices_t(offset + i, 2) = i - begin;
+        }
+        begin = end;
+      }
+      MoveFromBuffer(dtype, 0, begin, buffer, offset,
+                     &feature_lists->sparse_values[d]);
+    }
+    return Status::OK();
+  };
+  ParallelFor(
+      [&](size_t minibatch) {
+        const size_t end = first_example_of_minibatch(minibatch + 1);
+        for (size_t e = first_example_of_minibatch(minibatch); e < end; ++e) {
+          status_of_minibatch[minibatch] = fill_example(e);
+          if (!status_of_minibatch[minibatch].ok()) break;
+        }
+      },
+      num_minibatches, thread_pool);
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// Returns `indices` without its first column.
+Tensor DropIndexColumn(const Tensor& indices) {
+  const int64 num_indices = indices.dim_size(0);
+  const int64 rank = indices.dim_size(1) - 1;
+  Tensor result(DT_INT64, TensorShape({num_indices, rank}));
+  auto in_t = indices.matrix<int64>();
+  auto out_t = result.matrix<int64>();
+  for (int64 i = 0; i < num_indices; ++i) {
+    for (int64 j = 0; j < rank; ++j) {
+      out_t(i, j) = in_t(i, j + 1);
+    }
+  }
+  return result;
+}
+
+// Drops the batch dimension of the outputs of a batch of one example.
+void RemoveBatchDimension(Result* result) {
+  for (Tensor& values : result->dense_values) {
+    TensorShape shape = values.shape();
+    shape.RemoveDim(0);
+    Tensor unbatched;
+    CHECK(unbatched.CopyFrom(values, shape));
+    values = unbatched;
+  }
+  for (size_t d = 0; d < result->sparse_indices.size(); ++d) {
+    result->sparse_indices[d] = DropIndexColumn(result->sparse_indices[d]);
+    const Tensor& shape = result->sparse_shapes[d];
+    Tensor unbatched_shape(DT_INT64, TensorShape({shape.NumElements() - 1}));
+    for (int64 i = 0; i < unbatched_shape.NumElements(); ++i) {
+      unbatched_shape.vec<int64>()(i) = shape.vec<int64>()(i + 1);
+    }
+    result->sparse_shapes[d] = unbatched_shape;
+  }
+}
+
+}  // namespace
+
+Status FastParseSingleSequenceExample(const SequenceConfig& config,
+                                      const string& serialized,
+                                      const string& example_name,
+                                      SequenceResult* result) {
+  TF_RETURN_IF_ERROR(FastParseSequenceExample(
+      config, gtl::ArraySlice<string>(&serialized, 1),
+      gtl::ArraySlice<string>(&example_name, 1), nullptr, result));
+  RemoveBatchDimension(&result->context);
+  RemoveBatchDimension(&result->feature_lists);
+  result->feature_list_dense_lengths.clear();
+  return Status::OK();
+}
+
 }  // namespace example
 }  // namespace tensorflow
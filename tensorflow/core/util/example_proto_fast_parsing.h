@@ -85,6 +85,63 @@ typedef FastParseExampleConfig FastParseSingleExampleConfig;
 Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
                               const string& serialized, Result* result);
 
+// FastParseSequenceExampleConfig defines how to parse the context and the
+// feature lists of SequenceExample protos. The context is parsed according to
+// `context`, in the same way as the features of an Example, except that
+// variable-length dense features are not supported.
+struct FastParseSequenceExampleConfig {
+  struct FeatureListDense {
+    string feature_list_name;
+    DataType dtype;
+    // The shape of the feature at each step of the feature list.
+    TensorShape shape;
+    // If true, a missing feature list is treated as a feature list without
+    // steps. Otherwise, it is an error.
+    bool missing_assumed_empty;
+  };
+
+  struct FeatureListSparse {
+    string feature_list_name;
+    DataType dtype;
+  };
+
+  FastParseExampleConfig context;
+  std::vector<FeatureListDense> feature_list_dense;
+  std::vector<FeatureListSparse> feature_list_sparse;
+};
+
+// The output of FastParseSequenceExample.
+struct SequenceResult {
+  // Context features, batched as in Result.
+  Result context;
+  // Feature lists. Dense feature lists have shape
+  // [batch_size, max_steps] + shape, where shorter feature lists are padded
+  // with zeros or empty strings. Sparse feature lists have indices of the form
+  // (example, step, index) and a dense shape of
+  // [batch_size, max_steps, max_values_per_step].
+  Result feature_lists;
+  // For each dense feature list, an int64 vector with the number of steps of
+  // each example.
+  std::vector<Tensor> feature_list_dense_lengths;
+};
+
+// Parses a batch of serialized SequenceExample protos and converts them into
+// result according to given config.
+// Given example names have to either be empty or the same size as serialized.
+// example_names are used only for error messages.
+Status FastParseSequenceExample(const FastParseSequenceExampleConfig& config,
+                                gtl::ArraySlice<string> serialized,
+                                gtl::ArraySlice<string> example_names,
+                                thread::ThreadPool* thread_pool,
+                                SequenceResult* result);
+
+// Parses a single serialized SequenceExample, with the outputs of the
+// ParseSingleSequenceExample op: the results do not have a batch dimension,
+// and feature_list_dense_lengths is left empty.
+Status FastParseSingleSequenceExample(
+    const FastParseSequenceExampleConfig& config, const string& serialized,
+    const string& example_name, SequenceResult* result);
+
 // This function parses serialized Example and populates given example.
 // It uses the same specialized parser as FastParseExample which is efficient.
 // But then constructs Example which is relatively slow.
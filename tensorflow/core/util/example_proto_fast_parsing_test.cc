@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -372,6 +375,201 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+SequenceExample MakeSequenceExample(int64 label, int num_steps) {
+  SequenceExample example;
+  auto& context = *example.mutable_context()->mutable_feature();
+  context["label"].mutable_int64_list()->add_value(label);
+  for (int i = 0; i < label; ++i) {
+    context["weights"].mutable_float_list()->add_value(0.5 * i);
+  }
+  auto& feature_lists =
+      *example.mutable_feature_lists()->mutable_feature_list();
+  for (int t = 0; t < num_steps; ++t) {
+    auto* embedding =
+        feature_lists["embedding"].add_feature()->mutable_float_list();
+    embedding->add_value(t);
+    embedding->add_value(-t);
+    auto* tokens = feature_lists["tokens"].add_feature()->mutable_bytes_list();
+    for (int i = 0; i < t; ++i) {
+      tokens->add_value(strings::StrCat("token", i));
+    }
+  }
+  return example;
+}
+
+FastParseSequenceExampleConfig MakeSequenceConfig() {
+  FastParseSequenceExampleConfig config;
+  Tensor no_default(DT_INT64, TensorShape({0}));
+  config.context.dense.push_back({"label", DT_INT64, PartialTensorShape({}),
+                                  no_default, false, 1});
+  config.context.sparse.push_back({"weights", DT_FLOAT});
+  config.feature_list_dense.push_back(
+      {"embedding", DT_FLOAT, TensorShape({2}), true});
+  config.feature_list_sparse.push_back({"tokens", DT_STRING});
+  return config;
+}
+
+TEST(FastParseSequenceExample, Batch) {
+  std::vector<string> serialized = {Serialize(MakeSequenceExample(2, 3)),
+                                    Serialize(MakeSequenceExample(1, 0))};
+  thread::ThreadPool thread_pool(Env::Default(), "test", 2);
+  SequenceResult result;
+  TF_ASSERT_OK(FastParseSequenceExample(MakeSequenceConfig(), serialized, {},
+                                        &thread_pool, &result));
+
+  test::ExpectTensorEqual<int64>(result.context.dense_values[0],
+                                 test::AsTensor<int64>({2, 1}));
+  test::ExpectTensorEqual<int64>(
+      result.context.sparse_indices[0],
+      test::AsTensor<int64>({0, 0, 0, 1, 1, 0}, TensorShape({3, 2})));
+  test::ExpectTensorEqual<float>(result.context.sparse_values[0],
+                                 test::AsTensor<float>({0.0f, 0.5f, 0.0f}));
+  test::ExpectTensorEqual<int64>(result.context.sparse_shapes[0],
+                                 test::AsTensor<int64>({2, 2}));
+
+  test::ExpectTensorEqual<float>(
+      result.feature_lists.dense_values[0],
+      test::AsTensor<float>({0, 0, 1, -1, 2, -2, 0, 0, 0, 0, 0, 0},
+                            TensorShape({2, 3, 2})));
+  test::ExpectTensorEqual<int64>(result.feature_list_dense_lengths[0],
+                                 test::AsTensor<int64>({3, 0}));
+
+  test::ExpectTensorEqual<int64>(
+      result.feature_lists.sparse_indices[0],
+      test::AsTensor<int64>({0, 1, 0, 0, 2, 0, 0, 2, 1}, TensorShape({3, 3})));
+  test::ExpectTensorEqual<string>(
+      result.feature_lists.sparse_values[0],
+      test::AsTensor<string>({"token0", "token0", "token1"}));
+  test::ExpectTensorEqual<int64>(result.feature_lists.sparse_shapes[0],
+                                 test::AsTensor<int64>({2, 3, 2}));
+}
+
+TEST(FastParseSequenceExample, Single) {
+  SequenceResult result;
+  TF_ASSERT_OK(FastParseSingleSequenceExample(
+      MakeSequenceConfig(), Serialize(MakeSequenceExample(2, 2)), "example",
+      &result));
+
+  test::ExpectTensorEqual<int64>(result.context.dense_values[0],
+                                 test::AsScalar<int64>(2));
+  test::ExpectTensorEqual<int64>(
+      result.context.sparse_indices[0],
+      test::AsTensor<int64>({0, 1}, TensorShape({2, 1})));
+  test::ExpectTensorEqual<int64>(result.context.sparse_shapes[0],
+                                 test::AsTensor<int64>({2}));
+  test::ExpectTensorEqual<float>(
+      result.feature_lists.dense_values[0],
+      test::AsTensor<float>({0, 0, 1, -1}, TensorShape({2, 2})));
+  test::ExpectTensorEqual<int64>(
+      result.feature_lists.sparse_indices[0],
+      test::AsTensor<int64>({1, 0}, TensorShape({1, 2})));
+  test::ExpectTensorEqual<int64>(result.feature_lists.sparse_shapes[0],
+                                 test::AsTensor<int64>({2, 1}));
+  EXPECT_TRUE(result.feature_list_dense_lengths.empty());
+}
+
+TEST(FastParseSequenceExample, DenseAndSparseWithSameKey) {
+  FastParseSequenceExampleConfig config = MakeSequenceConfig();
+  config.context.sparse.push_back({"label", DT_INT64});
+  config.feature_list_sparse.push_back({"embedding", DT_FLOAT});
+  SequenceResult result;
+  TF_ASSERT_OK(FastParseSingleSequenceExample(
+      config, Serialize(MakeSequenceExample(2, 2)), "example", &result));
+
+  test::ExpectTensorEqual<int64>(result.context.dense_values[0],
+                                 test::AsScalar<int64>(2));
+  test::ExpectTensorEqual<int64>(
+      result.context.sparse_indices[1],
+      test::AsTensor<int64>({0}, TensorShape({1, 1})));
+  test::ExpectTensorEqual<int64>(result.context.sparse_values[1],
+                                 test::AsTensor<int64>({2}));
+  test::ExpectTensorEqual<float>(
+      result.feature_lists.dense_values[0],
+      test::AsTensor<float>({0, 0, 1, -1}, TensorShape({2, 2})));
+  test::ExpectTensorEqual<int64>(
+      result.feature_lists.sparse_indices[1],
+      test::AsTensor<int64>({0, 0, 0, 1, 1, 0, 1, 1}, TensorShape({4, 2})));
+  test::ExpectTensorEqual<float>(result.feature_lists.sparse_values[1],
+                                 test::AsTensor<float>({0, 0, 1, -1}));
+}
+
+TEST(FastParseSequenceExample, Errors) {
+  FastParseSequenceExampleConfig config = MakeSequenceConfig();
+  config.feature_list_dense[0].missing_assumed_empty = false;
+  SequenceResult result;
+  Status status = FastParseSingleSequenceExample(
+      config, Serialize(MakeSequenceExample(1, 0)), "in1", &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+  EXPECT_TRUE(StringPiece(status.error_message())
+                  .contains("Feature list 'embedding' is required"))
+      << status;
+
+  SequenceExample example = MakeSequenceExample(1, 2);
+  (*example.mutable_feature_lists()->mutable_feature_list())["embedding"]
+      .mutable_feature(1)
+      ->mutable_float_list()
+      ->add_value(1);
+  status = FastParseSingleSequenceExample(MakeSequenceConfig(),
+                                          Serialize(example), "in1", &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+  EXPECT_TRUE(StringPiece(status.error_message())
+                  .contains("Name: in1, Key: embedding, Index: 1.  Number of "
+                            "float values != expected."))
+      << status;
+
+  status = FastParseSingleSequenceExample(MakeSequenceConfig(), "\x0a\xff",
+                                          "in1", &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+}
+
+std::vector<string> MakeSerializedSequenceExamples(int batch_size) {
+  std::vector<string> serialized;
+  for (int i = 0; i < batch_size; ++i) {
+    serialized.push_back(Serialize(MakeSequenceExample(i % 10, 100)));
+  }
+  return serialized;
+}
+
+// Parses with the generated proto code, which was the first step of
+// ParseSingleSequenceExample before the fast path existed.
+static void BM_ParseSequenceExampleProto(int iters, int batch_size) {
+  testing::StopTiming();
+  std::vector<string> serialized = MakeSerializedSequenceExamples(batch_size);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    for (const string& s : serialized) {
+      SequenceExample example;
+      CHECK(example.ParseFromString(s));
+    }
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch_size);
+}
+BENCHMARK(BM_ParseSequenceExampleProto)->Arg(1)->Arg(32)->Arg(256);
+
+static void BM_FastParseSequenceExample(int iters, int batch_size,
+                                        int num_threads) {
+  testing::StopTiming();
+  std::vector<string> serialized = MakeSerializedSequenceExamples(batch_size);
+  FastParseSequenceExampleConfig config = MakeSequenceConfig();
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool.reset(
+        new thread::ThreadPool(Env::Default(), "bench", num_threads));
+  }
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    SequenceResult result;
+    TF_CHECK_OK(FastParseSequenceExample(config, serialized, {},
+                                         thread_pool.get(), &result));
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch_size);
+}
+BENCHMARK(BM_FastParseSequenceExample)
+    ->ArgPair(1, 1)
+    ->ArgPair(32, 1)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 8);
+
 }  // namespace
 
 }  // namespace example
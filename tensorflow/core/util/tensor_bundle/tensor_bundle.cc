@@ -345,10 +345,26 @@ table::Options TableBuilderOptions() {
   return o;
 }
 
+// Pads "out" with zeros so that "*size", the number of bytes written to it so
+// far, is a multiple of "alignment".
+Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
+  const int bytes_over = *size % alignment;
+  if (bytes_over == 0) {
+    return Status::OK();
+  }
+  const int bytes_to_write = alignment - bytes_over;
+  Status status = out->Append(string(bytes_to_write, '\0'));
+  if (status.ok()) {
+    *size += bytes_to_write;
+  }
+  return status;
+}
+
 }  // namespace
 
-BundleWriter::BundleWriter(Env* env, StringPiece prefix)
+BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     : env_(env),
+      options_(options),
       prefix_(prefix.ToString()),
       tmp_metadata_path_(strings::StrCat(MetaFilename(prefix_), ".tempstate",
                                          random::New64())),
@@ -379,6 +395,12 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
     return status_;
   }
 
+  if (options_.data_alignment > 1 &&
+      val.TotalBytes() >= static_cast<size_t>(options_.data_alignment)) {
+    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+    if (!status_.ok()) return status_;
+  }
+
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
@@ -313,6 +313,40 @@ TEST(TensorBundleTest, Basic) {
   TestBasic<qint8>();
 }
 
+TEST(TensorBundleTest, DataAlignment) {
+  BundleWriter::Options options;
+  options.data_alignment = 64;
+  {
+    BundleWriter writer(Env::Default(), Prefix("aligned"), options);
+    TF_EXPECT_OK(writer.Add("a", Constant<int8>(1, TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("b", Constant<float>(2, TensorShape({100}))));
+    TF_EXPECT_OK(writer.Add("c", Constant<int8>(3, TensorShape({5}))));
+    TF_EXPECT_OK(writer.Add("d", Constant<double>(4, TensorShape({10}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("aligned"));
+    TF_ASSERT_OK(reader.status());
+    Expect<int8>(&reader, "a", Constant<int8>(1, TensorShape({3})));
+    Expect<float>(&reader, "b", Constant<float>(2, TensorShape({100})));
+    Expect<int8>(&reader, "c", Constant<int8>(3, TensorShape({5})));
+    Expect<double>(&reader, "d", Constant<double>(4, TensorShape({10})));
+
+    // Tensors of at least 64 bytes start at aligned offsets; smaller ones are
+    // packed directly after the previous tensor.
+    std::vector<std::pair<string, int64>> expected_offsets = {
+        {"a", 0}, {"b", 64}, {"c", 464}, {"d", 512}};
+    for (const auto& expected : expected_offsets) {
+      reader.Seek(expected.first);
+      ASSERT_TRUE(reader.Valid());
+      BundleEntryProto entry;
+      ASSERT_TRUE(entry.ParseFromArray(reader.value().data(),
+                                       reader.value().size()));
+      EXPECT_EQ(expected.second, entry.offset()) << expected.first;
+    }
+  }
+}
+
 TEST(TensorBundleTest, PartitionedVariables) {
   const TensorShape kFullShape({5, 10});
   // Adds two slices.
@@ -198,6 +198,32 @@ class FilesystemCacheDatasetTest(test.TestCase):
       self.assertAllEqual(elements, elements_itr1)
       self.assertAllEqual(elements, elements_itr2)
 
+  def testLargeElementsAreReadBack(self):
+    # Elements that are large enough to be read from the mapped cache file
+    # without a copy, mixed with scalars that are read through a buffer.
+    components = (np.arange(8 * 1024, dtype=np.float32).reshape(8, 1024),
+                  np.arange(8, dtype=np.int64))
+    filename_placeholder = array_ops.placeholder(dtypes.string, shape=[])
+
+    cache_dataset = (dataset_ops.Dataset.from_tensor_slices(components)
+                     .cache(filename_placeholder))
+    # The map function must not write into the cached tensors in place.
+    dataset = cache_dataset.map(lambda x, y: (x + 1.0, y + 1))
+    iterator = dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for _ in range(3):
+        sess.run(
+            iterator.initializer,
+            feed_dict={filename_placeholder: self.cache_prefix})
+        for i in range(8):
+          x, y = sess.run(get_next)
+          self.assertAllEqual(components[0][i] + 1.0, x)
+          self.assertEqual(i + 1, y)
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
 
 class MemoryCacheDatasetTest(test.TestCase):
 
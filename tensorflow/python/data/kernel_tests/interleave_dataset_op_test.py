@@ -24,6 +24,7 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import sparse_ops
 from tensorflow.python.platform import test
 
@@ -176,6 +177,57 @@ class InterleaveDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(next_element)
 
+  def testSloppyInterleaveDataset(self):
+    input_values = array_ops.placeholder(dtypes.int64, shape=[None])
+    cycle_length = array_ops.placeholder(dtypes.int64, shape=[])
+    block_length = array_ops.placeholder(dtypes.int64, shape=[])
+
+    dataset = (
+        dataset_ops.Dataset.from_tensor_slices(input_values)
+        .repeat(2)
+        .interleave(lambda x: dataset_ops.Dataset.from_tensors(x).repeat(x),
+                    cycle_length, block_length, sloppy=True))
+    iterator = dataset.make_initializable_iterator()
+    init_op = iterator.initializer
+    next_element = iterator.get_next()
+
+    with self.test_session() as sess:
+      for values, cycle, block in [([4, 5, 6], 1, 3), ([4, 5, 6], 2, 1),
+                                   ([4, 0, 6], 2, 3), ([4, 5, 6], 7, 2),
+                                   ([], 2, 3), ([0, 0, 0], 2, 3)]:
+        sess.run(init_op, feed_dict={input_values: values,
+                                     cycle_length: cycle, block_length: block})
+        # The order is not deterministic, but every element must be produced
+        # exactly once.
+        produced = []
+        for _ in range(2 * sum(values)):
+          produced.append(sess.run(next_element))
+        self.assertEqual(sorted(2 * [v for v in values for _ in range(v)]),
+                         sorted(produced))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(next_element)
+
+  def testSloppyInterleaveError(self):
+    dataset = dataset_ops.Dataset.range(4).interleave(
+        lambda x: dataset_ops.Dataset.from_tensors(x).map(
+            lambda y: array_ops.check_numerics(
+                1.0 / math_ops.cast(y, dtypes.float32), "error")),
+        cycle_length=2, sloppy=True)
+    next_element = dataset.make_one_shot_iterator().get_next()
+
+    with self.test_session() as sess:
+      produced = []
+      num_errors = 0
+      for _ in range(4):
+        try:
+          produced.append(sess.run(next_element))
+        except errors.InvalidArgumentError:
+          num_errors += 1
+      self.assertEqual(1, num_errors)
+      self.assertAllClose([1.0 / 3, 0.5, 1.0], sorted(produced))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
   def testSparse(self):
 
     def _map_fn(i):
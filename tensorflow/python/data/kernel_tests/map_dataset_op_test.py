@@ -180,7 +180,7 @@ class MapDatasetTest(test.TestCase):
               self.assertAllEqual(component[i]**2, result_component)
 
       for num_parallel_calls_val, output_buffer_size_val in [
-          (1, 1), (1, 2), (2, 2), (2, 4), (8, 8), (8, 16)]:
+          (1, 1), (1, 2), (2, 2), (2, 4), (8, 8), (8, 16), (-1, -1)]:
         do_test(num_parallel_calls_val, output_buffer_size_val)
 
   def testImplicitDisposeParallelMapDataset(self):
@@ -659,6 +659,43 @@ class MapDatasetBenchmark(test.Benchmark):
               iters=1000, wall_time=median_wall_time,
               name="benchmark_map_dataset_fan_out_%d" % fan_out)
 
+  def _benchmarkParallelMap(self, num_parallel_calls, buffer_size, name):
+    with ops.Graph().as_default():
+      dataset = dataset_ops.Dataset.from_tensors(
+          random_ops.random_uniform([128, 128])).repeat(None)
+      dataset = dataset.map(
+          lambda x: math_ops.reduce_sum(math_ops.matmul(x, x)),
+          num_parallel_calls=num_parallel_calls).prefetch(buffer_size)
+      iterator = dataset.make_one_shot_iterator()
+      next_element = iterator.get_next()
+
+      with session.Session() as sess:
+        deltas = []
+        for _ in range(50):
+          start = time.time()
+          for _ in range(100):
+            sess.run(next_element.op)
+          end = time.time()
+          deltas.append(end - start)
+
+        # The wall time of the first and last windows shows how quickly the
+        # tuned parallelism converges, if tuning is enabled.
+        first_wall_time = deltas[0] / 100
+        final_wall_time = np.median(deltas[-10:]) / 100
+        print("Parallel map dataset %s First wall time: %f "
+              "Final wall time: %f" % (name, first_wall_time, final_wall_time))
+        self.report_benchmark(
+            iters=5000, wall_time=final_wall_time,
+            extras={"first_wall_time": first_wall_time},
+            name="benchmark_parallel_map_dataset_%s" % name)
+
+  def benchmarkAutoTunedParallelMap(self):
+    for num_parallel_calls in [1, 2, 4, 8, 16]:
+      self._benchmarkParallelMap(
+          num_parallel_calls, num_parallel_calls,
+          "fixed_%d" % num_parallel_calls)
+    self._benchmarkParallelMap(-1, -1, "autotune")
+
 
 if __name__ == "__main__":
   test.main()
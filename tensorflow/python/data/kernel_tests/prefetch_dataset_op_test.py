@@ -40,6 +40,17 @@ class PrefetchDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(get_next)
 
+  def testAutoTunedBufferSize(self):
+    iterator = dataset_ops.Dataset.range(1000).prefetch(
+        buffer_size=-1).make_one_shot_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for m in range(1000):
+        self.assertEqual(m, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
   def testInvalidBufferSize(self):
     buffer_size = array_ops.placeholder(dtypes.int64, shape=[])
     iterator = dataset_ops.Dataset.range(10).prefetch(
@@ -54,6 +65,10 @@ class PrefetchDatasetTest(test.TestCase):
       with self.test_session() as sess:
         sess.run(init_op, feed_dict={buffer_size: -5})
 
+    with self.assertRaisesRegexp(errors.InvalidArgumentError, "buffer_size"):
+      with self.test_session() as sess:
+        sess.run(init_op, feed_dict={buffer_size: -2})
+
 
 if __name__ == "__main__":
   test.main()
@@ -75,7 +75,7 @@ class TextLineDatasetTest(test.TestCase):
 
     return filenames
 
-  def _testTextLineDataset(self, compression_type=None):
+  def _testTextLineDataset(self, compression_type=None, use_mmap=False):
     test_filenames = self._createFiles(
         2, 5, crlf=True, compression_type=compression_type)
     filenames = array_ops.placeholder(dtypes.string, shape=[None])
@@ -83,7 +83,8 @@ class TextLineDatasetTest(test.TestCase):
     batch_size = array_ops.placeholder(dtypes.int64, shape=[])
 
     repeat_dataset = readers.TextLineDataset(
-        filenames, compression_type=compression_type).repeat(num_epochs)
+        filenames, compression_type=compression_type,
+        use_mmap=use_mmap).repeat(num_epochs)
     batch_dataset = repeat_dataset.batch(batch_size)
 
     iterator = iterator_ops.Iterator.from_structure(batch_dataset.output_types)
@@ -148,6 +149,30 @@ class TextLineDatasetTest(test.TestCase):
   def testTextLineDatasetZlibCompression(self):
     self._testTextLineDataset(compression_type="ZLIB")
 
+  def testTextLineDatasetMmap(self):
+    self._testTextLineDataset(use_mmap=True)
+
+  def testTextLineDatasetMmapIgnoredForCompression(self):
+    self._testTextLineDataset(compression_type="GZIP", use_mmap=True)
+
+  def testTextLineDatasetMmapEdgeCases(self):
+    contents = [b"", b"\n\n", b"a\rb\r\n\r", b"no trailing newline"]
+    filenames = []
+    for i, content in enumerate(contents):
+      fn = os.path.join(self.get_temp_dir(), "text_line_edge.%d.txt" % i)
+      with open(fn, "wb") as f:
+        f.write(content)
+      filenames.append(fn)
+
+    for use_mmap in [False, True]:
+      dataset = readers.TextLineDataset(filenames, use_mmap=use_mmap)
+      get_next = dataset.make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        for expected in [b"", b"", b"ab", b"no trailing newline"]:
+          self.assertEqual(expected, sess.run(get_next))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
   def testTextLineDatasetBuffering(self):
     test_filenames = self._createFiles(2, 5, crlf=True)
 
@@ -743,6 +768,39 @@ class TFRecordDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(iterator.get_next())
 
+  def testReadWithAsyncIO(self):
+    # A buffer smaller than a record makes records span several buffers.
+    for buffer_size in [0, 8, 2**20]:
+      d = readers.TFRecordDataset(
+          self.test_filenames, buffer_size=buffer_size, async_io=True)
+      iterator = d.make_one_shot_iterator()
+      next_element = iterator.get_next()
+      with self.test_session() as sess:
+        for j in range(self._num_files):
+          for i in range(self._num_records):
+            self.assertAllEqual(self._record(j, i), sess.run(next_element))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(next_element)
+
+  def testReadLargeRecordsWithAsyncIO(self):
+    fn = os.path.join(self.get_temp_dir(), "tf_record.large.txt")
+    records = [
+        compat.as_bytes(chr(ord("a") + i) * (300 * 1024 + i)) for i in range(3)
+    ]
+    writer = python_io.TFRecordWriter(fn)
+    for record in records:
+      writer.write(record)
+    writer.close()
+
+    d = readers.TFRecordDataset(fn, buffer_size=64 * 1024, async_io=True)
+    iterator = d.make_one_shot_iterator()
+    next_element = iterator.get_next()
+    with self.test_session() as sess:
+      for record in records:
+        self.assertEqual(record, sess.run(next_element))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
 
 if __name__ == "__main__":
   test.main()
@@ -535,7 +535,8 @@ class Dataset(object):
 
     Args:
       buffer_size: A `tf.int64` scalar `tf.Tensor`, representing the
-        maximum number elements that will be buffered when prefetching.
+        maximum number elements that will be buffered when prefetching. If
+        -1, the buffer size will be tuned automatically at runtime.
 
     Returns:
       A `Dataset`.
@@ -777,7 +778,8 @@ class Dataset(object):
        `self.output_types`) to another nested structure of tensors.
       num_parallel_calls: (Optional.) A `tf.int32` scalar `tf.Tensor`,
         representing the number elements to process in parallel. If not
-        specified, elements will be processed sequentially.
+        specified, elements will be processed sequentially. If -1, the
+        number of parallel calls will be tuned automatically at runtime.
 
     Returns:
       A `Dataset`.
@@ -800,7 +802,7 @@ class Dataset(object):
     """
     return FlatMapDataset(self, map_func)
 
-  def interleave(self, map_func, cycle_length, block_length=1):
+  def interleave(self, map_func, cycle_length, block_length=1, sloppy=False):
     """Maps `map_func` across this dataset, and interleaves the results.
 
     For example, you can use `Dataset.interleave()` to process many input files
@@ -850,10 +852,17 @@ class Dataset(object):
     }
     ```
 
-    NOTE: The order of elements yielded by this transformation is
-    deterministic, as long as `map_func` is a pure function. If
-    `map_func` contains any stateful operations, the order in which
-    that state is accessed is undefined.
+    NOTE: Unless `sloppy` is `True`, the order of elements yielded by this
+    transformation is deterministic, as long as `map_func` is a pure function.
+    If `map_func` contains any stateful operations, the order in which that
+    state is accessed is undefined.
+
+    If `sloppy` is `True`, each of the `cycle_length` datasets is iterated in
+    a background thread, and an element is produced from whichever of them has
+    one ready, starting from the position that the deterministic order would
+    use. This keeps one slow input (such as a file on remote storage) from
+    stalling the whole pipeline, at the cost of a non-deterministic order.
+    Iterators over a sloppy interleave cannot be saved.
 
     Args:
       map_func: A function mapping a nested structure of tensors (having shapes
@@ -863,11 +872,14 @@ class Dataset(object):
         processed concurrently.
       block_length: The number of consecutive elements to produce from each
         input element before cycling to another input element.
+      sloppy: (Optional.) A boolean. If `True`, elements may be produced out of
+        order when some of the inputs are slower than others.
 
     Returns:
       A `Dataset`.
     """
-    return InterleaveDataset(self, map_func, cycle_length, block_length)
+    return InterleaveDataset(self, map_func, cycle_length, block_length,
+                             sloppy)
 
   def filter(self, predicate):
     """Filters this dataset according to `predicate`.
@@ -1704,7 +1716,8 @@ class InterleaveDataset(Dataset):
   """A `Dataset` that maps a function over its input and interleaves the result.
   """
 
-  def __init__(self, input_dataset, map_func, cycle_length, block_length):
+  def __init__(self, input_dataset, map_func, cycle_length, block_length,
+               sloppy=False):
     """See `Dataset.interleave()` for details."""
     super(InterleaveDataset, self).__init__()
     self._input_dataset = input_dataset
@@ -1745,6 +1758,7 @@ class InterleaveDataset(Dataset):
         cycle_length, dtype=dtypes.int64, name="cycle_length")
     self._block_length = ops.convert_to_tensor(
         block_length, dtype=dtypes.int64, name="block_length")
+    self._sloppy = sloppy
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.interleave_dataset(
@@ -1753,6 +1767,7 @@ class InterleaveDataset(Dataset):
         self._cycle_length,
         self._block_length,
         f=self._map_func,
+        sloppy=self._sloppy,
         output_types=nest.flatten(
             sparse.as_dense_types(self.output_types, self.output_classes)),
         output_shapes=nest.flatten(
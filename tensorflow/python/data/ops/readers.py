@@ -32,7 +32,11 @@ _DEFAULT_READER_BUFFER_SIZE_BYTES = 256 * 1024  # 256 KB
 class TextLineDataset(Dataset):
   """A `Dataset` comprising lines from one or more text files."""
 
-  def __init__(self, filenames, compression_type=None, buffer_size=None):
+  def __init__(self,
+               filenames,
+               compression_type=None,
+               buffer_size=None,
+               use_mmap=False):
     """Creates a `TextLineDataset`.
 
     Args:
@@ -42,6 +46,9 @@ class TextLineDataset(Dataset):
       buffer_size: (Optional.) A `tf.int64` scalar denoting the number of bytes
         to buffer. A value of 0 results in the default buffering values chosen
         based on the compression type.
+      use_mmap: (Optional.) A Python boolean. If `True`, uncompressed files are
+        memory-mapped where the file system supports it, and lines are split
+        directly from the mapping. Other files are read as usual.
     """
     super(TextLineDataset, self).__init__()
     self._filenames = ops.convert_to_tensor(
@@ -53,10 +60,14 @@ class TextLineDataset(Dataset):
         argument_dtype=dtypes.string)
     self._buffer_size = convert.optional_param_to_tensor(
         "buffer_size", buffer_size, _DEFAULT_READER_BUFFER_SIZE_BYTES)
+    self._use_mmap = use_mmap
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.text_line_dataset(
-        self._filenames, self._compression_type, self._buffer_size)
+        self._filenames,
+        self._compression_type,
+        self._buffer_size,
+        use_mmap=self._use_mmap)
 
   @property
   def output_classes(self):
@@ -74,7 +85,11 @@ class TextLineDataset(Dataset):
 class TFRecordDataset(Dataset):
   """A `Dataset` comprising records from one or more TFRecord files."""
 
-  def __init__(self, filenames, compression_type=None, buffer_size=None):
+  def __init__(self,
+               filenames,
+               compression_type=None,
+               buffer_size=None,
+               async_io=False):
     """Creates a `TFRecordDataset`.
 
     Args:
@@ -83,6 +98,9 @@ class TFRecordDataset(Dataset):
         `""` (no compression), `"ZLIB"`, or `"GZIP"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
+      async_io: (Optional.) A Python boolean. If `True`, each file is read by a
+        background thread, which fills the next buffer of `buffer_size` bytes
+        while records are parsed from the current one.
     """
     super(TFRecordDataset, self).__init__()
     # Force the type to string even if filenames is an empty list.
@@ -97,10 +115,14 @@ class TFRecordDataset(Dataset):
         "buffer_size",
         buffer_size,
         argument_default=_DEFAULT_READER_BUFFER_SIZE_BYTES)
+    self._async_io = async_io
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.tf_record_dataset(
-        self._filenames, self._compression_type, self._buffer_size)
+        self._filenames,
+        self._compression_type,
+        self._buffer_size,
+        async_io=self._async_io)
 
   @property
   def output_classes(self):
@@ -719,6 +719,63 @@ class EmbeddingLookupSparseTest(test.TestCase):
             x, x_shape, y, y_shape, x_init_value=x_init_value)
       self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
 
+  def testFusedEmbeddingLookupSparse(self):
+    vocab_size = 13
+    batch_size = 10
+    param_shape = [2, 5]
+    sp_ids, sp_weights, _, _, _ = self._RandomIdsAndWeights(
+        batch_size, vocab_size)
+
+    for combiner, dtype, ignore_weights in itertools.product(
+        ["sum", "mean", "sqrtn"], [dtypes.float32, dtypes.float64],
+        [True, False]):
+      with self.test_session():
+        p, _, feed_dict = _EmbeddingParams(
+            1, vocab_size, shape=param_shape, dtype=dtype)
+        weights = None if ignore_weights else sp_weights
+        fused = embedding_ops.embedding_lookup_sparse(
+            p, sp_ids, weights, combiner=combiner, fused=True)
+        unfused = embedding_ops.embedding_lookup_sparse(
+            p, sp_ids, weights, combiner=combiner)
+        self.assertEqual(fused.get_shape().as_list(), [None] + param_shape)
+        self.assertAllClose(
+            unfused.eval(feed_dict=feed_dict), fused.eval(feed_dict=feed_dict))
+
+  def testGradientsFusedEmbeddingLookupSparse(self):
+    vocab_size = 12
+    batch_size = 4
+    param_shape = [2, 3]
+    sp_ids, sp_weights, _, _, _ = self._RandomIdsAndWeights(
+        batch_size, vocab_size)
+
+    for combiner, ignore_weights in itertools.product(
+        ["sum", "mean", "sqrtn"], [True, False]):
+      with self.test_session():
+        x, params, _ = _EmbeddingParams(
+            1, vocab_size, shape=param_shape, dtype=dtypes.float64)
+        weights = None if ignore_weights else sp_weights
+        y = embedding_ops.embedding_lookup_sparse(
+            x, sp_ids, weights, combiner=combiner, fused=True)
+        x_init_value = params[_PName(0) + ":0"]
+        y_shape = [batch_size] + param_shape
+        err = gradient_checker.compute_gradient_error(
+            x, [x_init_value.shape], y, y_shape, x_init_value=[x_init_value])
+        self.assertLess(err, 1e-5)
+
+        if not ignore_weights:
+          num_ids = sp_weights.values.get_shape()[0].value
+          w = constant_op.constant(1 + np.random.rand(num_ids), dtypes.float64)
+          y = embedding_ops.embedding_lookup_sparse(
+              constant_op.constant(x_init_value),
+              sp_ids,
+              sparse_tensor.SparseTensor(sp_weights.indices, w,
+                                         sp_weights.dense_shape),
+              combiner=combiner,
+              fused=True)
+          err = gradient_checker.compute_gradient_error(
+              w, [num_ids], y, y_shape)
+          self.assertLess(err, 1e-5)
+
   def testIncompatibleShapes(self):
     with self.test_session():
       x, _, _ = _EmbeddingParams(1, 10, dtype=dtypes.float32)
@@ -183,6 +183,12 @@ class SparseXentTest(test.TestCase):
           np.array([[1., 1., 1., 1.], [1., 2., 3., 4.]]).astype(np.float16),
           np.array([3, 0]).astype(label_dtype))
 
+  def testLargeNumClasses(self):
+    np.random.seed(0)
+    for label_dtype in np.int32, np.int64:
+      self._testXent(3. * np.random.randn(3, 5000),
+                     np.array([0, 2718, 4999]).astype(label_dtype))
+
   def testEmpty(self):
     self._testXent(np.zeros((0, 3)), np.zeros((0,), dtype=np.int32))
 
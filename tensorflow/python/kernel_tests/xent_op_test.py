@@ -156,6 +156,14 @@ class XentTest(test.TestCase):
         np.array([[1., 1., 1., 1.], [1., 2., 3., 4.]]).astype(np.float64),
         np.array([[0., 0., 0., 1.], [0., .5, .5, 0.]]).astype(np.float64))
 
+  def testLargeNumClasses(self):
+    # Rows that the CPU kernel processes in several chunks.
+    np.random.seed(0)
+    features = 3. * np.random.randn(3, 5000)
+    labels = np.random.rand(3, 5000)
+    labels /= np.sum(labels, axis=1, keepdims=True)
+    self._testAll(features, labels)
+
   def testGradient(self):
     with self.test_session() as sess:
       l = constant_op.constant(
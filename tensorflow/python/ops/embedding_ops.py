@@ -28,6 +28,7 @@ from tensorflow.python.ops import clip_ops
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import variables
@@ -331,7 +332,8 @@ def embedding_lookup_sparse(params,
                             partition_strategy="mod",
                             name=None,
                             combiner=None,
-                            max_norm=None):
+                            max_norm=None,
+                            fused=False):
   """Computes embeddings for the given ids and weights.
 
   This op assumes that there is at least one id for each row in the dense tensor
@@ -364,6 +366,12 @@ def embedding_lookup_sparse(params,
       squares of the weights.
     max_norm: If provided, each embedding is normalized to have l2 norm equal
       to max_norm before combining.
+    fused: If True, and `params` is a single unpartitioned tensor and
+      `max_norm` is None, look up and combine the embeddings with a single
+      kernel that does not materialize the gathered embeddings. Its gradient
+      for `params` is an `IndexedSlices` with one row per distinct id. The
+      fused kernel is only available on CPU. Otherwise this argument is
+      ignored.
 
   Returns:
     A dense tensor representing the combined embeddings for the
@@ -433,6 +441,17 @@ def embedding_lookup_sparse(params,
       segment_ids = math_ops.cast(segment_ids, dtypes.int32)
 
     ids = sp_ids.values
+    if fused and len(params) == 1 and max_norm is None:
+      dtype = params[0].dtype.base_dtype
+      if ignore_weights:
+        weights = array_ops.zeros([0], dtype=dtype)
+      else:
+        weights = sp_weights.values
+        if weights.dtype != dtype:
+          weights = math_ops.cast(weights, dtype)
+      return gen_math_ops._fused_embedding_lookup_sparse(
+          params[0], ids, segment_ids, weights, combiner=combiner, name=name)
+
     if ignore_weights:
       ids, idx = array_ops.unique(ids)
     else:
@@ -225,6 +225,41 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("FusedEmbeddingLookupSparse")
+def _FusedEmbeddingLookupSparseGrad(op, grad):
+  """Gradient for FusedEmbeddingLookupSparse.
+
+  The gradient for `params` is an `IndexedSlices` with one row per distinct id.
+  The gradient for `weights` is built from ordinary ops so that it is pruned
+  from the graph when the weights are not trained.
+  """
+  params, ids, segment_ids, weights = op.inputs
+  combiner = op.get_attr("combiner")
+  values, unique_ids = gen_math_ops._fused_embedding_lookup_sparse_grad(
+      grad, ids, segment_ids, weights, combiner=combiner)
+  params_grad = ops.IndexedSlices(values, unique_ids, array_ops.shape(params))
+  # An empty `weights` means every id has weight 1.
+  if weights.get_shape().num_elements() == 0:
+    return params_grad, None, None, None
+
+  segment_grad = array_ops.gather(grad, segment_ids)
+  axes = math_ops.range(1, array_ops.rank(segment_grad))
+  dot = math_ops.reduce_sum(array_ops.gather(params, ids) * segment_grad, axes)
+  if combiner == b"sum":
+    return params_grad, None, None, dot
+  output_dot = math_ops.reduce_sum(
+      array_ops.gather(op.outputs[0], segment_ids) * segment_grad, axes)
+  if combiner == b"mean":
+    total = math_ops.segment_sum(weights, segment_ids)
+    total = array_ops.gather(total, segment_ids)
+    weights_grad = (dot - output_dot) / total
+  else:
+    norm = math_ops.sqrt(math_ops.segment_sum(weights * weights, segment_ids))
+    norm = array_ops.gather(norm, segment_ids)
+    weights_grad = (dot - weights * output_dot / norm) / norm
+  return params_grad, None, None, weights_grad
+
+
 def _SegmentMinOrMaxGrad(op, grad, is_sorted):
   """Gradient for SegmentMin and (unsorted) SegmentMax. They share similar code."""
   zeros = array_ops.zeros(array_ops.shape(op.inputs[0]),